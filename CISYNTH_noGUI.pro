@@ -46,18 +46,28 @@ DEFINES += USE_RTAUDIO
 
 # Fichiers sources C (tous les fichiers .c incluant main.c)
 SOURCES += \
+    src/core/audio_format.c \
+    src/core/audio_params.c \
+    src/core/audio_telemetry.c \
     src/core/display.c \
     src/core/dmx.c \
     src/core/error.c \
     src/core/kissfft/kiss_fft.c \
     src/core/kissfft/kiss_fftr.c \
     src/core/main.c \
+    src/core/midi_event_queue.c \
     src/core/multithreading.c \
+    src/core/scanner_map.c \
     src/core/shared.c \
     src/core/synth.c \
     src/core/synth_fft.c \
     src/core/udp.c \
     src/core/wave_generation.c \
+    src/core/audio_file_writer.cpp \
+    src/core/polyphase_resampler.cpp \
+    src/core/convolution_reverb.cpp \
+    src/core/mix_graph.cpp \
+    src/core/lookahead_limiter.cpp \
     src/core/audio_rtaudio.cpp \
     src/core/midi_controller.cpp \
     src/core/ZitaRev1.cpp \
@@ -69,8 +79,17 @@ SOURCES += \
 HEADERS += \
     src/core/audio_rtaudio.h \
     src/core/audio_c_api.h \
+    src/core/audio_file_writer.h \
+    src/core/polyphase_resampler.h \
+    src/core/convolution_reverb.h \
+    src/core/mix_graph.h \
+    src/core/lookahead_limiter.h \
+    src/core/audio_format.h \
+    src/core/audio_params.h \
+    src/core/audio_telemetry.h \
     src/core/config.h \
     src/core/context.h \
+    src/core/denormals.h \
     src/core/display.h \
     src/core/dmx.h \
     src/core/doublebuffer.h \
@@ -79,6 +98,8 @@ HEADERS += \
     src/core/kissfft/kiss_fftr.h \
     src/core/multithreading.h \
     src/core/midi_controller.h \
+    src/core/midi_event_queue.h \
+    src/core/scanner_map.h \
     src/core/shared.h \
     src/core/synth.h \
     src/core/synth_fft.h \
@@ -88,7 +109,8 @@ HEADERS += \
     src/core/reverb.h \
     src/core/pareq.h \
     src/core/global.h \
-    src/core/three_band_eq.h
+    src/core/three_band_eq.h \
+    src/core/wake_event.h
 
 # Chemins d'inclusion
 INCLUDEPATH += src/core
@@ -13,6 +13,7 @@ extern "C" {
 }
 
 // Inclure les en-têtes C++ pour MIDI et RtAudio
+#include "audio_format.h"
 #include "audio_rtaudio.h"
 #include "midi_controller.h"
 
@@ -45,6 +46,7 @@ MainWindow::MainWindow(QWidget *parent)
   m_dmxContext = std::make_unique<DMXContext>();
   m_audioData = std::make_unique<AudioData>();
   m_doubleBuffer = std::make_unique<DoubleBuffer>();
+  m_imageVersion = 0;
 
   // Initialiser la fenêtre SFML
   sfVideoMode mode = {CIS_MAX_PIXELS_NB, WINDOWS_HEIGHT, 32};
@@ -101,7 +103,7 @@ MainWindow::~MainWindow() {
 
 void MainWindow::initializeAudio() {
   // Initialiser les données audio
-  initAudioData(m_audioData.get(), AUDIO_CHANNEL, AUDIO_BUFFER_SIZE);
+  initAudioData(m_audioData.get(), AUDIO_CHANNEL, g_audio_buffer_size);
   audio_Init(m_audioData.get());
   synth_IfftInit();
 
@@ -252,25 +254,21 @@ void MainWindow::stopThreads() {
 }
 
 void MainWindow::updateVisualization() {
-  // Vérifier si le double buffer contient de nouvelles données
-  pthread_mutex_lock(&m_doubleBuffer->mutex);
-  int dataReady = m_doubleBuffer->dataReady;
-  if (dataReady) {
-    m_doubleBuffer->dataReady = 0;
-  }
-  pthread_mutex_unlock(&m_doubleBuffer->mutex);
+  // Vérifier si une nouvelle ligne a été publiée (lecture sans verrou)
+  if (getImageVersion(m_doubleBuffer.get()) != m_imageVersion) {
+    // Ligne lue sur place, épinglée le temps de la mise à jour
+    ImageLineRef line;
+    initImageLineRef(&line);
+    m_imageVersion = acquireImageLine(m_doubleBuffer.get(), &line);
 
-  if (dataReady) {
     // Mettre à jour le visualiseur avec les nouvelles données
-    m_visualizer->updateData(
-        m_doubleBuffer->processingBuffer_R, m_doubleBuffer->processingBuffer_G,
-        m_doubleBuffer->processingBuffer_B, CIS_MAX_PIXELS_NB);
+    m_visualizer->updateData(line.R, line.G, line.B, CIS_MAX_PIXELS_NB);
 
     // Calculer la couleur moyenne et mettre à jour le contexte DMX
     DMXSpot zoneSpots[DMX_NUM_SPOTS];
-    computeAverageColorPerZone(
-        m_doubleBuffer->processingBuffer_R, m_doubleBuffer->processingBuffer_G,
-        m_doubleBuffer->processingBuffer_B, CIS_MAX_PIXELS_NB, zoneSpots);
+    computeAverageColorPerZone(line.R, line.G, line.B, CIS_MAX_PIXELS_NB,
+                               zoneSpots);
+    releaseImageLine(m_doubleBuffer.get(), &line);
 
     pthread_mutex_lock(&m_dmxContext->mutex);
     memcpy(m_dmxContext->spots, zoneSpots, sizeof(zoneSpots));
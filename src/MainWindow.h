@@ -45,6 +45,7 @@ private:
     std::unique_ptr<DMXContext> m_dmxContext;
     std::unique_ptr<AudioData> m_audioData;
     std::unique_ptr<DoubleBuffer> m_doubleBuffer;
+    uint32_t m_imageVersion; // Dernière ligne affichée
     
     // Threads
     QThread m_udpThread;
@@ -56,6 +56,11 @@ void ZitaRev1::clear() {
   updateReverbParameters();
 }
 
+void ZitaRev1::setSampleRate(float sampleRate) {
+  _sampleRate = sampleRate;
+  clear();
+}
+
 void ZitaRev1::setParameter(int index, float value) {
   if (index >= 0 && index < NUM_PARAMS) {
     _parameters[index] = value;
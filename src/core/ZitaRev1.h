@@ -44,6 +44,8 @@ public:
 
   void init(float sampleRate);
   void clear();
+  // Change de fréquence après init() (libère les lignes, vide la queue)
+  void setSampleRate(float sampleRate);
 
   // Interfaces identiques à l'implémentation actuelle
   void setParameter(int index, float value);
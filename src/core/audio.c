@@ -11,6 +11,7 @@
 #include <pthread.h>
 
 #include "config.h"
+#include "audio_format.h"
 #include "audio.h"
 
 pthread_mutex_t buffer_index_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -59,7 +60,7 @@ OSStatus audioCallback(void *inRefCon,
         }
 
         // How many frames are left in the current buffer?
-        UInt32 framesAvailable = AUDIO_BUFFER_SIZE - readOffset;
+        UInt32 framesAvailable = g_audio_buffer_size - readOffset;
 
         // We either consume all that’s left in the buffer, or only as many as we still need
         UInt32 chunk = (framesToRender < framesAvailable) ? framesToRender : framesAvailable;
@@ -76,7 +77,7 @@ OSStatus audioCallback(void *inRefCon,
         framesToRender -= chunk;
 
         // If we've just consumed the entire buffer, mark it free and flip
-        if (readOffset >= AUDIO_BUFFER_SIZE)
+        if (readOffset >= g_audio_buffer_size)
         {
             // Done with this buffer
             pthread_mutex_lock(&buffers_R[localReadIndex].mutex);
@@ -135,7 +136,7 @@ void audio_Init(AudioData *audioData)
     status = AudioComponentInstanceNew(output, &audioUnit);
 
     AudioStreamBasicDescription audioFormat = {
-        .mSampleRate       = SAMPLING_FREQUENCY,
+        .mSampleRate       = g_sampling_frequency,
         .mFormatID         = kAudioFormatLinearPCM,
         .mFormatFlags      = kAudioFormatFlagIsFloat
                               | kAudioFormatFlagIsPacked
@@ -26,7 +26,7 @@ typedef struct AudioData {
 } AudioData;
 
 typedef struct {
-  float data[AUDIO_BUFFER_SIZE];
+  float data[AUDIO_BUFFER_SIZE_MAX]; // g_audio_buffer_size frames used
   int ready; // 0: libre, 1: rempli et en attente de lecture
   pthread_mutex_t mutex;
   pthread_cond_t cond;
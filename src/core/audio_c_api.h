@@ -22,6 +22,14 @@ typedef enum {
   AUDIO_BUFFER_OFFSET_FULL,
 } BUFFER_AUDIO_StateTypeDef;
 
+// Sortie audio: carte son via RtAudio, ou horloge interne sans périphérique
+// (tests headless, benchmarks)
+typedef enum {
+  AUDIO_BACKEND_RTAUDIO = 0, // Périphérique RtAudio (ALSA sur Linux)
+  AUDIO_BACKEND_NULL,        // Horloge interne, sortie ignorée
+  AUDIO_BACKEND_FILE,        // Horloge interne, sortie WAV ou raw float32
+} AudioBackendType;
+
 typedef struct AudioData {
   Float32 **buffers;
   UInt32 numChannels;
@@ -29,7 +37,7 @@ typedef struct AudioData {
 } AudioData;
 
 typedef struct {
-  float data[AUDIO_BUFFER_SIZE];
+  float data[AUDIO_BUFFER_SIZE_MAX]; // g_audio_buffer_size frames used
   int ready; // 0: libre, 1: rempli et en attente de lecture
   pthread_mutex_t mutex;
   pthread_cond_t cond;
@@ -55,6 +63,20 @@ void stopAudioUnit(void);
 void printAudioDevices(void);
 int setAudioDevice(unsigned int deviceId);
 void setRequestedAudioDevice(int deviceId);
+// A appeler avant audio_Init(). filePath (AUDIO_BACKEND_FILE uniquement) doit
+// rester valide jusqu'à audio_Init(): ".wav" pour un WAV, sinon raw.
+void setRequestedAudioBackend(AudioBackendType backend, const char *filePath);
+// Réverbération à fréquence moteur / factor (1, 2 ou 4), voir
+// AudioSystem::setReverbDecimation()
+void setRequestedReverbDecimation(int factor);
+// Réverbération à convolution avec la réponse impulsionnelle WAV path (mono ou
+// stéréo) à la place de ZitaRev1. A appeler avant audio_Init(), path doit
+// rester valide jusque-là.
+void setRequestedReverbImpulseResponse(const char *path);
+// Enregistre la sortie master dans path (WAV/RF64 si ".wav", sinon raw) pour
+// tout backend, du démarrage à l'arrêt du flux. A appeler avant audio_Init(),
+// path doit rester valide jusque-là.
+void setRequestedRecordFile(const char *path);
 
 // Control minimal callback mode for debugging audio dropouts
 void setMinimalCallbackMode(int enabled);
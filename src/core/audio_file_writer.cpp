@@ -0,0 +1,299 @@
+/*
+ * audio_file_writer.cpp
+ *
+ * Non-blocking WAV/RF64/raw output for the file audio backend and the disk
+ * recorder (see audio_file_writer.h).
+ */
+
+#include "audio_file_writer.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <strings.h>
+#include <unistd.h>
+
+// Alignment of the ring, of the header and of the data offset for O_DIRECT
+static const unsigned int kPageBytes = 4096;
+// RIFF + reserve for a ds64 chunk (8 + 28) + fmt chunk + data chunk header
+static const unsigned int kWavHeaderBytes = 80;
+
+AudioFileWriter::AudioFileWriter()
+    : fd(-1), isWav(false), direct(false), sampleRate(0), headerBytes(0),
+      ring(nullptr), ringFrames(0), head(0), tail(0), running(false),
+      droppedFrames(0), droppedBlocks(0), writtenFrames(0) {}
+
+AudioFileWriter::~AudioFileWriter() {
+  close();
+  free(ring);
+}
+
+bool AudioFileWriter::open(const char *path, unsigned int sampleRate,
+                           float ringSeconds, bool directIo) {
+  if (fd >= 0 || !path)
+    return false;
+  if (!wakeup.isValid()) {
+    std::cerr << "Réveil du thread d'écriture audio indisponible"
+              << std::endl;
+    return false;
+  }
+
+  direct = false;
+#ifdef O_DIRECT
+  if (directIo) {
+    fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    direct = fd >= 0;
+    // EINVAL: filesystem without O_DIRECT (tmpfs...), cache used instead
+  }
+#endif
+  if (fd < 0)
+    fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cerr << "Impossible d'ouvrir le fichier audio " << path << ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+  // macOS: pas d'O_DIRECT, mais le cache peut être contourné sans contrainte
+  // d'alignement
+  if (directIo)
+    direct = fcntl(fd, F_NOCACHE, 1) == 0;
+#endif
+
+  size_t len = strlen(path);
+  isWav = len >= 4 && strcasecmp(path + len - 4, ".wav") == 0;
+  headerBytes = isWav ? (direct ? kPageBytes : kWavHeaderBytes) : 0;
+  this->sampleRate = sampleRate;
+
+  unsigned int frames = WRITE_CHUNK_FRAMES;
+  while (frames < (unsigned int)(sampleRate * ringSeconds))
+    frames <<= 1;
+  if (frames != ringFrames) {
+    free(ring);
+    ring = nullptr;
+    if (posix_memalign((void **)&ring, kPageBytes,
+                       (size_t)frames * 2 * sizeof(float)) != 0) {
+      ring = nullptr;
+      ringFrames = 0;
+      ::close(fd);
+      fd = -1;
+      std::cerr << "Mémoire insuffisante pour le buffer d'écriture audio"
+                << std::endl;
+      return false;
+    }
+    ringFrames = frames;
+  }
+  head.store(0);
+  tail.store(0);
+  droppedFrames.store(0);
+  droppedBlocks.store(0);
+  writtenFrames = 0;
+
+  if (isWav) {
+    writeWavHeader(0); // Sizes are patched by close()
+    lseek(fd, headerBytes, SEEK_SET);
+  }
+
+  std::cout << "Sortie audio vers " << path << " ("
+            << (isWav ? "WAV float32" : "raw float32") << ", " << sampleRate
+            << "Hz stéréo" << (direct ? ", sans cache" : "") << ")"
+            << std::endl;
+  return true;
+}
+
+bool AudioFileWriter::start() {
+  if (fd < 0 || running.load())
+    return false;
+
+  running.store(true);
+  try {
+    writerThread = std::thread(&AudioFileWriter::writerThreadFunction, this);
+  } catch (const std::exception &e) {
+    std::cerr << "Erreur création thread d'écriture audio: " << e.what()
+              << std::endl;
+    running.store(false);
+    return false;
+  }
+  return true;
+}
+
+void AudioFileWriter::close() {
+  if (running.load()) {
+    running.store(false);
+    wakeup.post();
+    if (writerThread.joinable())
+      writerThread.join();
+  }
+
+  if (fd < 0)
+    return;
+
+#ifdef O_DIRECT
+  // Dernier chunk partiel et en-tête: tailles quelconques, via le cache
+  if (direct)
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+#endif
+  drain(true); // Partial chunk, and frames pushed after the thread exited
+
+  if (isWav)
+    writeWavHeader(writtenFrames * 2 * sizeof(float));
+  ::close(fd);
+  fd = -1;
+
+  std::cout << "Fichier audio fermé: " << writtenFrames << " frames écrites, "
+            << droppedFrames.load() << " perdues (" << droppedBlocks.load()
+            << " blocs)" << std::endl;
+}
+
+unsigned int AudioFileWriter::push(const float *left, const float *right,
+                                   unsigned int nFrames) {
+  unsigned int h = head.load(std::memory_order_relaxed);
+  unsigned int space = ringFrames - (h - tail.load(std::memory_order_acquire));
+  unsigned int dropped = 0;
+  if (nFrames > space) {
+    // Never wait for the disk: drop what does not fit
+    dropped = nFrames - space;
+    droppedFrames.fetch_add(dropped, std::memory_order_relaxed);
+    droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+    nFrames = space;
+  }
+
+  for (unsigned int i = 0; i < nFrames; i++) {
+    unsigned int idx = ((h + i) & (ringFrames - 1)) * 2;
+    ring[idx] = left[i];
+    ring[idx + 1] = right[i];
+  }
+
+  head.store(h + nFrames, std::memory_order_release);
+  // Writer woken once per complete chunk
+  if (((h ^ (h + nFrames)) & ~(WRITE_CHUNK_FRAMES - 1)) != 0)
+    wakeup.post();
+  return dropped;
+}
+
+unsigned long AudioFileWriter::getDroppedFrames() const {
+  return droppedFrames.load(std::memory_order_relaxed);
+}
+
+unsigned long AudioFileWriter::getDroppedBlocks() const {
+  return droppedBlocks.load(std::memory_order_relaxed);
+}
+
+unsigned long long AudioFileWriter::getWrittenFrames() const {
+  return writtenFrames;
+}
+
+void AudioFileWriter::writerThreadFunction() {
+  while (running.load(std::memory_order_acquire)) {
+    if (!wakeup.wait()) {
+      // close() writes whatever is left in the ring
+      std::cerr << "Thread d'écriture audio: attente impossible, arrêt"
+                << std::endl;
+      break;
+    }
+    drain(false);
+  }
+}
+
+void AudioFileWriter::drain(bool final) {
+  unsigned int t = tail.load(std::memory_order_relaxed);
+  unsigned int available = head.load(std::memory_order_acquire) - t;
+
+  while (available > 0) {
+    // Contiguous part up to the end of the ring. Outside of close(), tail
+    // stays on a chunk boundary and each write is exactly one chunk.
+    unsigned int start = t & (ringFrames - 1);
+    unsigned int count = ringFrames - start;
+    if (count > available)
+      count = available;
+    if (!final) {
+      if (count < WRITE_CHUNK_FRAMES)
+        break;
+      count = WRITE_CHUNK_FRAMES;
+    }
+
+    if (!writeAll(&ring[(size_t)start * 2],
+                  (size_t)count * 2 * sizeof(float))) {
+      std::cerr << "Erreur d'écriture du fichier audio: " << strerror(errno)
+                << std::endl;
+      break;
+    }
+    writtenFrames += count;
+    t += count;
+    available -= count;
+    tail.store(t, std::memory_order_release);
+  }
+}
+
+bool AudioFileWriter::writeAll(const void *data, size_t bytes) {
+  const char *p = static_cast<const char *>(data);
+  while (bytes > 0) {
+    ssize_t n = ::write(fd, p, bytes);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    p += n;
+    bytes -= (size_t)n;
+  }
+  return true;
+}
+
+static void putLE(unsigned char *p, unsigned long long value, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    p[i] = (unsigned char)(value >> (8 * i));
+}
+
+void AudioFileWriter::writeWavHeader(unsigned long long dataBytes) {
+  // Bloc aligné: écrit tel quel même avec O_DIRECT (ouverture)
+  unsigned char *header = nullptr;
+  if (posix_memalign((void **)&header, kPageBytes, kPageBytes) != 0)
+    return;
+  memset(header, 0, kPageBytes);
+
+  // Réserve entre "WAVE" et "fmt ": ds64 si RF64, sinon chunk JUNK
+  const unsigned int reserve = headerBytes - 44;
+  const unsigned long long riffSize = headerBytes - 8 + dataBytes;
+  const bool rf64 = riffSize > 0xFFFFFFFFull;
+
+  memcpy(header, rf64 ? "RF64" : "RIFF", 4);
+  putLE(header + 4, rf64 ? 0xFFFFFFFFull : riffSize, 4);
+  memcpy(header + 8, "WAVE", 4);
+  unsigned char *p = header + 12;
+  if (rf64) {
+    memcpy(p, "ds64", 4);
+    putLE(p + 4, 28, 4);
+    putLE(p + 8, riffSize, 8);
+    putLE(p + 16, dataBytes, 8);
+    putLE(p + 24, dataBytes / (2 * sizeof(float)), 8); // Sample frames
+    putLE(p + 32, 0, 4);                               // Table length
+    if (reserve > 36) {
+      memcpy(p + 36, "JUNK", 4);
+      putLE(p + 40, reserve - 44, 4);
+    }
+  } else {
+    memcpy(p, "JUNK", 4);
+    putLE(p + 4, reserve - 8, 4);
+  }
+  p += reserve;
+
+  memcpy(p, "fmt ", 4);
+  putLE(p + 4, 16, 4);                  // fmt chunk size
+  putLE(p + 8, 3, 2);                   // WAVE_FORMAT_IEEE_FLOAT
+  putLE(p + 10, 2, 2);                  // Channels
+  putLE(p + 12, sampleRate, 4);         // Sample rate
+  putLE(p + 16, sampleRate * 2 * 4, 4); // Byte rate
+  putLE(p + 20, 2 * 4, 2);              // Block align
+  putLE(p + 22, 32, 2);                 // Bits per sample
+  memcpy(p + 24, "data", 4);
+  putLE(p + 28, rf64 ? 0xFFFFFFFFull : dataBytes, 4);
+
+  // pwrite: la position d'écriture des données n'est pas modifiée
+  if (pwrite(fd, header, headerBytes, 0) != (ssize_t)headerBytes) {
+    std::cerr << "Erreur d'écriture de l'en-tête WAV: " << strerror(errno)
+              << std::endl;
+  }
+  free(header);
+}
@@ -0,0 +1,83 @@
+/*
+ * audio_file_writer.h
+ *
+ * Streams the stereo output to a WAV (32-bit float) or raw file from a
+ * dedicated thread: output of the file backend, and the disk recorder
+ * (--record) that copies the master output of any backend. The audio thread
+ * only copies frames into a wait-free SPSC ring: push() never blocks or
+ * touches the file, frames that do not fit are dropped and counted.
+ *
+ * The writer thread waits for whole chunks of WRITE_CHUNK_FRAMES and writes
+ * each one with a single write() call: large sequential writes, and at most
+ * one wakeup per chunk for the audio thread to post. With directIo, the file
+ * is opened with O_DIRECT where the system and filesystem support it (the
+ * ring is page-aligned and WAV data starts on a page boundary), so long
+ * recordings do not fill the page cache. The last partial chunk is written
+ * through the cache by close().
+ *
+ * WAV files reserve room for a ds64 chunk and become RF64 at close() when the
+ * data exceeds the 4 GB of a RIFF header.
+ */
+
+#ifndef AUDIO_FILE_WRITER_H
+#define AUDIO_FILE_WRITER_H
+
+#include "wake_event.h"
+#include <atomic>
+#include <thread>
+
+class AudioFileWriter {
+public:
+  static const unsigned int WRITE_CHUNK_FRAMES = 32768; // 256 KB per write
+
+  AudioFileWriter();
+  ~AudioFileWriter();
+
+  // Creates the file: WAV if the name ends with ".wav", otherwise raw
+  // interleaved float32 (native endianness). ringSeconds of audio are
+  // buffered between the audio thread and the writer thread.
+  bool open(const char *path, unsigned int sampleRate,
+            float ringSeconds = 2.0f, bool directIo = false);
+  bool start();
+  // Stops the writer thread after draining the ring, then finalizes the WAV
+  // header and closes the file
+  void close();
+  bool isOpen() const { return fd >= 0; }
+
+  // Audio thread only: non-interleaved left/right input. Returns the number
+  // of frames dropped because the ring was full (0 normally).
+  unsigned int push(const float *left, const float *right,
+                    unsigned int nFrames);
+
+  unsigned long getDroppedFrames() const;
+  unsigned long getDroppedBlocks() const; // push() calls that dropped frames
+  unsigned long long getWrittenFrames() const;
+
+private:
+  void writerThreadFunction();
+  // Writes the available frames, whole chunks only unless final
+  void drain(bool final);
+  bool writeAll(const void *data, size_t bytes);
+  void writeWavHeader(unsigned long long dataBytes);
+
+  int fd;
+  bool isWav;
+  bool direct; // O_DIRECT in effect
+  unsigned int sampleRate;
+  unsigned int headerBytes; // WAV: data chunk offset
+
+  float *ring;             // Interleaved stereo frames, page-aligned
+  unsigned int ringFrames; // Power of two, multiple of WRITE_CHUNK_FRAMES
+  alignas(64) std::atomic<unsigned int> head; // Frames pushed (audio thread)
+  alignas(64) std::atomic<unsigned int> tail; // Frames written (writer)
+
+  std::thread writerThread;
+  std::atomic<bool> running;
+  WakeEvent wakeup; // Posted by push() when a chunk is complete
+
+  std::atomic<unsigned long> droppedFrames;
+  std::atomic<unsigned long> droppedBlocks;
+  unsigned long long writtenFrames; // Writer thread, read after close()
+};
+
+#endif // AUDIO_FILE_WRITER_H
@@ -0,0 +1,102 @@
+/*
+ * audio_format.c
+ *
+ * Runtime sample rate / synth buffer size (see audio_format.h).
+ */
+
+#include "audio_format.h"
+
+#include <stdio.h>
+
+unsigned int g_sampling_frequency = DEFAULT_SAMPLING_FREQUENCY;
+unsigned int g_audio_buffer_size = DEFAULT_AUDIO_BUFFER_SIZE;
+unsigned int g_output_upsample = 1;
+unsigned int g_audio_device_buffer_size = 0;
+unsigned int g_audio_sub_block_size = 0;
+
+unsigned int audio_format_default_buffer_size(unsigned int sample_rate) {
+  // Same rule as DEFAULT_AUDIO_BUFFER_SIZE in config.h
+  if (sample_rate >= 96000)
+    return 600;
+  if (sample_rate >= 48000)
+    return 150;
+  return 128;
+}
+
+int audio_format_set(unsigned int sample_rate, unsigned int buffer_size) {
+  if (sample_rate < SAMPLING_FREQUENCY_MIN ||
+      sample_rate > SAMPLING_FREQUENCY_MAX) {
+    printf("Invalid sample rate: %u Hz (must be %d-%d)\n", sample_rate,
+           SAMPLING_FREQUENCY_MIN, SAMPLING_FREQUENCY_MAX);
+    return -1;
+  }
+
+  if (buffer_size == 0)
+    buffer_size = audio_format_default_buffer_size(sample_rate);
+
+  if (buffer_size < AUDIO_BUFFER_SIZE_MIN ||
+      buffer_size > AUDIO_BUFFER_SIZE_MAX) {
+    printf("Invalid buffer size: %u frames (must be %d-%d)\n", buffer_size,
+           AUDIO_BUFFER_SIZE_MIN, AUDIO_BUFFER_SIZE_MAX);
+    return -1;
+  }
+
+  g_sampling_frequency = sample_rate;
+  g_audio_buffer_size = buffer_size;
+  return 0;
+}
+
+int audio_format_set_output_upsampling(unsigned int factor) {
+  if (factor != 1 && factor != 2 && factor != 4) {
+    printf("Invalid output upsampling: x%u (must be 1, 2 or 4)\n", factor);
+    return -1;
+  }
+  if (g_sampling_frequency * factor > SAMPLING_FREQUENCY_MAX) {
+    printf("Invalid device rate: %u Hz (max %d)\n",
+           g_sampling_frequency * factor, SAMPLING_FREQUENCY_MAX);
+    return -1;
+  }
+
+  g_output_upsample = factor;
+  return 0;
+}
+
+unsigned int audio_format_device_rate(void) {
+  return g_sampling_frequency * g_output_upsample;
+}
+
+int audio_format_set_blocks(unsigned int device_buffer,
+                            unsigned int sub_block) {
+  if (device_buffer != 0 && (device_buffer < AUDIO_DEVICE_BUFFER_MIN ||
+                             device_buffer > AUDIO_DEVICE_BUFFER_MAX)) {
+    printf("Invalid device buffer: %u frames (must be %d-%d)\n",
+           device_buffer, AUDIO_DEVICE_BUFFER_MIN, AUDIO_DEVICE_BUFFER_MAX);
+    return -1;
+  }
+
+  // A sub-block never spans two synth buffers, larger values are useless
+  if (sub_block != 0 &&
+      (sub_block < AUDIO_SUB_BLOCK_MIN || sub_block > g_audio_buffer_size)) {
+    printf("Invalid sub-block: %u frames (must be %d-%u)\n", sub_block,
+           AUDIO_SUB_BLOCK_MIN, g_audio_buffer_size);
+    return -1;
+  }
+
+  g_audio_device_buffer_size = device_buffer;
+  g_audio_sub_block_size = sub_block;
+  return 0;
+}
+
+unsigned int audio_format_device_buffer_size(void) {
+  return g_audio_device_buffer_size ? g_audio_device_buffer_size
+                                    : g_audio_buffer_size * g_output_upsample;
+}
+
+unsigned int audio_format_sub_block_size(void) {
+  return g_audio_sub_block_size ? g_audio_sub_block_size : g_audio_buffer_size;
+}
+
+int audio_format_is_specialized(void) {
+  return g_audio_buffer_size == AUDIO_FAST_PATH_SIZE_48K ||
+         g_audio_buffer_size == AUDIO_FAST_PATH_SIZE_96K;
+}
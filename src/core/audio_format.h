@@ -0,0 +1,66 @@
+/*
+ * audio_format.h
+ *
+ * Sample rate and synth buffer size, selected at startup (--sample-rate,
+ * --buffer-size) instead of being fixed in config.h. Static audio buffers are
+ * sized for AUDIO_BUFFER_SIZE_MAX and only their first g_audio_buffer_size
+ * frames are used; the large per-note tables are allocated at startup.
+ *
+ * The device period and the callback's internal sub-block default to the synth
+ * buffer size and can be set separately (--device-buffer, --sub-block).
+ *
+ * The device may run at an integer multiple of the engine rate (--engine-rate):
+ * the engines, reverb and EQ then work at g_sampling_frequency and the output
+ * stage upsamples the mix by g_output_upsample.
+ *
+ * All values must be set before audio_Init() and the synth inits, and never
+ * change afterwards.
+ */
+
+#ifndef AUDIO_FORMAT_H
+#define AUDIO_FORMAT_H
+
+#include "config.h"
+
+extern unsigned int g_sampling_frequency; // Engine rate, Hz
+extern unsigned int g_output_upsample;    // Device rate / engine rate
+extern unsigned int g_audio_buffer_size;  // Frames per synth buffer
+extern unsigned int g_audio_device_buffer_size; // Device period, 0 = synth
+extern unsigned int g_audio_sub_block_size;     // Callback block, 0 = synth
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sets the format used by every audio module. buffer_size 0 selects the
+// default block size for that rate. Returns 0, or -1 if a value is out of
+// range (format unchanged).
+int audio_format_set(unsigned int sample_rate, unsigned int buffer_size);
+
+// Device rate as a multiple of the engine rate: 1 (default), 2 or 4. Returns
+// 0, or -1 if the factor is not supported (unchanged).
+int audio_format_set_output_upsampling(unsigned int factor);
+
+// Device sample rate, g_sampling_frequency * g_output_upsample
+unsigned int audio_format_device_rate(void);
+
+// Device period (device frames) and callback sub-block (engine frames), 0
+// selects the synth buffer size. Call after audio_format_set(). Returns 0, or
+// -1 if a value is out of range (unchanged).
+int audio_format_set_blocks(unsigned int device_buffer, unsigned int sub_block);
+
+// Effective values (the synth buffer duration when not set)
+unsigned int audio_format_device_buffer_size(void);
+unsigned int audio_format_sub_block_size(void);
+
+// Default synth buffer size for a rate (see config.h)
+unsigned int audio_format_default_buffer_size(unsigned int sample_rate);
+
+// Non-zero when the buffer size has a compile-time specialised synth path
+int audio_format_is_specialized(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_FORMAT_H */
@@ -0,0 +1,154 @@
+/*
+ * audio_params.c
+ *
+ * Control-plane parameter store (see audio_params.h).
+ */
+
+#include "audio_params.h"
+#include "config.h"
+#include <stdatomic.h>
+
+typedef struct {
+  float min;
+  float max;
+  float ramp_ms; // 0: applied as is at the next block
+} AudioParamInfo;
+
+// ZitaRev1 and the freeze cross-fade smooth their own parameters: no ramp
+static const AudioParamInfo audio_param_info[AUDIO_PARAM_COUNT] = {
+    [AUDIO_PARAM_MASTER_VOLUME] = {0.0f, 1.0f, AUDIO_PARAM_RAMP_MS},
+    [AUDIO_PARAM_MIX_LEVEL_IFFT] = {0.0f, 1.0f, AUDIO_PARAM_RAMP_MS},
+    [AUDIO_PARAM_MIX_LEVEL_FFT] = {0.0f, 1.0f, AUDIO_PARAM_RAMP_MS},
+    [AUDIO_PARAM_REVERB_SEND_IFFT] = {0.0f, 1.0f, AUDIO_PARAM_RAMP_MS},
+    [AUDIO_PARAM_REVERB_SEND_FFT] = {0.0f, 1.0f, AUDIO_PARAM_RAMP_MS},
+    [AUDIO_PARAM_REVERB_ENABLED] = {0.0f, 1.0f, 0.0f},
+    [AUDIO_PARAM_REVERB_MIX] = {0.0f, 1.0f, AUDIO_PARAM_RAMP_MS},
+    [AUDIO_PARAM_REVERB_ROOM_SIZE] = {0.0f, 1.0f, 0.0f},
+    [AUDIO_PARAM_REVERB_DAMPING] = {0.0f, 1.0f, 0.0f},
+    [AUDIO_PARAM_REVERB_WIDTH] = {0.0f, 1.0f, 0.0f},
+    [AUDIO_PARAM_SYNTH_FREEZE] = {0.0f, 1.0f, 0.0f},
+};
+
+// Version odd while a writer is storing. Version and values on separate
+// cache lines: readers poll the version without touching the values.
+// Defaults are those of the former MidiController / AudioSystem members.
+static struct {
+  _Alignas(64) atomic_uint version;
+  _Alignas(64) _Atomic float values[AUDIO_PARAM_COUNT];
+} g_audio_params = {
+    .version = 0,
+    .values =
+        {
+            [AUDIO_PARAM_MASTER_VOLUME] = 1.0f,
+            [AUDIO_PARAM_MIX_LEVEL_IFFT] = 1.0f,
+            [AUDIO_PARAM_MIX_LEVEL_FFT] = 0.5f,
+            [AUDIO_PARAM_REVERB_SEND_IFFT] = 0.7f,
+            [AUDIO_PARAM_REVERB_SEND_FFT] = 0.0f,
+            [AUDIO_PARAM_REVERB_ENABLED] = ENABLE_REVERB,
+            [AUDIO_PARAM_REVERB_MIX] = DEFAULT_REVERB_MIX,
+            [AUDIO_PARAM_REVERB_ROOM_SIZE] = DEFAULT_REVERB_ROOM_SIZE,
+            [AUDIO_PARAM_REVERB_DAMPING] = DEFAULT_REVERB_DAMPING,
+            [AUDIO_PARAM_REVERB_WIDTH] = DEFAULT_REVERB_WIDTH,
+            [AUDIO_PARAM_SYNTH_FREEZE] = 0.0f,
+        },
+};
+
+void audio_params_set(AudioParamId id, float value) {
+  const AudioParamInfo *info = &audio_param_info[id];
+  if (value < info->min) {
+    value = info->min;
+  } else if (value > info->max) {
+    value = info->max;
+  }
+
+  // Writers take turns by moving the version from even to odd (control
+  // threads only, the window is a single store)
+  unsigned int version =
+      atomic_load_explicit(&g_audio_params.version, memory_order_relaxed);
+  do {
+    version &= ~1u;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &g_audio_params.version, &version, version + 1, memory_order_relaxed,
+      memory_order_relaxed));
+  atomic_thread_fence(memory_order_release);
+
+  atomic_store_explicit(&g_audio_params.values[id], value,
+                        memory_order_relaxed);
+  atomic_store_explicit(&g_audio_params.version, version + 2,
+                        memory_order_release);
+}
+
+float audio_params_get(AudioParamId id) {
+  return atomic_load_explicit(&g_audio_params.values[id],
+                              memory_order_relaxed);
+}
+
+void audio_params_reader_init(AudioParamReader *reader, float sample_rate) {
+  reader->version = ~0u; // Odd: never a published version
+  reader->frames_per_ms = sample_rate * 1e-3f;
+  for (int i = 0; i < AUDIO_PARAM_COUNT; i++) {
+    reader->target[i] = reader->value[i] = audio_params_get((AudioParamId)i);
+    reader->start[i] = reader->value[i];
+    reader->step[i] = 0.0f;
+  }
+  audio_params_reader_update(reader, 0); // Records the current version
+}
+
+int audio_params_reader_update(AudioParamReader *reader,
+                               unsigned int nFrames) {
+  int taken = 0;
+
+  // The block starts where the previous one ended
+  for (int i = 0; i < AUDIO_PARAM_COUNT; i++) {
+    reader->start[i] = reader->value[i];
+  }
+  reader->block_frames = nFrames;
+
+  // Fast path: one acquire load per block when nothing was published
+  const unsigned int version =
+      atomic_load_explicit(&g_audio_params.version, memory_order_acquire);
+  if (version != reader->version && !(version & 1u)) {
+    float block[AUDIO_PARAM_COUNT];
+    for (int i = 0; i < AUDIO_PARAM_COUNT; i++) {
+      block[i] = atomic_load_explicit(&g_audio_params.values[i],
+                                      memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_acquire);
+    // Overlapped by a writer: keep the previous block, retry next block
+    if (atomic_load_explicit(&g_audio_params.version, memory_order_relaxed) ==
+        version) {
+      for (int i = 0; i < AUDIO_PARAM_COUNT; i++) {
+        if (block[i] == reader->target[i]) {
+          continue;
+        }
+        reader->target[i] = block[i];
+        const float rampFrames =
+            audio_param_info[i].ramp_ms * reader->frames_per_ms;
+        if (rampFrames >= 1.0f) {
+          reader->step[i] = (block[i] - reader->value[i]) / rampFrames;
+        } else {
+          reader->value[i] = block[i];
+          reader->step[i] = 0.0f;
+        }
+      }
+      reader->version = version;
+      taken = 1;
+    }
+  }
+
+  // Ramps towards the targets, to the end of this block
+  for (int i = 0; i < AUDIO_PARAM_COUNT; i++) {
+    if (reader->value[i] == reader->target[i]) {
+      continue;
+    }
+    const float step = reader->step[i];
+    float value = reader->value[i] + step * (float)nFrames;
+    if ((step >= 0.0f && value >= reader->target[i]) ||
+        (step <= 0.0f && value <= reader->target[i])) {
+      value = reader->target[i];
+    }
+    reader->value[i] = value;
+  }
+
+  return taken;
+}
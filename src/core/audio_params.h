@@ -0,0 +1,87 @@
+/*
+ * audio_params.h
+ *
+ * Parameter store of the control plane: runtime parameters published by the
+ * control threads (MIDI, CLI, GUI) and consumed once per block by the
+ * real-time threads (audio callback, reverb thread, synth thread).
+ *
+ * The store is a single versioned block of atomic values. A writer makes the
+ * version odd, stores the value and makes it even again; a reader compares
+ * the version once per block and copies the block only when it changed,
+ * keeping its previous copy (retry at the next block) if a write overlapped.
+ * Readers never wait and never take a lock.
+ *
+ * AudioParamReader adds the per-parameter smoothing: each new target is
+ * reached by a linear ramp over the parameter's ramp time, advanced once per
+ * block. Within the block, audio_params_value_at() interpolates between the
+ * values at its start and end, so gains can ramp per sample instead of in
+ * steps at the block rate. Switches and parameters already smoothed by their
+ * processor jump.
+ */
+
+#ifndef AUDIO_PARAMS_H
+#define AUDIO_PARAMS_H
+
+typedef enum {
+  AUDIO_PARAM_MASTER_VOLUME = 0,
+  AUDIO_PARAM_MIX_LEVEL_IFFT,
+  AUDIO_PARAM_MIX_LEVEL_FFT,
+  AUDIO_PARAM_REVERB_SEND_IFFT,
+  AUDIO_PARAM_REVERB_SEND_FFT,
+  AUDIO_PARAM_REVERB_ENABLED, // 0 or 1
+  AUDIO_PARAM_REVERB_MIX,
+  AUDIO_PARAM_REVERB_ROOM_SIZE,
+  AUDIO_PARAM_REVERB_DAMPING,
+  AUDIO_PARAM_REVERB_WIDTH,
+  AUDIO_PARAM_SYNTH_FREEZE, // 1: hold the current image, 0: fade back to live
+  AUDIO_PARAM_COUNT
+} AudioParamId;
+
+// Per-thread view of the store, owned by one real-time thread
+typedef struct {
+  unsigned int version;
+  float frames_per_ms;
+  float target[AUDIO_PARAM_COUNT];
+  float start[AUDIO_PARAM_COUNT]; // Smoothed, at the start of the block
+  float value[AUDIO_PARAM_COUNT]; // Smoothed, at the end of the block
+  unsigned int block_frames;      // Length of the last block
+  float step[AUDIO_PARAM_COUNT];  // Ramp increment per frame
+} AudioParamReader;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Control threads: clamps to the parameter range and publishes
+void audio_params_set(AudioParamId id, float value);
+// Latest published value (any thread, single atomic load)
+float audio_params_get(AudioParamId id);
+
+// Real-time threads. init starts from the published values, without ramp.
+void audio_params_reader_init(AudioParamReader *reader, float sample_rate);
+// Once per block of nFrames: takes a newer version if any and advances the
+// ramps to the end of the block. Returns 1 when a new version was taken.
+int audio_params_reader_update(AudioParamReader *reader, unsigned int nFrames);
+
+static inline float audio_params_value(const AudioParamReader *reader,
+                                       AudioParamId id) {
+  return reader->value[id];
+}
+
+// Smoothed value 'frames' frames into the last block (0: its start,
+// block_frames: its end)
+static inline float audio_params_value_at(const AudioParamReader *reader,
+                                          AudioParamId id,
+                                          unsigned int frames) {
+  if (frames >= reader->block_frames) {
+    return reader->value[id];
+  }
+  return reader->start[id] + (reader->value[id] - reader->start[id]) *
+                                 (float)frames / (float)reader->block_frames;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_PARAMS_H */
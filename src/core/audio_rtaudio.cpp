@@ -2,12 +2,18 @@
 
 #include "audio_rtaudio.h"
 #include "audio_c_api.h"
-#include "midi_controller.h" // For gMidiController
-#include "synth_fft.h"       // For fft_audio_buffers and related variables
+#include "audio_telemetry.h"
+#include "denormals.h"
+#include "synth_fft.h" // For fft_audio_buffers and related variables
+#include <cerrno>
+#include <cmath>
 #include <cstring>
+#include <ctime>
 #include <iostream>
+#include <pthread.h>
 #include <rtaudio/RtAudio.h> // Explicitly include RtAudio.h
 #include <stdexcept>         // For std::exception
+#include <unistd.h>
 
 // Variables globales pour compatibilité avec l'ancien code
 AudioDataBuffers buffers_L[2];
@@ -21,6 +27,11 @@ AudioSystem *gAudioSystem = nullptr;
 // created
 extern "C" {
 int g_requested_audio_device_id = -1;
+AudioBackendType g_requested_audio_backend = AUDIO_BACKEND_RTAUDIO;
+const char *g_requested_audio_file = nullptr;
+int g_requested_reverb_decimation = 1;
+const char *g_requested_reverb_ir = nullptr;
+const char *g_requested_record_file = nullptr;
 }
 
 // Minimal audio callback control
@@ -33,13 +44,35 @@ int AudioSystem::rtCallback(void *outputBuffer, void *inputBuffer,
                             RtAudioStreamStatus status, void *userData) {
   (void)inputBuffer; // Mark inputBuffer as unused
   (void)streamTime;  // Mark streamTime as unused
-  (void)status;      // Mark status as unused
   auto *audioSystem = static_cast<AudioSystem *>(userData);
-  return audioSystem->handleCallback(static_cast<float *>(outputBuffer),
-                                     nFrames);
+
+  // Telemetry: device xruns and callback wall time against the period
+  if (status) {
+    audio_telemetry_device_status((status & RTAUDIO_OUTPUT_UNDERFLOW) != 0,
+                                  (status & RTAUDIO_INPUT_OVERFLOW) != 0);
+  }
+  double start = audio_telemetry_now();
+  float *out = static_cast<float *>(outputBuffer);
+  int result = (audioSystem->upsamplerL.getFactor() > 1)
+                   ? audioSystem->renderUpsampled(out, nFrames)
+                   : audioSystem->handleCallback(out, nFrames);
+  // Enregistrement: copie dans le ring du recorder, jamais d'attente disque
+  if (audioSystem->recording) {
+    unsigned int dropped =
+        audioSystem->recorder.push(out, out + nFrames, nFrames);
+    if (dropped) {
+      audio_telemetry_recorder_dropped(dropped);
+    }
+  }
+  audio_telemetry_callback(audio_telemetry_now() - start,
+                           (double)nFrames / audioSystem->sampleRate);
+  return result;
 }
 
 int AudioSystem::handleCallback(float *outputBuffer, unsigned int nFrames) {
+  // Per-thread FPU mode: cheap, and survives a stream restart on a new thread
+  enable_flush_to_zero();
+
   // MINIMAL CALLBACK MODE - for debugging audio dropouts
   if (use_minimal_callback) {
     float *outLeft = outputBuffer;
@@ -70,119 +103,110 @@ int AudioSystem::handleCallback(float *outputBuffer, unsigned int nFrames) {
   float *outLeft = outputBuffer;
   float *outRight = outputBuffer + nFrames;
 
-  // Variables statiques pour maintenir l'état entre les appels
+  // Variables statiques pour maintenir l'état entre les appels. Chaque moteur
+  // a sa propre position dans son double buffer, et la grille des sous-blocs
+  // continue d'un callback à l'autre quelle que soit la période du device.
   static unsigned int readOffset = 0;
   static int localReadIndex = 0;
   static unsigned int fft_readOffset = 0;
   static int fft_localReadIndex = 0;
-
-  // Cache MIDI levels to avoid repeated function calls
-  static float cached_level_ifft = 1.0f;
-  static float cached_level_fft = 0.5f;
-  static float cached_volume = 1.0f;
-  static int cache_counter = 0;
-
-  // Update cache every 64 calls (~1.33ms at 48kHz, 0.67ms at 96kHz)
-  if (++cache_counter >= 64) {
-    cache_counter = 0;
-    cached_volume = this->masterVolume;
-    if (gMidiController && gMidiController->isAnyControllerConnected()) {
-      cached_level_ifft = gMidiController->getMixLevelSynthIfft();
-      cached_level_fft = gMidiController->getMixLevelSynthFft();
-    }
-  }
+  static unsigned int subBlockPos = 0;
 
   unsigned int framesToRender = nFrames;
+  const unsigned int synthBufferSize = g_audio_buffer_size;
+  const unsigned int subBlockSize = audio_format_sub_block_size();
 
-  // Process frames using multiple buffers if needed
+  // Render the device buffer in chunks that never cross a sub-block or either
+  // engine's buffer boundary
   while (framesToRender > 0) {
-    // How many frames available in current buffer?
-    unsigned int framesAvailable = AUDIO_BUFFER_SIZE - readOffset;
-    unsigned int chunk =
-        (framesToRender < framesAvailable) ? framesToRender : framesAvailable;
+    // Control parameters (MIDI, GUI), taken and smoothed once per sub-block:
+    // control rate independent of the device period
+    if (subBlockPos == 0) {
+      audio_params_reader_update(&callbackParams, subBlockSize);
+    }
+
+    unsigned int chunk = framesToRender;
+    if (chunk > subBlockSize - subBlockPos) {
+      chunk = subBlockSize - subBlockPos;
+    }
+    if (chunk > synthBufferSize - readOffset) {
+      chunk = synthBufferSize - readOffset;
+    }
+    if (chunk > synthBufferSize - fft_readOffset) {
+      chunk = synthBufferSize - fft_readOffset;
+    }
+
+    // Smoothed parameters at the start and at the end of the chunk: the mix
+    // graph ramps the gains per sample in between
+    const unsigned int chunkEnd = subBlockPos + chunk;
+    auto paramAt = [this](AudioParamId id, unsigned int frames) {
+      return audio_params_value_at(&callbackParams, id, frames);
+    };
+    // Sends below 0.01 are off, the stream keeps running silent
+    auto sendAt = [&paramAt](AudioParamId id, unsigned int frames) {
+      const float level = paramAt(id, frames);
+      return level > 0.01f ? level : 0.0f;
+    };
 
     // Get source pointers directly - avoid memcpy when possible
     float *source_ifft = nullptr;
     float *source_fft = nullptr;
 
-    if (buffers_R[localReadIndex].ready == 1) {
-      source_ifft = &buffers_R[localReadIndex].data[readOffset];
-    }
-
-    if (fft_audio_buffers[fft_localReadIndex].ready == 1) {
-      unsigned int fft_framesAvailable = AUDIO_BUFFER_SIZE - fft_readOffset;
-      if (fft_framesAvailable >= chunk) {
-        source_fft =
-            &fft_audio_buffers[fft_localReadIndex].data[fft_readOffset];
+    // Telemetry at each engine buffer boundary: fill level of the double
+    // buffer, and starved buffers (played as silence)
+    if (readOffset == 0) {
+      audio_telemetry_ring_fill(AUDIO_ENGINE_IFFT,
+                                buffers_R[0].ready + buffers_R[1].ready, 2);
+      if (buffers_R[localReadIndex].ready != 1) {
+        audio_telemetry_starved(AUDIO_ENGINE_IFFT);
       }
     }
-
-    // Get reverb send levels (cached less frequently for performance)
-    static float cached_reverb_send_ifft = 0.7f;
-    static float cached_reverb_send_fft = 0.0f;
-    static int reverb_cache_counter = 0;
-
-    // Update reverb cache every 128 calls (~1.33ms at 96kHz)
-    if (++reverb_cache_counter >= 128) {
-      reverb_cache_counter = 0;
-      if (gMidiController && gMidiController->isAnyControllerConnected()) {
-        cached_reverb_send_ifft = gMidiController->getReverbSendSynthIfft();
-        cached_reverb_send_fft = gMidiController->getReverbSendSynthFft();
+    if (fft_readOffset == 0) {
+      audio_telemetry_ring_fill(AUDIO_ENGINE_FFT,
+                                fft_audio_buffers[0].ready +
+                                    fft_audio_buffers[1].ready,
+                                2);
+      if (fft_audio_buffers[fft_localReadIndex].ready != 1) {
+        audio_telemetry_starved(AUDIO_ENGINE_FFT);
       }
     }
 
-    // OPTIMIZED MIXING - Direct to output with threaded reverb
-    for (unsigned int i = 0; i < chunk; i++) {
-      float dry_sample = 0.0f;
-
-      // Add IFFT contribution
-      if (source_ifft) {
-        dry_sample += source_ifft[i] * cached_level_ifft;
-      }
-
-      // Add FFT contribution
-      if (source_fft) {
-        dry_sample += source_fft[i] * cached_level_fft;
-      }
-
-      // Direct reverb processing in callback - ULTRA OPTIMIZED
-      float reverb_left = 0.0f, reverb_right = 0.0f;
+    if (buffers_R[localReadIndex].ready == 1) {
+      source_ifft = &buffers_R[localReadIndex].data[readOffset];
+    }
+    if (fft_audio_buffers[fft_localReadIndex].ready == 1) {
+      source_fft = &fft_audio_buffers[fft_localReadIndex].data[fft_readOffset];
+    }
 
+    // Mixing graph: sources, reverb send/return, EQ, volume and limiter
+    mixGraph.setSourceInput(mixSourceIfft, source_ifft);
+    mixGraph.setSourceInput(mixSourceFft, source_fft);
+    mixGraph.setSourceGain(mixSourceIfft,
+                           paramAt(AUDIO_PARAM_MIX_LEVEL_IFFT, subBlockPos),
+                           paramAt(AUDIO_PARAM_MIX_LEVEL_IFFT, chunkEnd));
+    mixGraph.setSourceGain(mixSourceFft,
+                           paramAt(AUDIO_PARAM_MIX_LEVEL_FFT, subBlockPos),
+                           paramAt(AUDIO_PARAM_MIX_LEVEL_FFT, chunkEnd));
+    // Keep streaming (silent send) while the send levels are off so the
+    // reverb tail decays naturally and the block stream stays aligned
+    mixGraph.setSendLevel(mixSourceIfft, mixReturnReverb,
+                          sendAt(AUDIO_PARAM_REVERB_SEND_IFFT, subBlockPos),
+                          sendAt(AUDIO_PARAM_REVERB_SEND_IFFT, chunkEnd));
+    mixGraph.setSendLevel(mixSourceFft, mixReturnReverb,
+                          sendAt(AUDIO_PARAM_REVERB_SEND_FFT, subBlockPos),
+                          sendAt(AUDIO_PARAM_REVERB_SEND_FFT, chunkEnd));
 #if ENABLE_REVERB
-      if (reverbEnabled &&
-          (cached_reverb_send_ifft > 0.01f || cached_reverb_send_fft > 0.01f)) {
-        float reverb_input = 0.0f;
-        if (source_ifft && cached_reverb_send_ifft > 0.01f) {
-          reverb_input +=
-              source_ifft[i] * cached_level_ifft * cached_reverb_send_ifft;
-        }
-        if (source_fft && cached_reverb_send_fft > 0.01f) {
-          reverb_input +=
-              source_fft[i] * cached_level_fft * cached_reverb_send_fft;
-        }
-
-        // Single-sample reverb processing (optimized)
-        processReverbOptimized(reverb_input, reverb_input, reverb_left,
-                               reverb_right);
-      }
+    mixGraph.setReturnEnabled(
+        mixReturnReverb,
+        audio_params_value(&callbackParams, AUDIO_PARAM_REVERB_ENABLED) >
+            0.5f);
+#else
+    mixGraph.setReturnEnabled(mixReturnReverb, false);
 #endif
-
-      // Mix dry + reverb and apply volume
-      float final_left = (dry_sample + reverb_left) * cached_volume;
-      float final_right = (dry_sample + reverb_right) * cached_volume;
-
-      // Limiting
-      final_left = (final_left > 1.0f)    ? 1.0f
-                   : (final_left < -1.0f) ? -1.0f
-                                          : final_left;
-      final_right = (final_right > 1.0f)    ? 1.0f
-                    : (final_right < -1.0f) ? -1.0f
-                                            : final_right;
-
-      // Output
-      outLeft[i] = final_left;
-      outRight[i] = final_right;
-    }
+    mixGraph.setMasterVolume(paramAt(AUDIO_PARAM_MASTER_VOLUME, subBlockPos),
+                             paramAt(AUDIO_PARAM_MASTER_VOLUME, chunkEnd));
+    reverbMixEnd = paramAt(AUDIO_PARAM_REVERB_MIX, chunkEnd);
+    mixGraph.process(outLeft, outRight, chunk);
 
     // Advance pointers
     outLeft += chunk;
@@ -190,9 +214,13 @@ int AudioSystem::handleCallback(float *outputBuffer, unsigned int nFrames) {
     readOffset += chunk;
     fft_readOffset += chunk;
     framesToRender -= chunk;
+    subBlockPos += chunk;
+    if (subBlockPos >= subBlockSize) {
+      subBlockPos = 0;
+    }
 
     // Handle buffer transitions - IFFT
-    if (readOffset >= AUDIO_BUFFER_SIZE) {
+    if (readOffset >= synthBufferSize) {
       if (buffers_R[localReadIndex].ready == 1) {
         pthread_mutex_lock(&buffers_R[localReadIndex].mutex);
         buffers_R[localReadIndex].ready = 0;
@@ -204,7 +232,7 @@ int AudioSystem::handleCallback(float *outputBuffer, unsigned int nFrames) {
     }
 
     // Handle buffer transitions - FFT
-    if (fft_readOffset >= AUDIO_BUFFER_SIZE) {
+    if (fft_readOffset >= synthBufferSize) {
       if (fft_audio_buffers[fft_localReadIndex].ready == 1) {
         pthread_mutex_lock(&fft_audio_buffers[fft_localReadIndex].mutex);
         fft_audio_buffers[fft_localReadIndex].ready = 0;
@@ -219,6 +247,60 @@ int AudioSystem::handleCallback(float *outputBuffer, unsigned int nFrames) {
   return 0;
 }
 
+int AudioSystem::renderUpsampled(float *outputBuffer, unsigned int nFrames) {
+  const unsigned int factor = (unsigned int)upsamplerL.getFactor();
+  float *outLeft = outputBuffer;
+  float *outRight = outputBuffer + nFrames;
+  unsigned int done = 0;
+  int result = 0;
+
+  // Fin de la frame moteur entamée au callback précédent
+  while (upsamplePendingPos < upsamplePendingCount && done < nFrames) {
+    outLeft[done] = upsamplePendingL[upsamplePendingPos];
+    outRight[done] = upsamplePendingR[upsamplePendingPos];
+    upsamplePendingPos++;
+    done++;
+  }
+
+  while (done < nFrames) {
+    unsigned int engineFrames = (nFrames - done) / factor;
+    if (engineFrames > AUDIO_BUFFER_SIZE_MAX) {
+      engineFrames = AUDIO_BUFFER_SIZE_MAX;
+    }
+
+    if (engineFrames == 0) {
+      // Moins d'une frame moteur restante: la rendre entière et garder les
+      // phases suivantes pour le prochain callback
+      result |= handleCallback(upsampleScratch, 1);
+      upsamplerL.process(&upsampleScratch[0], 1, upsamplePendingL);
+      upsamplerR.process(&upsampleScratch[1], 1, upsamplePendingR);
+      upsamplePendingCount = factor;
+      upsamplePendingPos = 0;
+      while (done < nFrames) {
+        outLeft[done] = upsamplePendingL[upsamplePendingPos];
+        outRight[done] = upsamplePendingR[upsamplePendingPos];
+        upsamplePendingPos++;
+        done++;
+      }
+      break;
+    }
+
+    // handleCallback écrit gauche puis droite (non entrelacé)
+    result |= handleCallback(upsampleScratch, engineFrames);
+    upsamplerL.process(upsampleScratch, engineFrames, outLeft + done);
+    upsamplerR.process(upsampleScratch + engineFrames, engineFrames,
+                       outRight + done);
+    done += engineFrames * factor;
+  }
+
+  // Le filtre d'interpolation peut dépasser légèrement le limiteur
+  for (unsigned int i = 0; i < nFrames; i++) {
+    outLeft[i] = fminf(fmaxf(outLeft[i], -1.0f), 1.0f);
+    outRight[i] = fminf(fmaxf(outRight[i], -1.0f), 1.0f);
+  }
+  return result;
+}
+
 // Constructeur
 AudioSystem::AudioSystem(unsigned int sampleRate, unsigned int bufferSize,
                          unsigned int channels)
@@ -227,10 +309,35 @@ AudioSystem::AudioSystem(unsigned int sampleRate, unsigned int bufferSize,
       sampleRate(sampleRate), bufferSize(bufferSize), channels(channels),
       requestedDeviceId(g_requested_audio_device_id), // Use global variable if
                                                       // set, otherwise -1
-      masterVolume(1.0f), reverbBuffer(nullptr), reverbMix(DEFAULT_REVERB_MIX),
-      reverbRoomSize(DEFAULT_REVERB_ROOM_SIZE),
-      reverbDamping(DEFAULT_REVERB_DAMPING), reverbWidth(DEFAULT_REVERB_WIDTH),
-      reverbEnabled(ENABLE_REVERB), reverbThreadRunning(false) {
+      backend(g_requested_audio_backend),
+      outputFilePath(g_requested_audio_file ? g_requested_audio_file : ""),
+      recordFilePath(g_requested_record_file ? g_requested_record_file : ""),
+      recording(false),
+      clockThreadRunning(false), upsamplePendingPos(0),
+      upsamplePendingCount(0),
+      reverbBuffer(nullptr), reverbThreadRunning(false),
+      reverbLatencyBlocks(1), reverbBlockSeq(-1),
+      reverbBlockPos(REVERB_BLOCK_FRAMES), reverbSendSlot(nullptr),
+      reverbWetSlot(nullptr), reverbMissedBlocks(0), reverbDroppedBlocks(0),
+      reverbWetGain(0.0f), reverbMixEnd(0.0f), reverbFadeInFrames(0),
+      appliedRoomSize(-1.0f), appliedDamping(-1.0f), appliedWidth(-1.0f),
+      reverbDecimation(g_requested_reverb_decimation),
+      appliedReverbDecimation(1) {
+
+  audio_params_reader_init(&callbackParams, (float)g_sampling_frequency);
+  audio_params_reader_init(&reverbParams, (float)g_sampling_frequency);
+
+  // Suréchantillonnage de sortie (--engine-rate): handleCallback ne rend
+  // jamais plus de AUDIO_BUFFER_SIZE_MAX frames moteur à la fois
+  upsamplerL.init((int)g_output_upsample, AUDIO_BUFFER_SIZE_MAX);
+  upsamplerR.init((int)g_output_upsample, AUDIO_BUFFER_SIZE_MAX);
+  if (g_output_upsample > 1) {
+    std::cout << "Moteurs à " << g_sampling_frequency << "Hz, sortie x"
+              << g_output_upsample << " (" << audio_format_device_rate()
+              << "Hz, FIR polyphase " << PolyphaseUpsampler::TAPS_PER_PHASE
+              << " coefs/phase, latence " << upsamplerL.getLatencyFrames()
+              << " frames)" << std::endl;
+  }
 
   std::cout << "\033[1;32m[ZitaRev1] Reverb enabled by default with "
                "Zita-Rev1 algorithm\033[0m"
@@ -256,7 +363,7 @@ AudioSystem::AudioSystem(unsigned int sampleRate, unsigned int bufferSize,
 
   // Configuration de ZitaRev1 avec des valeurs pour une réverbération longue et
   // douce
-  zitaRev.init(sampleRate);
+  zitaRev.init(g_sampling_frequency); // Réverbération à la fréquence moteur
   zitaRev.set_roomsize(
       0.95f); // Très grande taille de pièce pour une réverb longue
   zitaRev.set_damping(0.4f); // Amortissement des hautes fréquences réduit pour
@@ -265,6 +372,37 @@ AudioSystem::AudioSystem(unsigned int sampleRate, unsigned int bufferSize,
   zitaRev.set_delay(
       0.08f);            // Pre-delay plus important pour clarté et séparation
   zitaRev.set_mix(0.7f); // 70% wet pour équilibre entre clarté et présence
+
+  // Graphe de mixage du callback: IFFT et FFT vers le master, chacun avec un
+  // send vers le retour réverbération, EQ trois bandes puis limiteur en
+  // inserts master
+  mixSourceIfft = mixGraph.addSource("ifft");
+  mixSourceFft = mixGraph.addSource("fft");
+  mixReturnReverb = mixGraph.addReturn("reverb");
+  mixGraph.addSend(mixSourceIfft, mixReturnReverb);
+  mixGraph.addSend(mixSourceFft, mixReturnReverb);
+  reverbReturnInsert.owner = this;
+  mixGraph.addReturnInsert(mixReturnReverb, &reverbReturnInsert);
+  mixGraph.addMasterInsert(&masterEqualizerInsert);
+  masterLimiter.init(g_sampling_frequency, MASTER_LIMITER_LOOKAHEAD_MS,
+                     MASTER_LIMITER_RELEASE_MS, MASTER_LIMITER_CEILING);
+  mixGraph.addMasterInsert(&masterLimiter);
+  mixGraph.compile();
+  std::cout << "[MIX] Limiteur master: plafond " << MASTER_LIMITER_CEILING
+            << ", latence " << masterLimiter.getLatencyFrames() << " frames ("
+            << masterLimiter.getLatencyFrames() * 1000.0 / g_sampling_frequency
+            << "ms)" << std::endl;
+  mixGraph.printPlan();
+
+  // Réponse impulsionnelle chargée une fois, à la fréquence moteur; en cas
+  // d'échec ZitaRev1 reste actif
+  if (g_requested_reverb_ir &&
+      convolutionReverb.load(g_requested_reverb_ir, g_sampling_frequency,
+                             REVERB_BLOCK_FRAMES)) {
+    std::cout << "\033[1;32m[CONV] Réverbération à convolution à la place de "
+                 "ZitaRev1\033[0m"
+              << std::endl;
+  }
 }
 
 // Destructeur
@@ -289,16 +427,16 @@ AudioSystem::~AudioSystem() {
 void AudioSystem::processReverb(float inputL, float inputR, float &outputL,
                                 float &outputR) {
   // Si réverbération désactivée, sortie = entrée
-  if (!reverbEnabled) {
+  if (!isReverbEnabled()) {
     outputL = inputL;
     outputR = inputR;
     return;
   }
 
   // Mise à jour des paramètres ZitaRev1 en fonction des contrôles MIDI
-  zitaRev.set_roomsize(reverbRoomSize);
-  zitaRev.set_damping(reverbDamping);
-  zitaRev.set_width(reverbWidth);
+  zitaRev.set_roomsize(getReverbRoomSize());
+  zitaRev.set_damping(getReverbDamping());
+  zitaRev.set_width(getReverbWidth());
   // Le mix est géré séparément dans notre code
 
   // Buffers temporaires pour traitement ZitaRev1
@@ -313,158 +451,184 @@ void AudioSystem::processReverb(float inputL, float inputR, float &outputL,
   // Mélanger le signal sec et le signal traité (wet)
   // Utiliser une courbe linéaire pour une réverbération plus douce
   float wetGain =
-      reverbMix; // Relation directe entre le paramètre et le gain wet
+      getReverbMix(); // Relation directe entre le paramètre et le gain wet
 
   // Balance simple entre signal sec et humide
-  float dryGain = 1.0f - reverbMix; // Relation inverse pour un total de 100%
+  float dryGain = 1.0f - wetGain; // Relation inverse pour un total de 100%
 
   // Mélanger les signaux
   outputL = inputL * dryGain + outBufferL[0] * wetGain;
   outputR = inputR * dryGain + outBufferR[0] * wetGain;
 }
 
-// ULTRA-OPTIMIZED reverb function for real-time callback
-void AudioSystem::processReverbOptimized(float inputL, float inputR,
-                                         float &outputL, float &outputR) {
-  // Si réverbération désactivée, sortie = entrée
-  if (!reverbEnabled) {
-    outputL = inputL;
-    outputR = inputR;
-    return;
+// Block reverb processing, reverb thread only. ZitaRev1 (prepare + process)
+// runs once per block; the output is 100% wet, the dry/wet mix and fade-in
+// are applied by the callback.
+void AudioSystem::processReverbBlock(const float *input, float *outputL,
+                                     float *outputR, unsigned int numFrames) {
+  // Paramètres transmis à ZitaRev1 seulement s'ils ont changé : chaque
+  // set_*() force Reverb::prepare() à recalculer ses filtres. Le gain de
+  // sortie interne de ZitaRev1 est déjà interpolé sur le bloc par prepare().
+  audio_params_reader_update(&reverbParams, numFrames);
+  const float roomSize =
+      audio_params_value(&reverbParams, AUDIO_PARAM_REVERB_ROOM_SIZE);
+  const float damping =
+      audio_params_value(&reverbParams, AUDIO_PARAM_REVERB_DAMPING);
+  const float width =
+      audio_params_value(&reverbParams, AUDIO_PARAM_REVERB_WIDTH);
+  if (roomSize != appliedRoomSize) {
+    appliedRoomSize = roomSize;
+    zitaRev.set_roomsize(appliedRoomSize);
+  }
+  if (damping != appliedDamping) {
+    appliedDamping = damping;
+    zitaRev.set_damping(appliedDamping);
+  }
+  if (width != appliedWidth) {
+    appliedWidth = width;
+    zitaRev.set_width(appliedWidth);
   }
 
-  // Cache statique pour éviter les calculs répétitifs
-  static float cached_wet_gain = 0.0f; // Commence à 0 pour fade-in
-  static float cached_dry_gain = 1.0f; // Compense pour avoir 100% du signal
-  static int param_update_counter = 0;
-
-  // Gestion du fade-in pour éviter les clics/pops au démarrage
-  static bool fade_in_complete = false;
-  static int fade_in_counter = 0;
-  static const int FADE_IN_DURATION = 4800; // ~50ms à 96kHz
-
-  // Initialiser les paramètres de réverb avant tout traitement
-  if (!fade_in_complete) {
-    if (fade_in_counter == 0) {
-      // Effacer explicitement les buffers internes pour éviter les craquements
-      zitaRev.clear();
-      // Initialiser les paramètres de base
-      zitaRev.set_roomsize(reverbRoomSize);
-      zitaRev.set_damping(reverbDamping);
-      zitaRev.set_width(reverbWidth);
-    }
-
-    // Fade-in progressif
-    if (++fade_in_counter >= FADE_IN_DURATION) {
-      fade_in_complete = true;
-      cached_wet_gain = reverbMix;
-      cached_dry_gain = 1.0f - reverbMix;
-    } else {
-      // Augmentation progressive du wet gain
-      float fade_ratio = (float)fade_in_counter / FADE_IN_DURATION;
-      cached_wet_gain = reverbMix * fade_ratio;
-      cached_dry_gain = 1.0f - cached_wet_gain; // Toujours 100% du signal
-    }
+  if (convolutionReverb.isLoaded()) {
+    convolutionReverb.process(input, outputL, outputR);
+    return;
   }
-  // Mise à jour régulière des paramètres une fois le fade-in terminé
-  else if (++param_update_counter >= 256) {
-    param_update_counter = 0;
-    cached_wet_gain = reverbMix;
-    cached_dry_gain = 1.0f - reverbMix;
 
-    // Mettre à jour les paramètres ZitaRev1 moins fréquemment
-    zitaRev.set_roomsize(reverbRoomSize);
-    zitaRev.set_damping(reverbDamping);
-    zitaRev.set_width(reverbWidth);
+  const int factor = reverbDecimation.load(std::memory_order_relaxed);
+  if (factor != appliedReverbDecimation) {
+    configureReverbRate(factor);
   }
 
-  // Traitement ZitaRev1 optimisé - un seul échantillon
-  float inBufferL[1] = {inputL};
-  float inBufferR[1] = {inputR};
-  float outBufferL[1] = {0.0f};
-  float outBufferR[1] = {0.0f};
+  // Mono vers stéréo : la même entrée alimente les deux canaux
+  if (factor == 1) {
+    float *in = const_cast<float *>(input);
+    zitaRev.process(in, in, outputL, outputR, numFrames);
+    return;
+  }
 
-  // Appel direct à ZitaRev1 (le coût principal)
-  zitaRev.process(inBufferL, inBufferR, outBufferL, outBufferR, 1);
+  const unsigned int lowFrames = numFrames / factor;
+  reverbDecimator.process(input, numFrames, reverbLowRateIn);
+  zitaRev.process(reverbLowRateIn, reverbLowRateIn, reverbLowRateL,
+                  reverbLowRateR, lowFrames);
+  reverbUpsamplerL.process(reverbLowRateL, lowFrames, outputL);
+  reverbUpsamplerR.process(reverbLowRateR, lowFrames, outputR);
+}
 
-  // Mix optimisé avec gains en cache
-  outputL = inputL * cached_dry_gain + outBufferL[0] * cached_wet_gain;
-  outputR = inputR * cached_dry_gain + outBufferR[0] * cached_wet_gain;
+// Passe ZitaRev1 à g_sampling_frequency / factor (thread de réverbération).
+// Réallouer les lignes de ZitaRev1 vide la queue: un changement de qualité
+// coupe la réverbération en cours.
+void AudioSystem::configureReverbRate(int factor) {
+  zitaRev.setSampleRate((float)g_sampling_frequency / factor);
+  reverbDecimator.init(factor, REVERB_BLOCK_FRAMES, REVERB_RESAMPLER_TAPS,
+                       60.0f);
+  reverbUpsamplerL.init(factor, REVERB_BLOCK_FRAMES / factor,
+                        REVERB_RESAMPLER_TAPS, 60.0f);
+  reverbUpsamplerR.init(factor, REVERB_BLOCK_FRAMES / factor,
+                        REVERB_RESAMPLER_TAPS, 60.0f);
+  appliedReverbDecimation = factor;
 }
 
-// === MULTI-THREADED REVERB IMPLEMENTATION ===
+// Insert of the reverb return bus (audio thread): the bus holds the mono send
+// on both channels. Streams it to the reverb thread in fixed blocks, reads
+// back the wet blocks returned reverbLatencyBlocks earlier and replaces the
+// bus with the dry/wet mix. No ZitaRev1 work happens here.
+void AudioSystem::processReverbReturn(float *left, float *right,
+                                      unsigned int nFrames) {
+  std::memcpy(reverbSendChunk, left, nFrames * sizeof(float));
+
+  for (unsigned int i = 0; i < nFrames;) {
+    if (reverbBlockPos >= REVERB_BLOCK_FRAMES) {
+      advanceReverbBlock();
+    }
+    unsigned int n = REVERB_BLOCK_FRAMES - reverbBlockPos;
+    if (n > nFrames - i) {
+      n = nFrames - i;
+    }
 
-// Fonction pour écrire dans le buffer d'entrée de la réverbération
-// (thread-safe)
-bool AudioSystem::writeToReverbInput(float sample) {
-  int currentWrite = reverbInputBuffer.write_pos.load();
-  int nextWrite = (currentWrite + 1) % REVERB_THREAD_BUFFER_SIZE;
+    float *send =
+        reverbSendSlot ? reverbSendSlot->data : reverbSendScratch.data;
+    std::memcpy(&send[reverbBlockPos], &reverbSendChunk[i], n * sizeof(float));
+    if (reverbWetSlot) {
+      std::memcpy(&left[i], &reverbWetSlot->left[reverbBlockPos],
+                  n * sizeof(float));
+      std::memcpy(&right[i], &reverbWetSlot->right[reverbBlockPos],
+                  n * sizeof(float));
+    } else {
+      // Wet block missed (or pre-roll): dry only
+      std::memset(&left[i], 0, n * sizeof(float));
+      std::memset(&right[i], 0, n * sizeof(float));
+    }
 
-  // Vérifier si le buffer n'est pas plein
-  if (nextWrite == reverbInputBuffer.read_pos.load()) {
-    return false; // Buffer plein
+    reverbBlockPos += n;
+    i += n;
   }
 
-  reverbInputBuffer.data[currentWrite] = sample;
-  reverbInputBuffer.write_pos.store(nextWrite);
-  reverbInputBuffer.available_samples.fetch_add(1);
-
-  return true;
-}
-
-// Fonction pour lire depuis le buffer d'entrée de la réverbération
-// (thread-safe)
-bool AudioSystem::readFromReverbInput(float &sample) {
-  if (reverbInputBuffer.available_samples.load() == 0) {
-    return false; // Buffer vide
+  // Gain wet visé en fin de chunk (fade-in inclus), rampe linéaire
+  float targetWetGain = reverbMixEnd;
+  if (reverbFadeInFrames < REVERB_FADE_IN_FRAMES) {
+    reverbFadeInFrames += (int)nFrames;
+    if (reverbFadeInFrames > REVERB_FADE_IN_FRAMES) {
+      reverbFadeInFrames = REVERB_FADE_IN_FRAMES;
+    }
+    targetWetGain *= (float)reverbFadeInFrames / REVERB_FADE_IN_FRAMES;
   }
-
-  int currentRead = reverbInputBuffer.read_pos.load();
-  sample = reverbInputBuffer.data[currentRead];
-
-  int nextRead = (currentRead + 1) % REVERB_THREAD_BUFFER_SIZE;
-  reverbInputBuffer.read_pos.store(nextRead);
-  reverbInputBuffer.available_samples.fetch_sub(1);
-
-  return true;
+  float wetGain = reverbWetGain;
+  const float wetStep = (targetWetGain - reverbWetGain) / (float)nFrames;
+  for (unsigned int i = 0; i < nFrames; i++) {
+    wetGain += wetStep;
+    const float dryGain = 1.0f - wetGain; // Toujours 100% du signal
+    left[i] = reverbSendChunk[i] * dryGain + left[i] * wetGain;
+    right[i] = reverbSendChunk[i] * dryGain + right[i] * wetGain;
+  }
+  reverbWetGain = targetWetGain;
 }
 
-// Fonction pour écrire dans le buffer de sortie de la réverbération
-// (thread-safe)
-bool AudioSystem::writeToReverbOutput(float sampleL, float sampleR) {
-  int currentWrite = reverbOutputBuffer.write_pos.load();
-  int nextWrite = (currentWrite + 1) % REVERB_THREAD_BUFFER_SIZE;
+// === MULTI-THREADED REVERB IMPLEMENTATION ===
 
-  // Vérifier si le buffer n'est pas plein
-  if (nextWrite == reverbOutputBuffer.read_pos.load()) {
-    return false; // Buffer plein
+// Passe au bloc suivant du flux reverb (callback uniquement, sans attente).
+// Le bloc send n est rendu par le thread comme bloc wet n, joué à la place du
+// bloc n + reverbLatencyBlocks : la latence du chemin wet est donc fixe.
+void AudioSystem::advanceReverbBlock() {
+  if (reverbBlockSeq >= 0) {
+    // Envoyer le bloc send terminé
+    if (reverbSendSlot) {
+      reverbSendSlot->seq = reverbBlockSeq;
+      reverbSendRing.commitWrite();
+      reverbWakeup.post();
+    }
+    // Libérer le bloc wet joué
+    if (reverbWetSlot) {
+      reverbWetRing.releaseRead();
+    }
   }
 
-  reverbOutputBuffer.left[currentWrite] = sampleL;
-  reverbOutputBuffer.right[currentWrite] = sampleR;
-  reverbOutputBuffer.write_pos.store(nextWrite);
-  reverbOutputBuffer.available_samples.fetch_add(1);
-
-  return true;
-}
+  reverbBlockSeq++;
+  reverbBlockPos = 0;
 
-// Fonction pour lire depuis le buffer de sortie de la réverbération
-// (thread-safe)
-bool AudioSystem::readFromReverbOutput(float &sampleL, float &sampleR) {
-  if (reverbOutputBuffer.available_samples.load() == 0) {
-    sampleL = sampleR = 0.0f; // Silence si pas de données
-    return false;
+  reverbSendSlot = reverbSendRing.writeSlot();
+  if (!reverbSendSlot) {
+    // Thread reverb bloqué depuis plus de REVERB_RING_BLOCKS blocs
+    reverbDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
   }
 
-  int currentRead = reverbOutputBuffer.read_pos.load();
-  sampleL = reverbOutputBuffer.left[currentRead];
-  sampleR = reverbOutputBuffer.right[currentRead];
+  reverbWetSlot = nullptr;
+  const long long expected = reverbBlockSeq - reverbLatencyBlocks;
+  if (expected < 0) {
+    return; // Pré-roll: pas encore de wet attendu
+  }
 
-  int nextRead = (currentRead + 1) % REVERB_THREAD_BUFFER_SIZE;
-  reverbOutputBuffer.read_pos.store(nextRead);
-  reverbOutputBuffer.available_samples.fetch_sub(1);
+  // Écarter les blocs arrivés trop tard pour leur créneau
+  ReverbWetBlock *wet = reverbWetRing.readSlot();
+  while (wet && wet->seq < expected) {
+    reverbWetRing.releaseRead();
+    wet = reverbWetRing.readSlot();
+  }
 
-  return true;
+  if (wet && wet->seq == expected) {
+    reverbWetSlot = wet;
+  } else {
+    reverbMissedBlocks.fetch_add(1, std::memory_order_relaxed);
+  }
 }
 
 // Fonction principale du thread de réverbération
@@ -473,72 +637,155 @@ void AudioSystem::reverbThreadFunction() {
       << "\033[1;33m[REVERB THREAD] Thread de réverbération démarré\033[0m"
       << std::endl;
 
-  const int processingBlockSize = 64; // Traiter par blocs pour l'efficacité
-  float inputBuffer[processingBlockSize];
-  float outputBufferL[processingBlockSize];
-  float outputBufferR[processingBlockSize];
+#if defined(__linux__) && REVERB_THREAD_CPU != -1
+  // Cœur dédié, à l'écart des workers de synthèse (CPU 1-3) et du CPU 0
+  int reverbCpu = REVERB_THREAD_CPU;
+  if (reverbCpu == REVERB_THREAD_CPU_AUTO) {
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    reverbCpu = online > 4 ? 4 : (int)online - 1;
+  }
+  if (reverbCpu >= 0) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(reverbCpu, &cpuset);
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                        &cpuset);
+    if (result == 0) {
+      std::cout << "[REVERB THREAD] Assigné au CPU " << reverbCpu
+                << std::endl;
+    } else {
+      std::cout << "[REVERB THREAD] Impossible d'assigner le CPU "
+                << reverbCpu << " (erreur: " << result << ")" << std::endl;
+    }
+  }
+#endif
+
+  // Queue de réverbération: pas de dénormaux dans les feedbacks ZitaRev1
+  enable_flush_to_zero();
+
+  // Effacer les buffers internes pour éviter les craquements au démarrage
+  zitaRev.clear();
+  appliedRoomSize = appliedDamping = appliedWidth = -1.0f;
 
   while (reverbThreadRunning.load()) {
-    int samplesProcessed = 0;
-
-    // Lire un bloc de samples depuis le buffer d'entrée
-    for (int i = 0; i < processingBlockSize; i++) {
-      float sample;
-      if (readFromReverbInput(sample)) {
-        inputBuffer[i] = sample;
-        samplesProcessed++;
+    // Attendre un bloc (stop() poste aussi le réveil)
+    if (!reverbWakeup.wait()) {
+      std::cerr << "[REVERB THREAD] Attente du réveil impossible, arrêt"
+                << std::endl;
+      break;
+    }
+
+    ReverbSendBlock *send;
+    while ((send = reverbSendRing.readSlot()) != nullptr) {
+      ReverbWetBlock *wet = reverbWetRing.writeSlot();
+      if (wet) {
+        processReverbBlock(send->data, wet->left, wet->right,
+                           REVERB_BLOCK_FRAMES);
+        wet->seq = send->seq;
+        reverbWetRing.commitWrite();
       } else {
-        inputBuffer[i] = 0.0f; // Silence si pas de données
+        // Le callback ne consomme plus (reverb désactivée)
+        reverbDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
       }
+      reverbSendRing.releaseRead();
     }
+  }
 
-    if (samplesProcessed > 0 && reverbEnabled) {
-      // Traiter la réverbération par blocs pour l'efficacité
-      for (int i = 0; i < processingBlockSize; i++) {
-        // Mise à jour des paramètres ZitaRev1 (de temps en temps)
-        if (i == 0) { // Seulement au début du bloc
-          zitaRev.set_roomsize(reverbRoomSize);
-          zitaRev.set_damping(reverbDamping);
-          zitaRev.set_width(reverbWidth);
-        }
+  std::cout << "\033[1;33m[REVERB THREAD] Thread de réverbération arrêté\033[0m"
+            << std::endl;
+}
 
-        // Traitement mono vers stéréo
-        float inBufferL[1] = {inputBuffer[i]};
-        float inBufferR[1] = {inputBuffer[i]};
-        float outBufferL_single[1] = {0.0f};
-        float outBufferR_single[1] = {0.0f};
+// Initialisation des backends sans périphérique (null, file)
+bool AudioSystem::initializeClockBackend() {
+  clockOutputBuffer.assign((size_t)bufferSize * channels, 0.0f);
 
-        // Traiter via ZitaRev1
-        zitaRev.process(inBufferL, inBufferR, outBufferL_single,
-                        outBufferR_single, 1);
+  if (backend == AUDIO_BACKEND_FILE &&
+      !fileWriter.open(outputFilePath.c_str(), sampleRate)) {
+    return false;
+  }
 
-        // Appliquer le mix dry/wet
-        float wetGain = reverbMix;
-        float dryGain = 1.0f - reverbMix;
+  std::cout << "Backend audio "
+            << (backend == AUDIO_BACKEND_FILE ? "fichier" : "null")
+            << " (horloge interne): "
+            << "SR=" << sampleRate << "Hz, "
+            << "BS=" << bufferSize << " frames, "
+            << "Période=" << bufferSize * 1000.0 / sampleRate << "ms"
+            << std::endl;
+  return true;
+}
 
-        outputBufferL[i] =
-            inputBuffer[i] * dryGain + outBufferL_single[0] * wetGain;
-        outputBufferR[i] =
-            inputBuffer[i] * dryGain + outBufferR_single[0] * wetGain;
-      }
+// Thread horloge des backends null/file: appelle rtCallback à chaque période
+// sur des échéances absolues (pas de dérive), comme le ferait le périphérique
+void AudioSystem::clockThreadFunction() {
+  // Même priorité temps réel que le flux RtAudio (options.priority)
+  struct sched_param param;
+  param.sched_priority = 90;
+  if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+    std::cout << "Horloge audio: priorité temps réel indisponible, "
+                 "ordonnancement normal"
+              << std::endl;
+  }
 
-      // Écrire les résultats dans le buffer de sortie
-      for (int i = 0; i < processingBlockSize; i++) {
-        // Tenter d'écrire, ignorer si le buffer de sortie est plein
-        writeToReverbOutput(outputBufferL[i], outputBufferR[i]);
+  const long long periodNs = (long long)bufferSize * 1000000000LL / sampleRate;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  long long originNs = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+  unsigned long long framesRendered = 0;
+  float *outLeft = clockOutputBuffer.data();
+  float *outRight = outLeft + bufferSize;
+
+  while (clockThreadRunning.load(std::memory_order_acquire)) {
+    // Échéance du buffer en cours, calculée depuis l'origine en frames
+    long long dueNs =
+        originNs + (long long)(framesRendered * 1000000000ULL / sampleRate);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    long long nowNs = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+    RtAudioStreamStatus status = 0;
+    if (nowNs > dueNs + periodNs) {
+      // Plus d'une période de retard: un périphérique aurait sous-alimenté.
+      // On recale l'horloge au lieu de rattraper en rafale.
+      status = RTAUDIO_OUTPUT_UNDERFLOW;
+      originNs += nowNs - dueNs;
+    } else if (nowNs < dueNs) {
+#ifdef __linux__
+      struct timespec due;
+      due.tv_sec = (time_t)(dueNs / 1000000000LL);
+      due.tv_nsec = (long)(dueNs % 1000000000LL);
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, nullptr) ==
+             EINTR) {
       }
-    } else {
-      // Pas de samples à traiter ou reverb désactivée, attendre un peu
-      std::this_thread::sleep_for(std::chrono::microseconds(100));
+#else
+      // Pas de clock_nanosleep (macOS): délai relatif jusqu'à l'échéance,
+      // recalculé après un réveil anticipé (signal)
+      while (nowNs < dueNs) {
+        struct timespec delay;
+        delay.tv_sec = (time_t)((dueNs - nowNs) / 1000000000LL);
+        delay.tv_nsec = (long)((dueNs - nowNs) % 1000000000LL);
+        nanosleep(&delay, nullptr);
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        nowNs = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+      }
+#endif
     }
-  }
 
-  std::cout << "\033[1;33m[REVERB THREAD] Thread de réverbération arrêté\033[0m"
-            << std::endl;
+    if (rtCallback(clockOutputBuffer.data(), nullptr, bufferSize,
+                   (double)framesRendered / sampleRate, status, this) != 0) {
+      break;
+    }
+    if (backend == AUDIO_BACKEND_FILE) {
+      fileWriter.push(outLeft, outRight, bufferSize);
+    }
+    framesRendered += bufferSize;
+  }
 }
 
 // Initialisation
 bool AudioSystem::initialize() {
+  if (backend != AUDIO_BACKEND_RTAUDIO) {
+    return initializeClockBackend();
+  }
+
   // Forcer l'utilisation de l'API ALSA sur Linux
 #ifdef __linux__
   std::cout << "Attempting to initialize RtAudio with ALSA API..." << std::endl;
@@ -750,7 +997,7 @@ bool AudioSystem::initialize() {
 
     // Vérifier si la fréquence configurée est supportée
     bool supportsConfigRate = false;
-    unsigned int configRate = SAMPLING_FREQUENCY;
+    unsigned int configRate = audio_format_device_rate();
     for (unsigned int rate : deviceInfo.sampleRates) {
       if (rate == configRate) {
         supportsConfigRate = true;
@@ -781,11 +1028,11 @@ bool AudioSystem::initialize() {
   }
   std::cout << "======================================\n" << std::endl;
 
-  // Use SAMPLING_FREQUENCY from config.h instead of hard-coding 96kHz
-  unsigned int configSampleRate = SAMPLING_FREQUENCY;
+  // Use the runtime sample rate (--sample-rate) instead of hard-coding 96kHz
+  unsigned int configSampleRate = audio_format_device_rate();
   if (sampleRate != configSampleRate) {
     std::cout << "🔧 CONFIGURATION: Changement de " << sampleRate << "Hz vers "
-              << configSampleRate << "Hz (défini dans config.h)" << std::endl;
+              << configSampleRate << "Hz (--sample-rate)" << std::endl;
     sampleRate = configSampleRate;
   }
 
@@ -814,34 +1061,27 @@ bool AudioSystem::initialize() {
       std::cout << "\n🔍 DIAGNOSTIC CRITIQUE:" << std::endl;
       std::cout << "   FRÉQUENCE - Demandé: " << configSampleRate
                 << "Hz, Négocié: " << actualSampleRate << "Hz" << std::endl;
-      std::cout << "   BUFFER SIZE - Demandé: " << AUDIO_BUFFER_SIZE
+      const unsigned int requestedBufferSize =
+          audio_format_device_buffer_size();
+      std::cout << "   BUFFER SIZE - Demandé: " << requestedBufferSize
                 << " frames, Négocié: " << bufferSize << " frames" << std::endl;
 
-      // Vérifier si le buffer size a été modifié par le hardware
-      if (bufferSize != AUDIO_BUFFER_SIZE) {
-        std::cerr << "\n🚨 PROBLÈME BUFFER SIZE DÉTECTÉ !" << std::endl;
-        std::cerr << "   Le BossDAC/Hardware a FORCÉ une taille différente !"
-                  << std::endl;
-        std::cerr << "   Config.h: " << AUDIO_BUFFER_SIZE << " frames"
-                  << std::endl;
-        std::cerr << "   Hardware: " << bufferSize << " frames" << std::endl;
-        std::cerr << "   Ratio: "
-                  << (float)bufferSize / (float)AUDIO_BUFFER_SIZE << "x"
-                  << std::endl;
-        std::cerr << "\n💡 CAUSE DU SON HACHÉ:" << std::endl;
-        std::cerr << "   - Synthèse produit des buffers de "
-                  << AUDIO_BUFFER_SIZE << " frames" << std::endl;
-        std::cerr << "   - Hardware demande des buffers de " << bufferSize
+      // Le callback découpe la période en sous-blocs alignés sur les buffers
+      // de synthèse: une période différente ne désynchronise pas les moteurs,
+      // elle change seulement la latence
+      if (bufferSize != requestedBufferSize) {
+        std::cerr << "\n⚠️  Le hardware a imposé " << bufferSize
+                  << " frames au lieu de " << requestedBufferSize
+                  << " (latence " << bufferSize * 1000.0 / sampleRate
+                  << "ms)" << std::endl;
+        std::cerr << "   Synthèse: " << g_audio_buffer_size
+                  << " frames, sous-blocs: " << audio_format_sub_block_size()
                   << " frames" << std::endl;
-        std::cerr << "   - Désynchronisation = glitches audio" << std::endl;
-        std::cerr << "\n🔧 SOLUTIONS:" << std::endl;
-        std::cerr << "   1. Changer AUDIO_BUFFER_SIZE à " << bufferSize
-                  << " dans config.h" << std::endl;
-        std::cerr << "   2. Ou forcer le hardware à accepter "
-                  << AUDIO_BUFFER_SIZE << " frames" << std::endl;
+        std::cerr << "   Autre période: --device-buffer=<N>" << std::endl;
       } else {
-        std::cout << "✅ BUFFER SIZE: Parfaitement aligné (" << bufferSize
-                  << " frames)" << std::endl;
+        std::cout << "✅ BUFFER SIZE: " << bufferSize << " frames (synthèse "
+                  << g_audio_buffer_size << ", sous-blocs "
+                  << audio_format_sub_block_size() << ")" << std::endl;
       }
 
       if (actualSampleRate != configSampleRate) {
@@ -863,8 +1103,8 @@ bool AudioSystem::initialize() {
         }
 
         std::cerr << "\n💡 SOLUTIONS POSSIBLES:" << std::endl;
-        std::cerr << "   1. Changer SAMPLING_FREQUENCY à " << actualSampleRate
-                  << " dans config.h" << std::endl;
+        std::cerr << "   1. Relancer avec --sample-rate=" << actualSampleRate
+                  << std::endl;
         std::cerr << "   2. Utiliser un périphérique supportant "
                   << configSampleRate << "Hz" << std::endl;
         std::cerr << "   3. Vérifier que votre récepteur audio supporte "
@@ -894,8 +1134,82 @@ bool AudioSystem::initialize() {
 
 // Démarrage du flux audio
 bool AudioSystem::start() {
-  if (!audio || !audio->isStreamOpen())
+  if (backend == AUDIO_BACKEND_RTAUDIO && (!audio || !audio->isStreamOpen()))
     return false;
+  if (backend != AUDIO_BACKEND_RTAUDIO && clockThreadRunning.load())
+    return true;
+
+  // Thread de réverbération: latence fixe du chemin wet couvrant un buffer
+  // hardware complet (en frames moteur) plus une marge d'un bloc pour le
+  // traitement
+  if (!reverbThreadRunning.load()) {
+    if (!reverbWakeup.isValid()) {
+      std::cerr << "Erreur création du réveil du thread réverbération"
+                << std::endl;
+      return false;
+    }
+
+    const unsigned int engineFrames =
+        (bufferSize + g_output_upsample - 1) / g_output_upsample;
+    reverbLatencyBlocks =
+        (int)((engineFrames + REVERB_BLOCK_FRAMES - 1) / REVERB_BLOCK_FRAMES) +
+        1;
+    if (reverbLatencyBlocks > REVERB_MAX_LATENCY_BLOCKS) {
+      // Période imposée par le périphérique au-delà de AUDIO_DEVICE_BUFFER_MAX:
+      // le wet manquerait son créneau à chaque période
+      std::cerr << "Buffer hardware de " << bufferSize
+                << " frames trop grand pour la réverbération (max "
+                << AUDIO_DEVICE_BUFFER_MAX << ")" << std::endl;
+      return false;
+    }
+
+    reverbThreadRunning.store(true);
+    convolutionReverb.start(); // Workers de la queue (si IR chargée)
+    try {
+      reverbThread = std::thread(&AudioSystem::reverbThreadFunction, this);
+      std::cout << "\033[1;33m[REVERB THREAD] Thread de réverbération lancé, "
+                   "latence wet "
+                << getReverbLatencyFrames() << " frames ("
+                << getReverbLatencyFrames() * 1000.0 / g_sampling_frequency
+                << "ms)\033[0m" << std::endl;
+    } catch (const std::exception &e) {
+      std::cerr << "Erreur création thread réverbération: " << e.what()
+                << std::endl;
+      reverbThreadRunning.store(false);
+      return false;
+    }
+  }
+
+  // Enregistrement de la sortie master (--record): un échec n'empêche pas de
+  // jouer
+  if (!recordFilePath.empty() && !recording) {
+    if (recorder.open(recordFilePath.c_str(), sampleRate,
+                      AUDIO_RECORDER_RING_SECONDS, AUDIO_RECORDER_DIRECT_IO) &&
+        recorder.start()) {
+      recording = true;
+    } else {
+      recorder.close();
+      std::cerr << "Enregistrement désactivé" << std::endl;
+    }
+  }
+
+  if (backend != AUDIO_BACKEND_RTAUDIO) {
+    if (backend == AUDIO_BACKEND_FILE && !fileWriter.start())
+      return false;
+
+    clockThreadRunning.store(true);
+    try {
+      clockThread = std::thread(&AudioSystem::clockThreadFunction, this);
+    } catch (const std::exception &e) {
+      std::cerr << "Erreur création thread horloge audio: " << e.what()
+                << std::endl;
+      clockThreadRunning.store(false);
+      return false;
+    }
+
+    isRunning = true;
+    return true;
+  }
 
   try {
     audio->startStream();
@@ -918,10 +1232,46 @@ void AudioSystem::stop() {
     }
     isRunning = false;
   }
+
+  if (clockThreadRunning.load()) {
+    clockThreadRunning.store(false);
+    if (clockThread.joinable()) {
+      clockThread.join();
+    }
+    isRunning = false;
+  }
+  // Finalise le WAV (no-op si aucun fichier ouvert)
+  fileWriter.close();
+  if (recording) {
+    recording = false; // Callback arrêté: plus aucun push
+    recorder.close();
+  }
+
+  if (reverbThreadRunning.load()) {
+    reverbThreadRunning.store(false);
+    reverbWakeup.post(); // Réveiller le thread s'il attend
+
+    if (reverbThread.joinable()) {
+      reverbThread.join();
+      std::cout << "\033[1;33m[REVERB THREAD] Thread de réverbération joint ("
+                << getReverbMissedBlocks() << " blocs wet manqués, "
+                << getReverbDroppedBlocks() << " blocs perdus)\033[0m"
+                << std::endl;
+    }
+
+    if (convolutionReverb.isLoaded()) {
+      convolutionReverb.stop();
+      convolutionReverb.printStats();
+    }
+  }
 }
 
 // Vérifier si le système est actif
-bool AudioSystem::isActive() const { return audio && audio->isStreamRunning(); }
+bool AudioSystem::isActive() const {
+  if (backend != AUDIO_BACKEND_RTAUDIO)
+    return clockThreadRunning.load();
+  return audio && audio->isStreamRunning();
+}
 
 // Mise à jour des données audio
 bool AudioSystem::setAudioData(const float *data, size_t size) {
@@ -1036,89 +1386,96 @@ bool AudioSystem::setBufferSize(unsigned int size) {
 unsigned int AudioSystem::getBufferSize() const { return bufferSize; }
 
 // Set master volume (0.0 - 1.0)
+// Les setters publient dans audio_params (bornés à 0.0 - 1.0), le callback et
+// le thread de réverbération les prennent au bloc suivant
 void AudioSystem::setMasterVolume(float volume) {
-  // Clamp volume entre 0.0 et 1.0
-  masterVolume = (volume < 0.0f) ? 0.0f : (volume > 1.0f) ? 1.0f : volume;
+  audio_params_set(AUDIO_PARAM_MASTER_VOLUME, volume);
 }
 
 // Get master volume
-float AudioSystem::getMasterVolume() const { return masterVolume; }
+float AudioSystem::getMasterVolume() const {
+  return audio_params_get(AUDIO_PARAM_MASTER_VOLUME);
+}
 
 // === Contrôles de réverbération ===
 
 // Activer/désactiver la réverbération
 void AudioSystem::enableReverb(bool enable) {
-  reverbEnabled = enable;
+  audio_params_set(AUDIO_PARAM_REVERB_ENABLED, enable ? 1.0f : 0.0f);
   std::cout << "\033[1;36mREVERB: " << (enable ? "ON" : "OFF") << "\033[0m"
             << std::endl;
 }
 
+bool AudioSystem::setReverbDecimation(int factor) {
+  if (factor != 1 && factor != 2 && factor != 4) {
+    return false;
+  }
+  reverbDecimation.store(factor, std::memory_order_relaxed);
+  std::cout << "\033[1;36mREVERB: ZitaRev1 à "
+            << g_sampling_frequency / factor << " Hz\033[0m" << std::endl;
+  return true;
+}
+
+int AudioSystem::getReverbDecimation() const {
+  return reverbDecimation.load(std::memory_order_relaxed);
+}
+
+bool AudioSystem::isConvolutionReverbActive() const {
+  return convolutionReverb.isLoaded();
+}
+
 // Vérifier si la réverbération est activée
-bool AudioSystem::isReverbEnabled() const { return reverbEnabled; }
+bool AudioSystem::isReverbEnabled() const {
+  return audio_params_get(AUDIO_PARAM_REVERB_ENABLED) > 0.5f;
+}
 
 // Régler le mix dry/wet (0.0 - 1.0)
 void AudioSystem::setReverbMix(float mix) {
-  if (mix < 0.0f)
-    reverbMix = 0.0f;
-  else if (mix > 1.0f)
-    reverbMix = 1.0f;
-  else
-    reverbMix = mix;
-
   // Plus de log ici pour éviter les doublons avec les logs colorés de
   // midi_controller.cpp
+  audio_params_set(AUDIO_PARAM_REVERB_MIX, mix);
 }
 
 // Obtenir le mix dry/wet actuel
-float AudioSystem::getReverbMix() const { return reverbMix; }
+float AudioSystem::getReverbMix() const {
+  return audio_params_get(AUDIO_PARAM_REVERB_MIX);
+}
 
 // Régler la taille de la pièce (0.0 - 1.0)
 void AudioSystem::setReverbRoomSize(float size) {
-  if (size < 0.0f)
-    reverbRoomSize = 0.0f;
-  else if (size > 1.0f)
-    reverbRoomSize = 1.0f;
-  else
-    reverbRoomSize = size;
-
   // Plus de log ici pour éviter les doublons avec les logs colorés de
   // midi_controller.cpp
+  audio_params_set(AUDIO_PARAM_REVERB_ROOM_SIZE, size);
 }
 
 // Obtenir la taille de la pièce actuelle
-float AudioSystem::getReverbRoomSize() const { return reverbRoomSize; }
+float AudioSystem::getReverbRoomSize() const {
+  return audio_params_get(AUDIO_PARAM_REVERB_ROOM_SIZE);
+}
 
 // Régler l'amortissement (0.0 - 1.0)
 void AudioSystem::setReverbDamping(float damping) {
-  if (damping < 0.0f)
-    reverbDamping = 0.0f;
-  else if (damping > 1.0f)
-    reverbDamping = 1.0f;
-  else
-    reverbDamping = damping;
-
   // Plus de log ici pour éviter les doublons avec les logs colorés de
   // midi_controller.cpp
+  audio_params_set(AUDIO_PARAM_REVERB_DAMPING, damping);
 }
 
 // Obtenir l'amortissement actuel
-float AudioSystem::getReverbDamping() const { return reverbDamping; }
+float AudioSystem::getReverbDamping() const {
+  return audio_params_get(AUDIO_PARAM_REVERB_DAMPING);
+}
 
 // Régler la largeur stéréo (0.0 - 1.0)
 void AudioSystem::setReverbWidth(float width) {
-  if (width < 0.0f)
-    reverbWidth = 0.0f;
-  else if (width > 1.0f)
-    reverbWidth = 1.0f;
-  else
-    reverbWidth = width;
-
   // Plus de log ici pour éviter les doublons avec les logs colorés de
   // midi_controller.cpp
+  audio_params_set(AUDIO_PARAM_REVERB_WIDTH, width);
 }
 
 // Obtenir la largeur stéréo actuelle
-float AudioSystem::getReverbWidth() const { return reverbWidth; }
+float AudioSystem::getReverbWidth() const {
+  return audio_params_get(AUDIO_PARAM_REVERB_WIDTH);
+}
 
 // Set requested device ID for initialization
 void AudioSystem::setRequestedDeviceId(int deviceId) {
@@ -1127,6 +1484,18 @@ void AudioSystem::setRequestedDeviceId(int deviceId) {
             << std::endl;
 }
 
+unsigned int AudioSystem::getReverbLatencyFrames() const {
+  return (unsigned int)reverbLatencyBlocks * REVERB_BLOCK_FRAMES;
+}
+
+unsigned long AudioSystem::getReverbMissedBlocks() const {
+  return reverbMissedBlocks.load(std::memory_order_relaxed);
+}
+
+unsigned long AudioSystem::getReverbDroppedBlocks() const {
+  return reverbDroppedBlocks.load(std::memory_order_relaxed);
+}
+
 // Fonctions C pour la compatibilité avec le code existant
 extern "C" {
 
@@ -1184,7 +1553,7 @@ void audio_Init(void) {
 
   // Initialiser l'égaliseur à 3 bandes
   if (!gEqualizer) {
-    float sampleRate = (gAudioSystem) ? SAMPLING_FREQUENCY : 44100.0f;
+    float sampleRate = (gAudioSystem) ? g_sampling_frequency : 44100.0f;
     eq_Init(sampleRate);
     std::cout
         << "\033[1;32m[ThreeBandEQ] Égaliseur à 3 bandes initialisé\033[0m"
@@ -1276,6 +1645,29 @@ void setRequestedAudioDevice(int deviceId) {
   }
 }
 
+void setRequestedAudioBackend(AudioBackendType backend, const char *filePath) {
+  // Lu par le constructeur d'AudioSystem (audio_Init)
+  g_requested_audio_backend = backend;
+  g_requested_audio_file = filePath;
+}
+
+void setRequestedReverbDecimation(int factor) {
+  g_requested_reverb_decimation = factor;
+  if (gAudioSystem) {
+    gAudioSystem->setReverbDecimation(factor);
+  }
+}
+
+void setRequestedReverbImpulseResponse(const char *path) {
+  // Lu par le constructeur d'AudioSystem (audio_Init)
+  g_requested_reverb_ir = path;
+}
+
+void setRequestedRecordFile(const char *path) {
+  // Lu par le constructeur d'AudioSystem (audio_Init)
+  g_requested_record_file = path;
+}
+
 // Control minimal callback mode for debugging audio dropouts
 void setMinimalCallbackMode(int enabled) {
   use_minimal_callback = (enabled != 0);
@@ -5,12 +5,20 @@
 
 #include "ZitaRev1.h"
 #include "audio_c_api.h"
+#include "audio_file_writer.h"
+#include "audio_format.h"
+#include "audio_params.h"
+#include "convolution_reverb.h"
 #include "config.h"
+#include "lookahead_limiter.h"
+#include "mix_graph.h"
+#include "polyphase_resampler.h"
 #include "three_band_eq.h"
+#include "wake_event.h"
 #include <atomic>
-#include <condition_variable>
 #include <mutex>
 #include <rtaudio/RtAudio.h>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -27,16 +35,51 @@ private:
   unsigned int channels;
   int requestedDeviceId; // Device ID specifically requested by user (-1 = auto)
 
+  // Backend de sortie. Les backends null et file n'ouvrent aucun périphérique:
+  // un thread horloge appelle rtCallback toutes les bufferSize / sampleRate
+  // secondes, avec le même chemin temps réel que RtAudio.
+  AudioBackendType backend;
+  std::string outputFilePath;
+  AudioFileWriter fileWriter;
+
+  // Enregistrement de la sortie master (--record), tous backends. recording
+  // n'est modifié que flux arrêté.
+  std::string recordFilePath;
+  AudioFileWriter recorder;
+  bool recording;
+  std::thread clockThread;
+  std::atomic<bool> clockThreadRunning;
+  std::vector<float> clockOutputBuffer; // Non entrelacé, comme RtAudio
+
+  bool initializeClockBackend();
+  void clockThreadFunction();
+
   // Callback static (pour faire le lien avec l'instance)
   static int rtCallback(void *outputBuffer, void *inputBuffer,
                         unsigned int nFrames, double streamTime,
                         RtAudioStreamStatus status, void *userData);
 
-  // Callback de l'instance
+  // Callback de l'instance (fréquence des moteurs)
   int handleCallback(float *outputBuffer, unsigned int nFrames);
 
-  // Volume control
-  float masterVolume;
+  // Sortie à g_output_upsample fois la fréquence des moteurs: handleCallback
+  // rend nFrames / facteur frames, suréchantillonnées ensuite
+  int renderUpsampled(float *outputBuffer, unsigned int nFrames);
+  PolyphaseUpsampler upsamplerL;
+  PolyphaseUpsampler upsamplerR;
+  float upsampleScratch[2 * AUDIO_BUFFER_SIZE_MAX]; // Sortie de handleCallback
+  // Phases d'une frame moteur pas encore jouées (période non multiple du
+  // facteur)
+  float upsamplePendingL[4];
+  float upsamplePendingR[4];
+  unsigned int upsamplePendingPos;
+  unsigned int upsamplePendingCount;
+
+  // Paramètres de contrôle (volume, niveaux, réverbération): publiés par les
+  // threads de contrôle dans audio_params, lus une fois par sous-bloc par le
+  // callback et une fois par bloc par le thread de réverbération
+  AudioParamReader callbackParams; // Thread audio uniquement
+  AudioParamReader reverbParams;   // Thread de réverbération uniquement
 
   // Paramètres de réverbération
   static const int REVERB_BUFFER_SIZE = 32768; // Pour compatibilité arrière
@@ -49,68 +92,160 @@ private:
   ZitaRev1
       zitaRev; // Instance de ZitaRev1 pour une réverbération de haute qualité
 
-  float reverbMix;      // Dry/Wet mix (0.0 - 1.0)
-  float reverbRoomSize; // Taille de la pièce (0.0 - 1.0)
-  float reverbDamping;  // Amortissement (0.0 - 1.0)
-  float reverbWidth;    // Largeur stéréo (0.0 - 1.0)
-  bool reverbEnabled;   // Activation/désactivation de la réverbération
-
   // === MULTI-THREADED REVERB SYSTEM ===
-  static const int REVERB_THREAD_BUFFER_SIZE =
-      8192; // Buffer circulaire pour thread reverb
-
-  // Buffer circulaire pour données d'entrée de la réverbération (thread-safe)
-  struct ReverbInputBuffer {
-    float data[REVERB_THREAD_BUFFER_SIZE];
-    std::atomic<int> write_pos;
-    std::atomic<int> read_pos;
-    std::atomic<int> available_samples;
-
-    ReverbInputBuffer() : write_pos(0), read_pos(0), available_samples(0) {
-      std::fill(data, data + REVERB_THREAD_BUFFER_SIZE, 0.0f);
+  // Le callback envoie le send par blocs fixes au thread de réverbération et
+  // relit le wet L blocs plus tard (latence fixe, voir reverbLatencyBlocks).
+  // Un bloc wet absent à l'heure est remplacé par du silence (dry seul) et
+  // compté, sans jamais attendre le thread.
+  static const int REVERB_BLOCK_FRAMES = 128; // Taille d'un bloc échangé
+  static const int REVERB_RING_BLOCKS = 128;  // Puissance de deux
+  // Latence maximale: un buffer hardware complet plus un bloc de marge, les
+  // deux derniers blocs du ring restant libres pour le flux
+  static const int REVERB_MAX_LATENCY_BLOCKS = REVERB_RING_BLOCKS - 2;
+  static_assert(AUDIO_DEVICE_BUFFER_MAX / REVERB_BLOCK_FRAMES + 2 <=
+                    REVERB_MAX_LATENCY_BLOCKS,
+                "Ring reverb trop court pour AUDIO_DEVICE_BUFFER_MAX");
+
+  struct ReverbSendBlock {
+    float data[REVERB_BLOCK_FRAMES];
+    long long seq; // Index du bloc dans le flux
+  };
+
+  struct ReverbWetBlock {
+    float left[REVERB_BLOCK_FRAMES];
+    float right[REVERB_BLOCK_FRAMES];
+    long long seq; // Index du bloc send d'origine
+  };
+
+  // Ring SPSC wait-free de blocs : le producteur remplit writeSlot() en place
+  // puis commitWrite(), le consommateur lit readSlot() puis releaseRead().
+  template <typename Block> struct ReverbBlockRing {
+    Block blocks[REVERB_RING_BLOCKS];
+    alignas(64) std::atomic<unsigned int> head; // Écrit par le producteur
+    alignas(64) std::atomic<unsigned int> tail; // Écrit par le consommateur
+
+    ReverbBlockRing() : head(0), tail(0) {}
+
+    Block *writeSlot() {
+      unsigned int h = head.load(std::memory_order_relaxed);
+      if (h - tail.load(std::memory_order_acquire) >= REVERB_RING_BLOCKS)
+        return nullptr; // Plein
+      return &blocks[h & (REVERB_RING_BLOCKS - 1)];
     }
-  } reverbInputBuffer;
-
-  // Buffer circulaire pour données de sortie de la réverbération (thread-safe)
-  struct ReverbOutputBuffer {
-    float left[REVERB_THREAD_BUFFER_SIZE];
-    float right[REVERB_THREAD_BUFFER_SIZE];
-    std::atomic<int> write_pos;
-    std::atomic<int> read_pos;
-    std::atomic<int> available_samples;
-
-    ReverbOutputBuffer() : write_pos(0), read_pos(0), available_samples(0) {
-      std::fill(left, left + REVERB_THREAD_BUFFER_SIZE, 0.0f);
-      std::fill(right, right + REVERB_THREAD_BUFFER_SIZE, 0.0f);
+    void commitWrite() {
+      head.store(head.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
     }
-  } reverbOutputBuffer;
+    Block *readSlot() {
+      unsigned int t = tail.load(std::memory_order_relaxed);
+      if (t == head.load(std::memory_order_acquire))
+        return nullptr; // Vide
+      return &blocks[t & (REVERB_RING_BLOCKS - 1)];
+    }
+    void releaseRead() {
+      tail.store(tail.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+    }
+  };
+
+  ReverbBlockRing<ReverbSendBlock> reverbSendRing; // Callback -> thread
+  ReverbBlockRing<ReverbWetBlock> reverbWetRing;   // Thread -> callback
 
   // Thread de traitement de la réverbération
   std::thread reverbThread;
   std::atomic<bool> reverbThreadRunning;
-  std::condition_variable reverbCondition;
-  std::mutex reverbMutex;
+  WakeEvent reverbWakeup; // Posté par le callback à chaque bloc envoyé
 
   // Fonction principale du thread de réverbération
   void reverbThreadFunction();
 
-  // Fonctions pour les buffers circulaires thread-safe
-  bool writeToReverbInput(float sample);
-  bool readFromReverbInput(float &sample);
-  bool writeToReverbOutput(float sampleL, float sampleR);
-  bool readFromReverbOutput(float &sampleL, float &sampleR);
+  // État du flux de blocs (thread audio uniquement)
+  int reverbLatencyBlocks;           // Latence fixe du chemin wet, en blocs
+  long long reverbBlockSeq;          // Index du bloc en cours (-1 = aucun)
+  unsigned int reverbBlockPos;       // Position dans le bloc en cours
+  ReverbSendBlock *reverbSendSlot;   // Bloc send en cours (nullptr si ring
+                                     // plein)
+  ReverbSendBlock reverbSendScratch; // Destination si le ring send est plein
+  const ReverbWetBlock *reverbWetSlot; // Bloc wet en cours (nullptr = miss)
+
+  // Statistiques (lues hors du thread audio)
+  std::atomic<unsigned long> reverbMissedBlocks;  // Wet en retard: dry seul
+  std::atomic<unsigned long> reverbDroppedBlocks; // Ring plein: bloc perdu
+
+  // Avance le flux de blocs d'un pas: envoie le bloc send terminé et prend le
+  // bloc wet suivant (callback uniquement)
+  void advanceReverbBlock();
 
   // Fonction de traitement de la réverbération (legacy)
   void processReverb(float inputL, float inputR, float &outputL,
                      float &outputR);
 
-  // Fonction de traitement de la réverbération optimisée pour callback
-  void processReverbOptimized(float inputL, float inputR, float &outputL,
-                              float &outputR);
+  // Traitement ZitaRev1 d'un bloc (thread de réverbération): un seul appel
+  // ZitaRev1::process, sortie 100% wet
+  void processReverbBlock(const float *input, float *outputL, float *outputR,
+                          unsigned int numFrames);
+
+  // Mix dry/wet (thread audio uniquement)
+  static const int REVERB_FADE_IN_FRAMES = 4800; // ~50ms à 96kHz
+  float reverbSendChunk[AUDIO_BUFFER_SIZE_MAX];
+  float reverbWetGain;       // Gain wet appliqué à la fin du dernier chunk
+  float reverbMixEnd;        // REVERB_MIX lissé à la fin du chunk en cours
+  int reverbFadeInFrames;    // Frames écoulées depuis le début du fade-in
+  float appliedRoomSize;     // Derniers paramètres transmis à ZitaRev1
+  float appliedDamping;      // (thread de réverbération uniquement)
+  float appliedWidth;
+
+  // Réverbération à fréquence réduite: le send est décimé, ZitaRev1 tourne à
+  // g_sampling_frequency / facteur et le wet est suréchantillonné. Filtres
+  // courts, la queue est de toute façon filtrée passe-bas.
+  static const int REVERB_RESAMPLER_TAPS = 16; // Coefficients par phase
+  std::atomic<int> reverbDecimation;           // Demandé: 1, 2 ou 4
+  int appliedReverbDecimation;                 // Thread de réverbération
+  PolyphaseDecimator reverbDecimator;
+  PolyphaseUpsampler reverbUpsamplerL;
+  PolyphaseUpsampler reverbUpsamplerR;
+  float reverbLowRateIn[REVERB_BLOCK_FRAMES];
+  float reverbLowRateL[REVERB_BLOCK_FRAMES];
+  float reverbLowRateR[REVERB_BLOCK_FRAMES];
+  void configureReverbRate(int factor);
+
+  // Graphe de mixage du callback (construit et compilé par le constructeur)
+  MixGraph mixGraph;
+  int mixSourceIfft;
+  int mixSourceFft;
+  int mixReturnReverb;
+
+  // Insert du retour réverbération: flux de blocs vers le thread de
+  // réverbération et mix dry/wet (callback uniquement)
+  void processReverbReturn(float *left, float *right, unsigned int nFrames);
+  struct ReverbReturnInsert : public MixProcessor {
+    AudioSystem *owner = nullptr;
+    void process(float *left, float *right, unsigned int nFrames) override {
+      owner->processReverbReturn(left, right, nFrames);
+    }
+  } reverbReturnInsert;
+
+  // Insert master: égaliseur trois bandes global, ignoré tant qu'il est plat
+  struct MasterEqualizerInsert : public MixProcessor {
+    bool isActive() const override {
+      return gEqualizer && gEqualizer->isActive();
+    }
+    void process(float *left, float *right, unsigned int nFrames) override {
+      float *eqChannels[2] = {left, right};
+      gEqualizer->process((int)nFrames, 2, eqChannels);
+    }
+  } masterEqualizerInsert;
+
+  // Dernier insert master: limiteur à anticipation (remplace l'écrêtage)
+  LookaheadLimiter masterLimiter;
+
+  // Réverbération à convolution (--reverb-ir): remplace ZitaRev1 sur le même
+  // chemin send/return quand une réponse impulsionnelle est chargée
+  ConvolutionReverb convolutionReverb;
 
 public:
-  AudioSystem(unsigned int sampleRate = SAMPLING_FREQUENCY,
-              unsigned int bufferSize = AUDIO_BUFFER_SIZE,
+  AudioSystem(unsigned int sampleRate = audio_format_device_rate(),
+              unsigned int bufferSize = audio_format_device_buffer_size(),
               unsigned int channels = AUDIO_CHANNEL);
   ~AudioSystem();
 
@@ -119,6 +254,7 @@ public:
   bool start();
   void stop();
   bool isActive() const;
+  AudioBackendType getBackend() const { return backend; }
 
   // Fonctions pour interagir avec le système audio
   bool setAudioData(const float *data, size_t size);
@@ -151,6 +287,28 @@ public:
   float getReverbDamping() const;
   void setReverbWidth(float width);
   float getReverbWidth() const;
+  // Qualité: 1 = pleine fréquence, 2 ou 4 = ZitaRev1 à fréquence réduite
+  // (moins de CPU, moins d'aigus dans la queue). Appliqué au bloc suivant
+  // par le thread de réverbération, la queue en cours est vidée.
+  bool setReverbDecimation(int factor);
+  int getReverbDecimation() const;
+  // Vrai si une réponse impulsionnelle a été chargée au démarrage: la
+  // convolution remplace ZitaRev1 (room size, damping, width et décimation
+  // sans effet)
+  bool isConvolutionReverbActive() const;
+
+  // Graphe de mixage: ajouter des inserts ou des retours puis compile(),
+  // uniquement quand le flux audio est arrêté
+  MixGraph &getMixGraph() { return mixGraph; }
+  // Latence ajoutée par le limiteur master, en frames moteur
+  unsigned int getLimiterLatencyFrames() const {
+    return masterLimiter.getLatencyFrames();
+  }
+
+  // Chemin wet threadé
+  unsigned int getReverbLatencyFrames() const;
+  unsigned long getReverbMissedBlocks() const;
+  unsigned long getReverbDroppedBlocks() const;
 };
 
 // Fonction globale pour la rétrocompatibilité minimale
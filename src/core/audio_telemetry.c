@@ -0,0 +1,267 @@
+/*
+ * audio_telemetry.c
+ */
+
+#include "audio_telemetry.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Loads are stored as integers in millionths of the period
+#define LOAD_SCALE 1e6
+
+typedef struct {
+  atomic_ulong count;
+  atomic_ulong over_period;
+  atomic_ullong load_sum;
+  atomic_ulong max_load;
+  atomic_ulong histogram[AUDIO_TELEMETRY_LOAD_BINS];
+} TimingCounters;
+
+static struct {
+  atomic_ulong device_underflows;
+  atomic_ulong device_overflows;
+  TimingCounters callback;
+  TimingCounters render[AUDIO_ENGINE_COUNT];
+  atomic_ulong starved[AUDIO_ENGINE_COUNT];
+  atomic_ulong ring_fill[AUDIO_ENGINE_COUNT][AUDIO_RING_FILL_BINS];
+  atomic_ulong limited_frames;
+  atomic_ulong limiter_reduction; // Max (1 - gain), in LOAD_SCALE units
+  atomic_ulong clipped_samples;
+  atomic_ulong recorder_dropped_blocks;
+  atomic_ulong recorder_dropped_frames;
+} g_telemetry;
+
+static const double g_load_bounds[AUDIO_TELEMETRY_LOAD_BINS - 1] =
+    AUDIO_TELEMETRY_LOAD_BOUNDS;
+
+// Single writer per counter: a relaxed load + store is enough and avoids a
+// locked read-modify-write on the real-time threads.
+static inline void bump(atomic_ulong *counter) {
+  atomic_store_explicit(
+      counter, atomic_load_explicit(counter, memory_order_relaxed) + 1,
+      memory_order_relaxed);
+}
+
+static void record_timing(TimingCounters *t, double elapsed_s,
+                          double period_s) {
+  if (period_s <= 0.0) {
+    return;
+  }
+  double load = elapsed_s / period_s;
+  unsigned long load_scaled = (unsigned long)(load * LOAD_SCALE);
+
+  int bin = 0;
+  while (bin < AUDIO_TELEMETRY_LOAD_BINS - 1 && load > g_load_bounds[bin]) {
+    bin++;
+  }
+
+  bump(&t->count);
+  bump(&t->histogram[bin]);
+  if (load > 1.0) {
+    bump(&t->over_period);
+  }
+  atomic_store_explicit(
+      &t->load_sum,
+      atomic_load_explicit(&t->load_sum, memory_order_relaxed) + load_scaled,
+      memory_order_relaxed);
+  if (load_scaled > atomic_load_explicit(&t->max_load, memory_order_relaxed)) {
+    atomic_store_explicit(&t->max_load, load_scaled, memory_order_relaxed);
+  }
+}
+
+void audio_telemetry_device_status(int underflow, int overflow) {
+  if (underflow) {
+    bump(&g_telemetry.device_underflows);
+  }
+  if (overflow) {
+    bump(&g_telemetry.device_overflows);
+  }
+}
+
+void audio_telemetry_callback(double elapsed_s, double period_s) {
+  record_timing(&g_telemetry.callback, elapsed_s, period_s);
+}
+
+void audio_telemetry_starved(AudioEngineId engine) {
+  bump(&g_telemetry.starved[engine]);
+}
+
+void audio_telemetry_ring_fill(AudioEngineId engine, int filled,
+                               int capacity) {
+  AudioRingFill fill = (filled <= 0)          ? AUDIO_RING_EMPTY
+                       : (filled >= capacity) ? AUDIO_RING_FULL
+                                              : AUDIO_RING_PARTIAL;
+  bump(&g_telemetry.ring_fill[engine][fill]);
+}
+
+void audio_telemetry_limiter(unsigned long limited_frames, float min_gain) {
+  atomic_store_explicit(
+      &g_telemetry.limited_frames,
+      atomic_load_explicit(&g_telemetry.limited_frames, memory_order_relaxed) +
+          limited_frames,
+      memory_order_relaxed);
+  unsigned long reduction = (unsigned long)((1.0 - min_gain) * LOAD_SCALE);
+  if (reduction > atomic_load_explicit(&g_telemetry.limiter_reduction,
+                                       memory_order_relaxed)) {
+    atomic_store_explicit(&g_telemetry.limiter_reduction, reduction,
+                          memory_order_relaxed);
+  }
+}
+
+void audio_telemetry_clipped(unsigned long samples) {
+  atomic_store_explicit(
+      &g_telemetry.clipped_samples,
+      atomic_load_explicit(&g_telemetry.clipped_samples, memory_order_relaxed) +
+          samples,
+      memory_order_relaxed);
+}
+
+void audio_telemetry_recorder_dropped(unsigned long frames) {
+  bump(&g_telemetry.recorder_dropped_blocks);
+  atomic_store_explicit(
+      &g_telemetry.recorder_dropped_frames,
+      atomic_load_explicit(&g_telemetry.recorder_dropped_frames,
+                           memory_order_relaxed) +
+          frames,
+      memory_order_relaxed);
+}
+
+void audio_telemetry_render(AudioEngineId engine, double elapsed_s,
+                            double period_s) {
+  record_timing(&g_telemetry.render[engine], elapsed_s, period_s);
+}
+
+double audio_telemetry_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void read_timing(TimingCounters *t, AudioTimingStats *out) {
+  out->count = atomic_load_explicit(&t->count, memory_order_relaxed);
+  out->over_period =
+      atomic_load_explicit(&t->over_period, memory_order_relaxed);
+  out->load_sum =
+      (double)atomic_load_explicit(&t->load_sum, memory_order_relaxed) /
+      LOAD_SCALE;
+  out->max_load =
+      (double)atomic_load_explicit(&t->max_load, memory_order_relaxed) /
+      LOAD_SCALE;
+  for (int i = 0; i < AUDIO_TELEMETRY_LOAD_BINS; i++) {
+    out->histogram[i] =
+        atomic_load_explicit(&t->histogram[i], memory_order_relaxed);
+  }
+}
+
+void audio_telemetry_read(AudioTelemetrySnapshot *out) {
+  out->time_s = audio_telemetry_now();
+  out->device_underflows = atomic_load_explicit(
+      &g_telemetry.device_underflows, memory_order_relaxed);
+  out->device_overflows = atomic_load_explicit(&g_telemetry.device_overflows,
+                                               memory_order_relaxed);
+  read_timing(&g_telemetry.callback, &out->callback);
+  for (int e = 0; e < AUDIO_ENGINE_COUNT; e++) {
+    read_timing(&g_telemetry.render[e], &out->render[e]);
+    out->starved[e] =
+        atomic_load_explicit(&g_telemetry.starved[e], memory_order_relaxed);
+    for (int f = 0; f < AUDIO_RING_FILL_BINS; f++) {
+      out->ring_fill[e][f] = atomic_load_explicit(&g_telemetry.ring_fill[e][f],
+                                                  memory_order_relaxed);
+    }
+  }
+  out->limited_frames =
+      atomic_load_explicit(&g_telemetry.limited_frames, memory_order_relaxed);
+  out->limiter_min_gain =
+      1.0 - (double)atomic_load_explicit(&g_telemetry.limiter_reduction,
+                                         memory_order_relaxed) /
+                LOAD_SCALE;
+  out->clipped_samples =
+      atomic_load_explicit(&g_telemetry.clipped_samples, memory_order_relaxed);
+  out->recorder_dropped_blocks = atomic_load_explicit(
+      &g_telemetry.recorder_dropped_blocks, memory_order_relaxed);
+  out->recorder_dropped_frames = atomic_load_explicit(
+      &g_telemetry.recorder_dropped_frames, memory_order_relaxed);
+}
+
+static void print_timing(const char *name, const AudioTimingStats *cur,
+                         const AudioTimingStats *prev) {
+  unsigned long count = cur->count - (prev ? prev->count : 0);
+  double load_sum = cur->load_sum - (prev ? prev->load_sum : 0.0);
+
+  printf("  %-12s n=%-7lu mean %5.1f%%  max %6.1f%%  over %lu  |", name, count,
+         count ? 100.0 * load_sum / (double)count : 0.0, 100.0 * cur->max_load,
+         cur->over_period - (prev ? prev->over_period : 0));
+  for (int i = 0; i < AUDIO_TELEMETRY_LOAD_BINS; i++) {
+    printf(" %lu", cur->histogram[i] - (prev ? prev->histogram[i] : 0));
+  }
+  printf("\n");
+}
+
+void audio_telemetry_print(const AudioTelemetrySnapshot *cur,
+                           const AudioTelemetrySnapshot *prev) {
+  static const char *engine_names[AUDIO_ENGINE_COUNT] = {"IFFT", "FFT"};
+  char name[32];
+
+  printf("[AUDIO STATS] %.1f s: device underflows %lu, overflows %lu\n",
+         prev ? cur->time_s - prev->time_s : 0.0,
+         cur->device_underflows - (prev ? prev->device_underflows : 0),
+         cur->device_overflows - (prev ? prev->device_overflows : 0));
+  printf("  load histogram bins: <25%% <50%% <75%% <90%% <100%% <150%% "
+         "<200%% >=200%% of the period, max since start\n");
+  print_timing("callback", &cur->callback, prev ? &prev->callback : NULL);
+  for (int e = 0; e < AUDIO_ENGINE_COUNT; e++) {
+    snprintf(name, sizeof(name), "render %s", engine_names[e]);
+    print_timing(name, &cur->render[e], prev ? &prev->render[e] : NULL);
+  }
+  for (int e = 0; e < AUDIO_ENGINE_COUNT; e++) {
+    printf("  %-4s starved %lu, ring empty/partial/full %lu/%lu/%lu\n",
+           engine_names[e], cur->starved[e] - (prev ? prev->starved[e] : 0),
+           cur->ring_fill[e][AUDIO_RING_EMPTY] -
+               (prev ? prev->ring_fill[e][AUDIO_RING_EMPTY] : 0),
+           cur->ring_fill[e][AUDIO_RING_PARTIAL] -
+               (prev ? prev->ring_fill[e][AUDIO_RING_PARTIAL] : 0),
+           cur->ring_fill[e][AUDIO_RING_FULL] -
+               (prev ? prev->ring_fill[e][AUDIO_RING_FULL] : 0));
+  }
+  printf("  limiter %lu frames limited (max %.1f dB since start), clipped "
+         "%lu samples\n",
+         cur->limited_frames - (prev ? prev->limited_frames : 0),
+         cur->limiter_min_gain > 0.0 ? 20.0 * log10(cur->limiter_min_gain)
+                                     : -INFINITY,
+         cur->clipped_samples - (prev ? prev->clipped_samples : 0));
+  if (cur->recorder_dropped_blocks) {
+    printf("  recorder dropped %lu blocks (%lu frames)\n",
+           cur->recorder_dropped_blocks -
+               (prev ? prev->recorder_dropped_blocks : 0),
+           cur->recorder_dropped_frames -
+               (prev ? prev->recorder_dropped_frames : 0));
+  }
+}
+
+void audio_telemetry_report_if_due(double interval_s) {
+  // Single caller (main loop)
+  static AudioTelemetrySnapshot last;
+  static int has_last = 0;
+
+  if (interval_s <= 0.0) {
+    return;
+  }
+
+  double now = audio_telemetry_now();
+  if (!has_last) {
+    audio_telemetry_read(&last);
+    has_last = 1;
+    return;
+  }
+  if (now - last.time_s < interval_s) {
+    return;
+  }
+
+  AudioTelemetrySnapshot cur;
+  audio_telemetry_read(&cur);
+  audio_telemetry_print(&cur, &last);
+  last = cur;
+}
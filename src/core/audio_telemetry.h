@@ -0,0 +1,88 @@
+/*
+ * audio_telemetry.h
+ *
+ * Lock-free counters and histograms for the audio path: device xruns,
+ * callback and synth render time against the buffer period, starved buffers
+ * and double-buffer fill level per engine, master limiter activity, output
+ * clipping and disk recorder drops. Every stat has a single writer
+ * thread, so recording is a couple of relaxed atomic stores (no lock, no
+ * read-modify-write). Readers take a snapshot at any time.
+ */
+
+#ifndef AUDIO_TELEMETRY_H
+#define AUDIO_TELEMETRY_H
+
+// Load histogram: time / buffer period. Upper bounds of the first bins, the
+// last bin collects everything above AUDIO_TELEMETRY_LOAD_BOUNDS' last value.
+#define AUDIO_TELEMETRY_LOAD_BINS 8
+#define AUDIO_TELEMETRY_LOAD_BOUNDS {0.25, 0.5, 0.75, 0.9, 1.0, 1.5, 2.0}
+
+typedef enum {
+  AUDIO_ENGINE_IFFT = 0, // synth_AudioProcess -> buffers_R
+  AUDIO_ENGINE_FFT,      // synth_fftMode_process -> fft_audio_buffers
+  AUDIO_ENGINE_COUNT
+} AudioEngineId;
+
+typedef enum {
+  AUDIO_RING_EMPTY = 0, // No buffer ready when the callback needs one
+  AUDIO_RING_PARTIAL,
+  AUDIO_RING_FULL, // Producer is ahead, waiting for the callback
+  AUDIO_RING_FILL_BINS
+} AudioRingFill;
+
+typedef struct {
+  unsigned long count;
+  unsigned long over_period; // Took longer than the buffer period
+  double load_sum;           // Sum of time / period (mean = load_sum / count)
+  double max_load;           // Peak time / period since start
+  unsigned long histogram[AUDIO_TELEMETRY_LOAD_BINS];
+} AudioTimingStats;
+
+typedef struct {
+  double time_s; // CLOCK_MONOTONIC time of the snapshot
+  unsigned long device_underflows;
+  unsigned long device_overflows;
+  AudioTimingStats callback;
+  AudioTimingStats render[AUDIO_ENGINE_COUNT];
+  unsigned long starved[AUDIO_ENGINE_COUNT]; // Buffers played without data
+  unsigned long ring_fill[AUDIO_ENGINE_COUNT][AUDIO_RING_FILL_BINS];
+  unsigned long limited_frames;  // Frames with master limiter gain < 1
+  double limiter_min_gain;       // Lowest limiter gain since start
+  unsigned long clipped_samples; // Samples still hard-clipped at the output
+  unsigned long recorder_dropped_blocks; // Callbacks that lost recorded frames
+  unsigned long recorder_dropped_frames; // Frames missing from the recording
+} AudioTelemetrySnapshot;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Writers (each stat must be recorded from a single thread)
+// Audio callback thread:
+void audio_telemetry_device_status(int underflow, int overflow);
+void audio_telemetry_callback(double elapsed_s, double period_s);
+void audio_telemetry_starved(AudioEngineId engine);
+void audio_telemetry_ring_fill(AudioEngineId engine, int filled, int capacity);
+void audio_telemetry_limiter(unsigned long limited_frames, float min_gain);
+void audio_telemetry_clipped(unsigned long samples);
+void audio_telemetry_recorder_dropped(unsigned long frames);
+// Engine render thread:
+void audio_telemetry_render(AudioEngineId engine, double elapsed_s,
+                            double period_s);
+
+// CLOCK_MONOTONIC time in seconds
+double audio_telemetry_now(void);
+
+// Readers (any thread)
+void audio_telemetry_read(AudioTelemetrySnapshot *out);
+// Prints the activity between two snapshots (prev may be NULL: since start)
+void audio_telemetry_print(const AudioTelemetrySnapshot *cur,
+                           const AudioTelemetrySnapshot *prev);
+// Prints a summary every interval_s seconds (0 disables), call periodically
+void audio_telemetry_report_if_due(double interval_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_TELEMETRY_H */
@@ -39,6 +39,32 @@
 #define DEFAULT_MULTI "192.168.0.1"
 #define DEFAULT_PORT PORT
 
+// Reception: datagrams taken per recvmmsg() call, socket receive buffer
+// (bounded by net.core.rmem_max on Linux), and receive timeout so the UDP
+// thread notices the end of the run
+#define UDP_RECV_BATCH (64)
+#define UDP_SOCKET_RCVBUF (8 * 1024 * 1024)
+#define UDP_RECV_TIMEOUT_MS (100)
+
+// Scanners chained on the same port (--scanner). On Linux each scanner
+// address gets its own receive socket and thread (SO_REUSEPORT).
+#define UDP_MAX_SOURCES (4)
+
+// Line reassembly: a line missing fragments stays open until this many newer
+// lines have started (newer complete lines wait for it, in line order), then
+// it is completed from the previous line if at most UDP_FILL_MAX_MISSING
+// fragments are missing (0: never), dropped otherwise
+#define UDP_REORDER_DEPTH_LINES (2)
+#define UDP_FILL_MAX_MISSING (2)
+
+// Image lines in the reception ring (doublebuffer.h): lines being assembled
+// (one batch ahead) + one pinned per consumer thread + the newest line
+#define IMAGE_LINE_SLOTS (16)
+// Threads that can pin a line of the same ring: IFFT audio thread, FFT synth,
+// main loop (DMX and display) and Qt window. The bank compose thread is the
+// only reader of the scanner rings it reads.
+#define IMAGE_LINE_READERS (4)
+
 /**************************************************************************************
  * DMX Definitions
  **************************************************************************************/
@@ -96,21 +122,43 @@
 /**************************************************************************************
  * DAC Definitions - Optimized for Raspberry Pi Module 5
  **************************************************************************************/
-#define SAMPLING_FREQUENCY (96000)
+// Sample rate and synth buffer size are runtime parameters (--sample-rate,
+// --buffer-size, see audio_format.h). The values below are the defaults.
+#define DEFAULT_SAMPLING_FREQUENCY (96000)
 #define AUDIO_CHANNEL (2)
 
 // Buffer size optimized for Pi Module 5 with real-time synthesis
 // Larger buffer reduces audio dropouts during intensive FFT processing
 // 48kHz: 150 frames = 3.125ms latency (optimal for real-time)
 // 96kHz: 600 frames = 6.25ms latency (double latency for synthesis headroom)
-#if SAMPLING_FREQUENCY >= 96000
-#define AUDIO_BUFFER_SIZE (600)
-#elif SAMPLING_FREQUENCY >= 48000
-#define AUDIO_BUFFER_SIZE (150)
+#if DEFAULT_SAMPLING_FREQUENCY >= 96000
+#define DEFAULT_AUDIO_BUFFER_SIZE (600)
+#elif DEFAULT_SAMPLING_FREQUENCY >= 48000
+#define DEFAULT_AUDIO_BUFFER_SIZE (150)
 #else
-#define AUDIO_BUFFER_SIZE (128)
+#define DEFAULT_AUDIO_BUFFER_SIZE (128)
 #endif
 
+// Accepted runtime range. Static audio buffers are sized for
+// AUDIO_BUFFER_SIZE_MAX frames.
+#define SAMPLING_FREQUENCY_MIN (22050)
+#define SAMPLING_FREQUENCY_MAX (192000)
+#define AUDIO_BUFFER_SIZE_MIN (32)
+#define AUDIO_BUFFER_SIZE_MAX (2048)
+
+// Device period (--device-buffer) and internal sub-block (--sub-block) are
+// independent of the synth buffer size: the audio callback walks the synth
+// buffers in sub-blocks whatever the period the device asks for. 0 (default)
+// uses the synth buffer size for both.
+#define AUDIO_DEVICE_BUFFER_MIN (16)
+#define AUDIO_DEVICE_BUFFER_MAX (8192)
+#define AUDIO_SUB_BLOCK_MIN (16)
+
+// Buffer sizes with a compile-time specialised synth loop (48kHz/150 and
+// 96kHz/600), other sizes use the generic loop
+#define AUDIO_FAST_PATH_SIZE_48K (150)
+#define AUDIO_FAST_PATH_SIZE_96K (600)
+
 /**************************************************************************************
  * Image Definitions
  **************************************************************************************/
@@ -148,8 +196,8 @@
 
 // Logging Parameters
 #define LOG_FREQUENCY                                                          \
-  (SAMPLING_FREQUENCY /                                                        \
-   AUDIO_BUFFER_SIZE) // Approximate logging frequency in Hz
+  (g_sampling_frequency /                                                      \
+   g_audio_buffer_size) // Approximate logging frequency in Hz (audio_format.h)
 
 /**************************************************************************************
  * Wave Generation Definitions
@@ -177,6 +225,27 @@
 #define DEFAULT_REVERB_DAMPING 0.4f   // Default damping (0.0 - 1.0)
 #define DEFAULT_REVERB_WIDTH 1.0f     // Default stereo width (0.0 - 1.0)
 
+// Core of the reverb worker. Core 0 takes the USB/network IRQs and the UDP
+// ingest, the IFFT synth workers use 1-3: REVERB_THREAD_CPU_AUTO takes the
+// first core after them, or the last core when there is none (4-core Pi).
+// A core number pins it there, -1 leaves it unpinned.
+#define REVERB_THREAD_CPU_AUTO (-2)
+#define REVERB_THREAD_CPU REVERB_THREAD_CPU_AUTO
+
+// Master lookahead limiter (last insert of the master bus)
+#define MASTER_LIMITER_CEILING 0.98f     // Peak ceiling (linear, ~-0.2 dBFS)
+#define MASTER_LIMITER_LOOKAHEAD_MS 1.5f // Lookahead, adds as much latency
+#define MASTER_LIMITER_RELEASE_MS 80.0f  // Gain recovery time constant
+
+// Control plane (audio_params): ramp applied by the real-time threads to
+// levels and volumes published by MIDI / GUI
+#define AUDIO_PARAM_RAMP_MS 20.0f
+
+// Disk recorder (--record): audio buffered between the callback and the disk
+// thread, and page-cache bypass (O_DIRECT / F_NOCACHE) when available
+#define AUDIO_RECORDER_RING_SECONDS 4.0f
+#define AUDIO_RECORDER_DIRECT_IO 1
+
 /**************************************************************************************
  * Display Definitions
  **************************************************************************************/
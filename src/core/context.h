@@ -5,6 +5,7 @@
 #include "config.h"
 #include "dmx.h"
 #include "doublebuffer.h"
+#include "scanner_map.h"
 
 #ifdef __LINUX__
 // Vérifier si SFML est désactivé
@@ -50,7 +51,9 @@ typedef struct {
   struct sockaddr_in *si_other;
   struct sockaddr_in *si_me;
   AudioData *audioData;
-  DoubleBuffer *doubleBuffer;
+  DoubleBuffer *doubleBuffer;    // Lines of the IFFT synth, DMX and display
+  DoubleBuffer *fftDoubleBuffer; // Lines of the FFT synth, NULL: doubleBuffer
+  ScannerMap *scannerMap;        // Several scanners (--scanner), else NULL
   DMXContext *dmxCtx;
   volatile int running; // Ajout du flag de terminaison pour Context
 #if ENABLE_IMAGE_TRANSFORM
@@ -58,4 +61,11 @@ typedef struct {
 #endif
 } Context;
 
+// Receive thread of the scanners steered to one socket (udpReceiverThread)
+typedef struct {
+  Context *ctx;
+  int socket;
+  int receiver; // Socket index from udp_InitReceivers()
+} UdpReceiver;
+
 #endif /* CONTEXT_H */
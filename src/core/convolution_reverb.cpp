@@ -0,0 +1,487 @@
+/*
+ * convolution_reverb.cpp
+ *
+ * Partitioned convolution reverb (see convolution_reverb.h).
+ */
+
+#include "convolution_reverb.h"
+#include "audio_telemetry.h"
+#include "denormals.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// --- WAV loading -----------------------------------------------------------
+
+static unsigned int readLE(const unsigned char *p, int bytes) {
+  unsigned int value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= (unsigned int)p[i] << (8 * i);
+  return value;
+}
+
+// Mono or stereo (first two channels) WAV, PCM 16/24/32 bits or float 32
+static bool readWav(const char *path, std::vector<float> out[2],
+                    int *channelsOut, unsigned int *rateOut) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    std::cerr << "Réponse impulsionnelle " << path << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  std::vector<unsigned char> data;
+  unsigned char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data.insert(data.end(), buffer, buffer + n);
+  fclose(file);
+
+  if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 ||
+      memcmp(&data[8], "WAVE", 4) != 0) {
+    std::cerr << "Réponse impulsionnelle " << path << ": pas un fichier WAV"
+              << std::endl;
+    return false;
+  }
+
+  unsigned int format = 0, channels = 0, rate = 0, blockAlign = 0, bits = 0;
+  const unsigned char *samples = nullptr;
+  size_t sampleBytes = 0;
+  size_t pos = 12;
+  while (pos + 8 <= data.size()) {
+    const unsigned char *chunk = &data[pos];
+    size_t size = readLE(chunk + 4, 4);
+    size_t body = pos + 8;
+    if (body + size > data.size())
+      size = data.size() - body; // Tronqué: garder ce qui est lisible
+    if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      format = readLE(&data[body], 2);
+      channels = readLE(&data[body + 2], 2);
+      rate = readLE(&data[body + 4], 4);
+      blockAlign = readLE(&data[body + 12], 2);
+      bits = readLE(&data[body + 14], 2);
+      if (format == 0xFFFE && size >= 26)
+        format = readLE(&data[body + 24], 2); // WAVE_FORMAT_EXTENSIBLE
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      samples = &data[body];
+      sampleBytes = size;
+    }
+    pos = body + size + (size & 1);
+  }
+
+  const bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+  const bool ieee = format == 3 && bits == 32;
+  if (!samples || channels == 0 || rate == 0 || (!pcm && !ieee) ||
+      blockAlign < channels * bits / 8) {
+    std::cerr << "Réponse impulsionnelle " << path
+              << ": format non supporté (PCM 16/24/32 bits ou float 32)"
+              << std::endl;
+    return false;
+  }
+
+  const int used = channels >= 2 ? 2 : 1;
+  const size_t frames = sampleBytes / blockAlign;
+  const int bytes = bits / 8;
+  for (int c = 0; c < used; c++) {
+    out[c].resize(frames);
+    for (size_t f = 0; f < frames; f++) {
+      const unsigned char *p = samples + f * blockAlign + c * bytes;
+      float v;
+      if (ieee) {
+        memcpy(&v, p, 4);
+      } else if (bits == 16) {
+        v = (int16_t)readLE(p, 2) / 32768.0f;
+      } else if (bits == 24) {
+        v = ((int32_t)(readLE(p, 3) << 8) >> 8) / 8388608.0f;
+      } else {
+        v = (int32_t)readLE(p, 4) / 2147483648.0f;
+      }
+      out[c][f] = v;
+    }
+  }
+
+  *channelsOut = used;
+  *rateOut = rate;
+  return true;
+}
+
+// --- ConvolutionReverb -----------------------------------------------------
+
+ConvolutionReverb::ConvolutionReverb()
+    : levelCount(0), channels(1), blockFrames(0), sampleRate(0),
+      running(false) {
+  for (int i = 0; i < MAX_LEVELS; i++) {
+    levels[i].forward = nullptr;
+    levels[i].inverse = nullptr;
+  }
+}
+
+ConvolutionReverb::~ConvolutionReverb() {
+  stop();
+  releaseLevels();
+}
+
+void ConvolutionReverb::releaseLevels() {
+  for (int i = 0; i < MAX_LEVELS; i++) {
+    if (levels[i].forward)
+      kiss_fftr_free(levels[i].forward);
+    if (levels[i].inverse)
+      kiss_fftr_free(levels[i].inverse);
+    levels[i].forward = levels[i].inverse = nullptr;
+  }
+  levelCount = 0;
+}
+
+bool ConvolutionReverb::load(const char *path, unsigned int sampleRate,
+                             unsigned int blockFrames) {
+  if (running.load() || !path || blockFrames == 0)
+    return false;
+  // Sans réveil, les workers de la queue tourneraient à vide: ZitaRev1
+  for (int i = 1; i < MAX_LEVELS; i++) {
+    if (!levels[i].wakeup.isValid()) {
+      std::cerr << "[CONV] Réveil des workers indisponible" << std::endl;
+      return false;
+    }
+  }
+
+  std::vector<float> ir[2];
+  int irChannels = 1;
+  unsigned int irRate = 0;
+  if (!readWav(path, ir, &irChannels, &irRate))
+    return false;
+
+  // Même fréquence que les moteurs: interpolation linéaire si besoin
+  if (irRate != sampleRate) {
+    std::cout << "[CONV] Réponse à " << irRate << "Hz rééchantillonnée à "
+              << sampleRate << "Hz" << std::endl;
+    const double step = (double)irRate / sampleRate;
+    const size_t length = (size_t)(ir[0].size() / step);
+    for (int c = 0; c < irChannels; c++) {
+      std::vector<float> resampled(length);
+      for (size_t i = 0; i < length; i++) {
+        double x = i * step;
+        size_t i0 = (size_t)x;
+        float frac = (float)(x - i0);
+        float a = ir[c][i0];
+        float b = (i0 + 1 < ir[c].size()) ? ir[c][i0 + 1] : 0.0f;
+        resampled[i] = a + frac * (b - a);
+      }
+      ir[c].swap(resampled);
+    }
+  }
+
+  size_t length = ir[0].size();
+  const size_t maxLength = (size_t)(MAX_IR_SECONDS * sampleRate);
+  if (length > maxLength) {
+    std::cout << "[CONV] Réponse tronquée à " << MAX_IR_SECONDS << "s"
+              << std::endl;
+    length = maxLength;
+  }
+  if (length == 0) {
+    std::cerr << "Réponse impulsionnelle " << path << " vide" << std::endl;
+    return false;
+  }
+
+  // Énergie unité sur le canal le plus fort: un send de bruit blanc ressort
+  // au même niveau RMS que l'entrée
+  double energy = 0.0;
+  for (int c = 0; c < irChannels; c++) {
+    ir[c].resize(length);
+    double e = 0.0;
+    for (float v : ir[c])
+      e += (double)v * v;
+    energy = std::max(energy, e);
+  }
+  if (energy > 0.0) {
+    const float scale = (float)(1.0 / sqrt(energy));
+    for (int c = 0; c < irChannels; c++)
+      for (float &v : ir[c])
+        v *= scale;
+  }
+
+  releaseLevels();
+  this->channels = irChannels;
+  this->blockFrames = blockFrames;
+  this->sampleRate = sampleRate;
+
+  // Niveau 0 de 0 à 2 * taille du niveau 1, niveau i de 2 * taille(i) à
+  // 2 * taille(i + 1), le dernier jusqu'à la fin de la réponse
+  unsigned int offset = 0;
+  unsigned int size = blockFrames;
+  for (int i = 0; i < MAX_LEVELS && offset < length; i++) {
+    size_t end = length;
+    if (i + 1 < MAX_LEVELS) {
+      size_t nextOffset = (size_t)2 * size * LEVEL_RATIO;
+      if (nextOffset < end)
+        end = nextOffset;
+    }
+    unsigned int partitions = (unsigned int)((end - offset + size - 1) / size);
+    buildLevel(levels[i], size, offset, partitions, ir, irChannels);
+    levelCount = i + 1;
+    offset = (unsigned int)end;
+    size *= LEVEL_RATIO;
+  }
+
+  std::cout << "[CONV] " << path << ": " << length << " frames ("
+            << (double)length / sampleRate << "s), "
+            << (irChannels == 2 ? "stéréo" : "mono") << ", " << levelCount
+            << " niveaux:";
+  for (int i = 0; i < levelCount; i++)
+    std::cout << " " << levels[i].partitions << "x" << levels[i].size;
+  std::cout << std::endl;
+  return true;
+}
+
+void ConvolutionReverb::buildLevel(Level &level, unsigned int size,
+                                   unsigned int offset,
+                                   unsigned int partitions,
+                                   const std::vector<float> *ir,
+                                   int irChannels) {
+  const unsigned int fftSize = 2 * size;
+  const unsigned int bins = size + 1;
+  level.size = size;
+  level.offset = offset;
+  level.partitions = partitions;
+  level.forward = kiss_fftr_alloc((int)fftSize, 0, nullptr, nullptr);
+  level.inverse = kiss_fftr_alloc((int)fftSize, 1, nullptr, nullptr);
+
+  // Spectres des partitions, normalisation de la FFT inverse incluse
+  std::vector<float> padded(fftSize);
+  const float scale = 1.0f / fftSize;
+  for (int c = 0; c < 2; c++) {
+    level.response[c].clear();
+    if (c >= irChannels)
+      continue;
+    level.response[c].resize((size_t)partitions * bins);
+    for (unsigned int k = 0; k < partitions; k++) {
+      std::fill(padded.begin(), padded.end(), 0.0f);
+      size_t start = offset + (size_t)k * size;
+      for (unsigned int j = 0; j < size && start + j < ir[c].size(); j++)
+        padded[j] = ir[c][start + j] * scale;
+      kiss_fftr(level.forward, padded.data(), &level.response[c][k * bins]);
+    }
+  }
+
+  level.fdl.assign((size_t)partitions * bins, kiss_fft_cpx{0.0f, 0.0f});
+  level.fdlPos = 0;
+  level.window.assign(fftSize, 0.0f);
+  level.accum.assign(bins, kiss_fft_cpx{0.0f, 0.0f});
+  level.timeOut.assign(fftSize, 0.0f);
+
+  for (int s = 0; s < SLOTS; s++) {
+    level.slots[s].input.assign(size, 0.0f);
+    level.slots[s].outputL.assign(size, 0.0f);
+    level.slots[s].outputR.assign(size, 0.0f);
+    level.slots[s].inputSeq.store(-1);
+    level.slots[s].outputSeq.store(-1);
+  }
+  level.filling.assign(size, 0.0f);
+  level.fillPos = 0;
+  level.fillSeq = 0;
+  level.readSeq = -1;
+  level.readMissed = false;
+  level.postedSeq.store(-1);
+  level.processedSeq.store(-1);
+  level.segments.store(0);
+  level.late.store(0);
+  level.busyNs.store(0);
+  level.maxNs.store(0);
+}
+
+bool ConvolutionReverb::start() {
+  if (!isLoaded() || running.load())
+    return false;
+
+  running.store(true);
+  for (int i = 1; i < levelCount; i++) {
+    try {
+      levels[i].worker = std::thread(&ConvolutionReverb::workerFunction, this,
+                                     i);
+    } catch (const std::exception &e) {
+      std::cerr << "Erreur création worker de convolution: " << e.what()
+                << std::endl;
+      stop();
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConvolutionReverb::stop() {
+  if (!running.load())
+    return;
+  running.store(false);
+  for (int i = 1; i < levelCount; i++) {
+    levels[i].wakeup.post();
+    if (levels[i].worker.joinable())
+      levels[i].worker.join();
+  }
+}
+
+void ConvolutionReverb::convolveSegment(Level &level, const float *segment,
+                                        float *outL, float *outR) {
+  const unsigned int size = level.size;
+  const unsigned int bins = size + 1;
+  const unsigned int partitions = level.partitions;
+
+  // Overlap-save: segment précédent + segment courant
+  float *window = level.window.data();
+  std::memmove(window, window + size, size * sizeof(float));
+  std::memcpy(window + size, segment, size * sizeof(float));
+
+  level.fdlPos = (level.fdlPos == 0) ? partitions - 1 : level.fdlPos - 1;
+  kiss_fftr(level.forward, window, &level.fdl[(size_t)level.fdlPos * bins]);
+
+  float *outputs[2] = {outL, outR};
+  for (int c = 0; c < channels; c++) {
+    kiss_fft_cpx *__restrict acc = level.accum.data();
+    std::memset(acc, 0, bins * sizeof(kiss_fft_cpx));
+
+    // Partition k avec le spectre du segment k fois plus ancien
+    unsigned int slot = level.fdlPos;
+    for (unsigned int k = 0; k < partitions; k++) {
+      const kiss_fft_cpx *__restrict x = &level.fdl[(size_t)slot * bins];
+      const kiss_fft_cpx *__restrict h = &level.response[c][(size_t)k * bins];
+      for (unsigned int b = 0; b < bins; b++) {
+        acc[b].r += x[b].r * h[b].r - x[b].i * h[b].i;
+        acc[b].i += x[b].r * h[b].i + x[b].i * h[b].r;
+      }
+      if (++slot == partitions)
+        slot = 0;
+    }
+
+    kiss_fftri(level.inverse, acc, level.timeOut.data());
+    std::memcpy(outputs[c], level.timeOut.data() + size, size * sizeof(float));
+  }
+
+  if (channels == 1)
+    std::memcpy(outR, outL, size * sizeof(float));
+}
+
+void ConvolutionReverb::recordLoad(Level &level, unsigned long long ns) {
+  level.segments.store(level.segments.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+  level.busyNs.store(level.busyNs.load(std::memory_order_relaxed) + ns,
+                     std::memory_order_relaxed);
+  if (ns > level.maxNs.load(std::memory_order_relaxed))
+    level.maxNs.store(ns, std::memory_order_relaxed);
+}
+
+void ConvolutionReverb::process(const float *input, float *outputL,
+                                float *outputR) {
+  // Tête de la réponse dans l'appel: pas de latence ajoutée
+  double start = audio_telemetry_now();
+  convolveSegment(levels[0], input, outputL, outputR);
+  recordLoad(levels[0],
+             (unsigned long long)((audio_telemetry_now() - start) * 1e9));
+
+  for (int i = 1; i < levelCount; i++) {
+    Level &level = levels[i];
+    const unsigned int pos = level.fillPos;
+
+    // Sortie: la fenêtre t joue le segment t - 2 calculé par le worker
+    if (pos == 0) {
+      level.readSeq = level.fillSeq - 2;
+      level.readMissed = false;
+    }
+    // Segment absent au début de la fenêtre: silence jusqu'à la fin de la
+    // fenêtre, même s'il arrive entre-temps (pas de lecture en plein milieu)
+    if (level.readSeq >= 0) {
+      Slot &slot = level.slots[level.readSeq & (SLOTS - 1)];
+      if (!level.readMissed &&
+          slot.outputSeq.load(std::memory_order_acquire) == level.readSeq) {
+        const float *tailL = slot.outputL.data() + pos;
+        const float *tailR = slot.outputR.data() + pos;
+        for (unsigned int j = 0; j < blockFrames; j++) {
+          outputL[j] += tailL[j];
+          outputR[j] += tailR[j];
+        }
+      } else if (!level.readMissed) {
+        level.readMissed = true;
+        level.late.store(level.late.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+      }
+    }
+
+    // Entrée: segment complet confié au worker
+    std::memcpy(level.filling.data() + pos, input,
+                blockFrames * sizeof(float));
+    level.fillPos += blockFrames;
+    if (level.fillPos < level.size)
+      continue;
+
+    const long long seq = level.fillSeq;
+    Slot &slot = level.slots[seq & (SLOTS - 1)];
+    // Emplacement libre si le worker a fini son segment précédent; sinon le
+    // worker convoluera du silence pour ce segment
+    if (level.processedSeq.load(std::memory_order_acquire) >= seq - SLOTS) {
+      std::memcpy(slot.input.data(), level.filling.data(),
+                  level.size * sizeof(float));
+      slot.inputSeq.store(seq, std::memory_order_release);
+    }
+    level.postedSeq.store(seq, std::memory_order_release);
+    level.wakeup.post();
+    level.fillSeq++;
+    level.fillPos = 0;
+  }
+}
+
+void ConvolutionReverb::workerFunction(int levelIndex) {
+  Level &level = levels[levelIndex];
+  enable_flush_to_zero();
+  std::vector<float> silence(level.size, 0.0f);
+
+  while (running.load(std::memory_order_acquire)) {
+    if (!level.wakeup.wait()) {
+      // Les segments suivants seront joués en silence et comptés
+      std::cerr << "[CONV] Worker niveau " << levelIndex
+                << ": attente impossible, arrêt" << std::endl;
+      break;
+    }
+
+    const long long posted = level.postedSeq.load(std::memory_order_acquire);
+    long long seq = level.processedSeq.load(std::memory_order_relaxed) + 1;
+    for (; seq <= posted && running.load(std::memory_order_relaxed); seq++) {
+      Slot &slot = level.slots[seq & (SLOTS - 1)];
+      const float *input =
+          (slot.inputSeq.load(std::memory_order_acquire) == seq)
+              ? slot.input.data()
+              : silence.data();
+
+      double start = audio_telemetry_now();
+      convolveSegment(level, input, slot.outputL.data(), slot.outputR.data());
+      recordLoad(level,
+                 (unsigned long long)((audio_telemetry_now() - start) * 1e9));
+
+      slot.outputSeq.store(seq, std::memory_order_release);
+      level.processedSeq.store(seq, std::memory_order_release);
+    }
+  }
+}
+
+void ConvolutionReverb::getLevelStats(int index, LevelStats *out) const {
+  const Level &level = levels[index];
+  const double periodNs = (double)level.size * 1e9 / sampleRate;
+  const unsigned long segments = level.segments.load();
+  out->partitionFrames = level.size;
+  out->partitions = level.partitions;
+  out->segments = segments;
+  out->late = level.late.load();
+  out->meanLoad =
+      segments ? (double)level.busyNs.load() / segments / periodNs : 0.0;
+  out->maxLoad = (double)level.maxNs.load() / periodNs;
+}
+
+void ConvolutionReverb::printStats() const {
+  for (int i = 0; i < levelCount; i++) {
+    LevelStats stats;
+    getLevelStats(i, &stats);
+    printf("[CONV] niveau %d (%s): %u x %u frames, %lu segments, %lu en "
+           "retard, charge moy %.1f%% max %.1f%%\n",
+           i, i == 0 ? "bloc" : "worker", stats.partitions,
+           stats.partitionFrames, stats.segments, stats.late,
+           stats.meanLoad * 100.0, stats.maxLoad * 100.0);
+  }
+}
@@ -0,0 +1,125 @@
+/*
+ * convolution_reverb.h
+ *
+ * Convolution reverb with a measured impulse response (WAV), alternative to
+ * ZitaRev1 on the same send/return path: one mono send block in, a 100% wet
+ * stereo block out, called by the reverb thread.
+ *
+ * Non-uniform partitioning in levels of uniform partitions (overlap-save,
+ * frequency-domain delay line):
+ * - level 0: block-sized partitions for the head of the response, computed
+ *   in the block call itself (no added latency);
+ * - levels 1..: partitions 8x larger each, starting at twice their size in
+ *   the response. Each level runs on its own background worker, which has
+ *   one full partition period to deliver a segment before it is played.
+ * A segment not ready in time is replaced by silence and counted.
+ */
+
+#ifndef CONVOLUTION_REVERB_H
+#define CONVOLUTION_REVERB_H
+
+#include "kissfft/kiss_fftr.h"
+#include "wake_event.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class ConvolutionReverb {
+public:
+  static const int MAX_LEVELS = 3;
+  static const int LEVEL_RATIO = 8;            // Partition size ratio
+  static constexpr float MAX_IR_SECONDS = 10.0f;
+
+  struct LevelStats {
+    unsigned int partitionFrames;
+    unsigned int partitions;
+    unsigned long segments;    // Segments computed
+    unsigned long late;        // Segments played as silence (worker late)
+    double meanLoad;           // Compute time / partition period
+    double maxLoad;
+  };
+
+  ConvolutionReverb();
+  ~ConvolutionReverb();
+
+  // Loads a mono or stereo WAV (PCM 16/24/32 bits or float 32) and builds
+  // the partitions for blocks of blockFrames at sampleRate. A response at
+  // another rate is resampled (linear). Startup only: allocates.
+  bool load(const char *path, unsigned int sampleRate,
+            unsigned int blockFrames);
+  bool isLoaded() const { return levelCount > 0; }
+
+  // Background workers of the tail levels
+  bool start();
+  void stop();
+
+  // Reverb thread: one blockFrames send block in, wet stereo out
+  void process(const float *input, float *outputL, float *outputR);
+
+  int getLevelCount() const { return levelCount; }
+  void getLevelStats(int level, LevelStats *out) const;
+  void printStats() const;
+
+private:
+  static const int SLOTS = 4; // Segments in flight per tail level
+
+  struct Slot {
+    std::vector<float> input;
+    std::vector<float> outputL;
+    std::vector<float> outputR;
+    std::atomic<long long> inputSeq;  // Segment held in input (reverb thread)
+    std::atomic<long long> outputSeq; // Segment held in output (worker)
+  };
+
+  struct Level {
+    unsigned int size;       // Partition and segment size (frames)
+    unsigned int offset;     // Start of the first partition in the response
+    unsigned int partitions;
+    kiss_fftr_cfg forward;
+    kiss_fftr_cfg inverse;
+    std::vector<kiss_fft_cpx> response[2]; // partitions * (size + 1) bins
+    std::vector<kiss_fft_cpx> fdl;         // Input spectra, newest at fdlPos
+    unsigned int fdlPos;
+    std::vector<float> window;             // Previous + current segment
+    std::vector<kiss_fft_cpx> accum;
+    std::vector<float> timeOut;
+
+    // Tail levels: segment exchange with the worker
+    Slot slots[SLOTS];
+    std::vector<float> filling;   // Reverb thread: segment being filled
+    unsigned int fillPos;
+    long long fillSeq;            // Index of the segment being filled
+    long long readSeq;            // Output segment being played (-1: none)
+    bool readMissed;
+    std::atomic<long long> postedSeq;    // Last segment handed over
+    std::atomic<long long> processedSeq; // Last segment computed
+    std::thread worker;
+    WakeEvent wakeup;
+
+    // Stats (single writer)
+    std::atomic<unsigned long> segments;
+    std::atomic<unsigned long> late;
+    std::atomic<unsigned long long> busyNs;
+    std::atomic<unsigned long long> maxNs;
+  };
+
+  void buildLevel(Level &level, unsigned int size, unsigned int offset,
+                  unsigned int partitions, const std::vector<float> *ir,
+                  int channels);
+  void releaseLevels();
+  // One overlap-save step: segment (level.size frames) in, level.size wet
+  // frames per channel out
+  void convolveSegment(Level &level, const float *segment, float *outL,
+                       float *outR);
+  void recordLoad(Level &level, unsigned long long ns);
+  void workerFunction(int levelIndex);
+
+  Level levels[MAX_LEVELS];
+  int levelCount;
+  int channels; // Of the response: 1 (both outputs) or 2
+  unsigned int blockFrames;
+  unsigned int sampleRate;
+  std::atomic<bool> running;
+};
+
+#endif // CONVOLUTION_REVERB_H
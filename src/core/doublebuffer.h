@@ -6,39 +6,81 @@
 #include <stdint.h>
 #include <time.h>
 
+/*
+ * Single-writer / multi-reader publication of image lines.
+ *
+ * Lines live in a ring of IMAGE_LINE_SLOTS preallocated planar slots. The UDP
+ * thread reserves a free slot per line being assembled, receives the
+ * fragments directly into it, then publishes the slot by index: no copy on
+ * publication. Readers pin the newest slot (reference count) and read it in
+ * place until they move to a newer line; the writer never reuses the newest
+ * slot nor a pinned one, so a line is written once and only read afterwards.
+ * Publishing wakes every waiting consumer at once.
+ */
+#if IMAGE_LINE_SLOTS > 32
+#error "IMAGE_LINE_SLOTS must fit in the 5-bit slot field of 'latest'."
+#endif
+
+typedef struct {
+  uint8_t *R; // CIS_MAX_PIXELS_NB bytes each, one allocation
+  uint8_t *G;
+  uint8_t *B;
+  uint32_t readers;  // Pins held by readers (__atomic builtins only)
+  int writer_owned;  // Reserved by the UDP thread (writer only)
+} ImageSlot;
+
 typedef struct DoubleBuffer {
-  uint8_t *activeBuffer_R;
-  uint8_t *activeBuffer_G;
-  uint8_t *activeBuffer_B;
-  uint8_t *processingBuffer_R;
-  uint8_t *processingBuffer_G;
-  uint8_t *processingBuffer_B;
-
-  // Persistent image buffer for audio continuity
-  uint8_t *lastValidImage_R;
-  uint8_t *lastValidImage_G;
-  uint8_t *lastValidImage_B;
-  uint8_t lastValidImageExists; // Flag to indicate if we have a valid image
-
-  uint8_t dataReady;
+  ImageSlot slots[IMAGE_LINE_SLOTS];
+  uint8_t *slot_memory;
+
+  // Newest published line: (version << 5) | slot, 0 before the first line.
+  // Accessed with __atomic builtins only.
+  uint32_t latest;
+
+  // Used only to sleep/wake consumers, never held while reading
   pthread_mutex_t mutex;
   pthread_cond_t cond;
 
   // Statistics for monitoring
-  uint64_t udp_frames_received;
-  uint64_t audio_frames_processed;
-  time_t last_udp_frame_time;
+  uint64_t udp_frames_received;    // Writer only
+  uint64_t audio_frames_processed; // Atomic increment
+  time_t last_udp_frame_time;      // Writer only
 } DoubleBuffer;
 
+// Line pinned by a reader. Black line (version 0) until the first line is
+// published.
+typedef struct {
+  const uint8_t *R;
+  const uint8_t *G;
+  const uint8_t *B;
+  uint32_t version;
+  int slot; // -1: nothing pinned
+} ImageLineRef;
+
 // Function prototypes
 void initDoubleBuffer(DoubleBuffer *db);
 void cleanupDoubleBuffer(DoubleBuffer *db);
-void swapBuffers(DoubleBuffer *db); // swapBuffers is also in multithreading.c
 
-// New functions for persistent image management
-void updateLastValidImage(DoubleBuffer *db);
-void getLastValidImageForAudio(DoubleBuffer *db, uint8_t *out_R, uint8_t *out_G,
-                               uint8_t *out_B);
+// Writer side (UDP thread only). reserveImageSlot returns a slot that no
+// reader can see (-1 if all are in use), publishImageSlot makes it the newest
+// line and wakes all readers, releaseImageSlot returns an abandoned line.
+int reserveImageSlot(DoubleBuffer *db);
+void releaseImageSlot(DoubleBuffer *db, int slot);
+void publishImageSlot(DoubleBuffer *db, int slot);
+
+// Reader side. Versions start at 1 for the first published line, 0 means
+// nothing has been published yet.
+uint32_t getImageVersion(DoubleBuffer *db);
+uint32_t waitForNewImage(DoubleBuffer *db, uint32_t last_version,
+                         int timeout_ms);
+void initImageLineRef(ImageLineRef *ref);
+// Moves ref to the newest line (unpins the previous one), returns its version
+uint32_t acquireImageLine(DoubleBuffer *db, ImageLineRef *ref);
+// Unpins the line held by ref (back to the black line)
+void releaseImageLine(DoubleBuffer *db, ImageLineRef *ref);
+
+// Persistent image access for audio continuity (lock-free)
+uint32_t getLastValidImageForAudio(DoubleBuffer *db, ImageLineRef *ref);
 int hasValidImageForAudio(DoubleBuffer *db);
 
 #endif /* DOUBLEBUFFER_H */
@@ -0,0 +1,142 @@
+/*
+ * lookahead_limiter.cpp
+ *
+ * Master lookahead peak limiter (see lookahead_limiter.h).
+ */
+
+#include "lookahead_limiter.h"
+#include "audio_telemetry.h"
+#include <algorithm>
+#include <cmath>
+
+LookaheadLimiter::LookaheadLimiter()
+    : holdSegments(1), latencyFrames(0), ceiling(1.0f), releaseCoef(1.0f),
+      delayMask(0), writePos(0), segmentPos(0), segmentPeak(0.0f),
+      gainStart(1.0f), gainEnd(1.0f), historyMask(0), segmentIndex(0),
+      releasedGain(1.0f) {}
+
+void LookaheadLimiter::init(unsigned int sampleRate, float lookaheadMs,
+                            float releaseMs, float ceiling) {
+  const float lookaheadFrames = lookaheadMs * 1e-3f * sampleRate;
+  holdSegments =
+      (unsigned int)ceilf(lookaheadFrames / (float)SEGMENT_FRAMES);
+  if (holdSegments < 1)
+    holdSegments = 1;
+  // Le segment k n'est joué qu'une fois connus les segments k..k+hold+1
+  latencyFrames = (holdSegments + 2) * SEGMENT_FRAMES;
+  this->ceiling = ceiling;
+  releaseCoef =
+      1.0f - expf(-(float)SEGMENT_FRAMES / (releaseMs * 1e-3f * sampleRate));
+
+  unsigned int delaySize = 1;
+  while (delaySize < latencyFrames + SEGMENT_FRAMES)
+    delaySize <<= 1;
+  delayL.assign(delaySize, 0.0f);
+  delayR.assign(delaySize, 0.0f);
+  delayMask = delaySize - 1;
+
+  unsigned int historySize = 1;
+  while (historySize < holdSegments + 2)
+    historySize <<= 1;
+  required.assign(historySize, 1.0f);
+  released.assign(historySize, 1.0f);
+  historyMask = historySize - 1;
+
+  reset();
+}
+
+void LookaheadLimiter::reset() {
+  std::fill(delayL.begin(), delayL.end(), 0.0f);
+  std::fill(delayR.begin(), delayR.end(), 0.0f);
+  std::fill(required.begin(), required.end(), 1.0f);
+  std::fill(released.begin(), released.end(), 1.0f);
+  writePos = 0;
+  segmentPos = 0;
+  segmentPeak = 0.0f;
+  gainStart = gainEnd = 1.0f;
+  segmentIndex = 0;
+  releasedGain = 1.0f;
+}
+
+void LookaheadLimiter::endSegment() {
+  const unsigned int s = segmentIndex++;
+  required[s & historyMask] =
+      (segmentPeak > ceiling) ? ceiling / segmentPeak : 1.0f;
+  segmentPeak = 0.0f;
+
+  // Segment k = s - hold - 1, joué à partir de maintenant: min-hold des
+  // gains requis de k à s, puis release vers 1 sans dépasser ce minimum
+  const unsigned int k = s - holdSegments - 1;
+  float held = 1.0f;
+  for (unsigned int j = k; j != s + 1; j++)
+    held = fminf(held, required[j & historyMask]);
+  float gain = releasedGain + (1.0f - releasedGain) * releaseCoef;
+  if (gain > 0.9999f)
+    gain = 1.0f; // Fin de release: gain unité exact, plus rien n'est compté
+  releasedGain = fminf(held, gain);
+
+  // Moyenne sur hold + 1 segments: la descente commence avant le pic et
+  // l'atteint à temps (chaque terme de la moyenne le couvre déjà)
+  released[k & historyMask] = releasedGain;
+  float sum = 0.0f; // Somme exacte (quelques termes), pas de dérive
+  for (unsigned int j = k - holdSegments; j != k + 1; j++)
+    sum += released[j & historyMask];
+
+  gainStart = gainEnd;
+  gainEnd = sum / (float)(holdSegments + 1);
+}
+
+void LookaheadLimiter::process(float *left, float *right,
+                               unsigned int nFrames) {
+  unsigned long limitedFrames = 0;
+  float minGain = 1.0f;
+
+  for (unsigned int i = 0; i < nFrames;) {
+    unsigned int n = SEGMENT_FRAMES - segmentPos;
+    if (n > nFrames - i)
+      n = nFrames - i;
+
+    // Segments alignés sur SEGMENT_FRAMES dans la ligne à retard: jamais de
+    // repli au milieu d'un segment
+    float *__restrict inL = left + i;
+    float *__restrict inR = right + i;
+    float *__restrict writeL = &delayL[writePos];
+    float *__restrict writeR = &delayR[writePos];
+    const float *__restrict readL =
+        &delayL[(writePos - latencyFrames) & delayMask];
+    const float *__restrict readR =
+        &delayR[(writePos - latencyFrames) & delayMask];
+
+    const float step = (gainEnd - gainStart) / (float)SEGMENT_FRAMES;
+    const float base = gainStart + step * (float)(segmentPos + 1);
+    float peak = segmentPeak;
+    for (unsigned int j = 0; j < n; j++) {
+      const float l = inL[j];
+      const float r = inR[j];
+      peak = fmaxf(peak, fmaxf(fabsf(l), fabsf(r)));
+      writeL[j] = l;
+      writeR[j] = r;
+      const float g = base + step * (float)j;
+      inL[j] = readL[j] * g;
+      inR[j] = readR[j] * g;
+    }
+    segmentPeak = peak;
+
+    const float segmentMin = fminf(gainStart, gainEnd);
+    if (segmentMin < 1.0f) {
+      limitedFrames += n;
+      minGain = fminf(minGain, segmentMin);
+    }
+
+    writePos = (writePos + n) & delayMask;
+    segmentPos += n;
+    i += n;
+    if (segmentPos == SEGMENT_FRAMES) {
+      segmentPos = 0;
+      endSegment();
+    }
+  }
+
+  if (limitedFrames)
+    audio_telemetry_limiter(limitedFrames, minGain);
+}
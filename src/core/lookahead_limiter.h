@@ -0,0 +1,66 @@
+/*
+ * lookahead_limiter.h
+ *
+ * Stereo lookahead peak limiter for the master bus, as a MixProcessor insert.
+ *
+ * The gain is computed at control rate, one value per segment of
+ * SEGMENT_FRAMES: segment peak -> required gain, min-hold over the lookahead,
+ * release, then a moving average that ramps the gain down before the peak.
+ * Audio goes through a delay line and the gain is interpolated linearly
+ * across each segment, so every per-sample loop is a plain vectorizable
+ * block loop. Each segment's peak stays under the ceiling, at the cost of a
+ * fixed latency of getLatencyFrames().
+ */
+
+#ifndef LOOKAHEAD_LIMITER_H
+#define LOOKAHEAD_LIMITER_H
+
+#include "mix_graph.h"
+#include <vector>
+
+class LookaheadLimiter : public MixProcessor {
+public:
+  static const unsigned int SEGMENT_FRAMES = 16;
+
+  LookaheadLimiter();
+
+  // Startup only: allocates the delay line and control history
+  void init(unsigned int sampleRate, float lookaheadMs, float releaseMs,
+            float ceiling);
+  void reset();
+
+  void process(float *left, float *right, unsigned int nFrames) override;
+
+  unsigned int getLatencyFrames() const { return latencyFrames; }
+  float getCeiling() const { return ceiling; }
+
+private:
+  // Control step after each complete input segment
+  void endSegment();
+
+  unsigned int holdSegments; // Lookahead in segments (min-hold window - 1)
+  unsigned int latencyFrames;
+  float ceiling;
+  float releaseCoef; // Per segment, towards unity gain
+
+  // Delay line (stereo, power-of-two ring)
+  std::vector<float> delayL;
+  std::vector<float> delayR;
+  unsigned int delayMask;
+  unsigned int writePos;
+
+  // Segment being received and gain ramp of the segment being played
+  unsigned int segmentPos;
+  float segmentPeak;
+  float gainStart;
+  float gainEnd;
+
+  // Control history (rings of historySize = power of two segments)
+  std::vector<float> required; // Gain required by each input segment
+  std::vector<float> released; // Held + release, averaged for the attack
+  unsigned int historyMask;
+  unsigned int segmentIndex; // Input segments completed
+  float releasedGain;
+};
+
+#endif // LOOKAHEAD_LIMITER_H
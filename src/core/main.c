@@ -1,4 +1,6 @@
 #include "audio_c_api.h"
+#include "audio_format.h"
+#include "audio_telemetry.h"
 #include "config.h"
 #include "context.h"
 #include "display.h"
@@ -14,10 +16,6 @@ extern void midi_Init(void);
 extern void midi_Cleanup(void);
 extern int midi_Connect(void);
 extern void midi_SetupVolumeControl(void);
-// Add declarations for the new C-API MIDI callback setters
-extern void midi_set_note_on_callback(void (*callback)(int noteNumber,
-                                                       int velocity));
-extern void midi_set_note_off_callback(void (*callback)(int noteNumber));
 
 #ifdef NO_SFML
 // Si SFML est désactivé, fournir des stubs/déclarations anticipées pour les
@@ -119,6 +117,22 @@ int main(int argc, char **argv) {
   int list_audio_devices = 0;      // Afficher les périphériques audio
   int audio_device_id = -1;        // -1 = utiliser le périphérique par défaut
   int use_sfml_window = 0; // Par défaut, pas de fenêtre SFML en mode CLI
+  int poly_voices = DEFAULT_NUM_POLY_VOICES; // Polyphonie du synth FFT
+  int fft_average_lines =
+      DEFAULT_MOVING_AVERAGE_WINDOW_SIZE; // Lissage temporel du synth FFT
+  int audio_stats_interval = 0; // Résumé télémétrie audio (s), 0 = désactivé
+  int sample_rate = DEFAULT_SAMPLING_FREQUENCY; // Fréquence d'échantillonnage
+  int engine_rate = 0; // Fréquence des moteurs, 0 = sample_rate
+  int buffer_size = 0; // Taille des buffers de synthèse, 0 = selon la fréquence
+  int device_buffer = 0; // Période du périphérique, 0 = buffer de synthèse
+  int sub_block = 0;     // Sous-bloc du callback, 0 = buffer de synthèse
+  AudioBackendType audio_backend = AUDIO_BACKEND_RTAUDIO; // Sortie audio
+  const char *audio_file = NULL; // Fichier de sortie (backend file)
+  int reverb_decimation = 1;     // ZitaRev1 à fréquence moteur / N
+  const char *reverb_ir = NULL;  // Réponse impulsionnelle (convolution)
+  const char *record_file = NULL; // Enregistrement de la sortie master
+  ScannerMapMode scanner_map_mode = SCANNER_MAP_BANK; // Plusieurs scanners
+  int scanner_map_given = 0;
 
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
@@ -137,6 +151,46 @@ int main(int argc, char **argv) {
           "  --dmx-port=<PORT>        Specify DMX serial port (default: %s)\n",
           DMX_PORT);
       printf("  --silent-dmx             Suppress DMX error messages\n");
+      printf("  --poly-voices=<N>        FFT synth polyphony, 1-%d (default: "
+             "%d)\n",
+             MAX_POLY_VOICES, DEFAULT_NUM_POLY_VOICES);
+      printf("  --fft-average=<N>        FFT synth moving average over N image "
+             "lines, 1-%d (default: %d)\n",
+             MAX_MOVING_AVERAGE_WINDOW_SIZE,
+             DEFAULT_MOVING_AVERAGE_WINDOW_SIZE);
+      printf("  --audio-stats=<S>        Print audio xrun/load and UDP ingest "
+             "statistics every S seconds\n");
+      printf("  --sample-rate=<HZ>       Audio sample rate, %d-%d (default: "
+             "%d)\n",
+             SAMPLING_FREQUENCY_MIN, SAMPLING_FREQUENCY_MAX,
+             DEFAULT_SAMPLING_FREQUENCY);
+      printf("  --engine-rate=<HZ>       Synthesis rate, the output is "
+             "upsampled to --sample-rate (1, 2 or 4 times this rate)\n");
+      printf("  --buffer-size=<N>        Synth buffer size in frames, %d-%d "
+             "(default: 600 at 96kHz, 150 at 48kHz)\n",
+             AUDIO_BUFFER_SIZE_MIN, AUDIO_BUFFER_SIZE_MAX);
+      printf("  --device-buffer=<N>      Audio device period in frames, %d-%d "
+             "(default: synth buffer size)\n",
+             AUDIO_DEVICE_BUFFER_MIN, AUDIO_DEVICE_BUFFER_MAX);
+      printf("  --sub-block=<N>          Internal mix block in frames, %d to "
+             "the synth buffer size (default: synth buffer size)\n",
+             AUDIO_SUB_BLOCK_MIN);
+      printf("  --reverb-decimation=<N>  Run the reverb at 1/N of the engine "
+             "rate, 1, 2 or 4 (default: 1)\n");
+      printf("  --reverb-ir=<PATH>       Convolution reverb with the impulse "
+             "response PATH (mono/stereo WAV) instead of ZitaRev1\n");
+      printf("  --audio-backend=<B>      Audio output: rtaudio (default), null "
+             "or file (internal clock, no device)\n");
+      printf("  --audio-file=<PATH>      Write the output to PATH (.wav, "
+             "otherwise raw float32), implies --audio-backend=file\n");
+      printf("  --record=<PATH>          Also record the master output to "
+             "PATH (.wav/RF64, otherwise raw float32) from a disk thread\n");
+      printf("  --scanner=<IP[:PORT]>    Accept lines from this scanner, "
+             "repeat for up to %d chained scanners (default: any sender)\n",
+             UDP_MAX_SOURCES);
+      printf("  --scanner-map=<M>        Several scanners: bank (side by side "
+             "on the note bank, default) or engines (scanner 1: IFFT synth, "
+             "2: FFT synth)\n");
       printf("\nExamples:\n");
       printf("  %s --cli --audio-device=3           # Use audio device 3 in "
              "CLI mode\n",
@@ -175,6 +229,117 @@ int main(int argc, char **argv) {
     } else if (strncmp(argv[i], "--audio-device=", 15) == 0) {
       audio_device_id = atoi(argv[i] + 15);
       printf("Using audio device: %d\n", audio_device_id);
+    } else if (strncmp(argv[i], "--poly-voices=", 14) == 0) {
+      poly_voices = atoi(argv[i] + 14);
+      if (poly_voices < 1 || poly_voices > MAX_POLY_VOICES) {
+        printf("Invalid polyphony: %d (must be 1-%d)\n", poly_voices,
+               MAX_POLY_VOICES);
+        return EXIT_FAILURE;
+      }
+      printf("FFT synth polyphony: %d voices\n", poly_voices);
+    } else if (strncmp(argv[i], "--fft-average=", 14) == 0) {
+      fft_average_lines = atoi(argv[i] + 14);
+      if (fft_average_lines < 1 ||
+          fft_average_lines > MAX_MOVING_AVERAGE_WINDOW_SIZE) {
+        printf("Invalid FFT average window: %d (must be 1-%d)\n",
+               fft_average_lines, MAX_MOVING_AVERAGE_WINDOW_SIZE);
+        return EXIT_FAILURE;
+      }
+      printf("FFT synth moving average: %d lines\n", fft_average_lines);
+    } else if (strncmp(argv[i], "--audio-stats=", 14) == 0) {
+      audio_stats_interval = atoi(argv[i] + 14);
+      if (audio_stats_interval < 1) {
+        printf("Invalid audio stats interval: %d (must be >= 1)\n",
+               audio_stats_interval);
+        return EXIT_FAILURE;
+      }
+      printf("Audio statistics every %d s\n", audio_stats_interval);
+    } else if (strncmp(argv[i], "--sample-rate=", 14) == 0) {
+      sample_rate = atoi(argv[i] + 14);
+      if (sample_rate < SAMPLING_FREQUENCY_MIN ||
+          sample_rate > SAMPLING_FREQUENCY_MAX) {
+        printf("Invalid sample rate: %d (must be %d-%d)\n", sample_rate,
+               SAMPLING_FREQUENCY_MIN, SAMPLING_FREQUENCY_MAX);
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--engine-rate=", 14) == 0) {
+      engine_rate = atoi(argv[i] + 14);
+      if (engine_rate < SAMPLING_FREQUENCY_MIN ||
+          engine_rate > SAMPLING_FREQUENCY_MAX) {
+        printf("Invalid engine rate: %d (must be %d-%d)\n", engine_rate,
+               SAMPLING_FREQUENCY_MIN, SAMPLING_FREQUENCY_MAX);
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--buffer-size=", 14) == 0) {
+      buffer_size = atoi(argv[i] + 14);
+      if (buffer_size < AUDIO_BUFFER_SIZE_MIN ||
+          buffer_size > AUDIO_BUFFER_SIZE_MAX) {
+        printf("Invalid buffer size: %d (must be %d-%d)\n", buffer_size,
+               AUDIO_BUFFER_SIZE_MIN, AUDIO_BUFFER_SIZE_MAX);
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--device-buffer=", 16) == 0) {
+      device_buffer = atoi(argv[i] + 16);
+      if (device_buffer < AUDIO_DEVICE_BUFFER_MIN ||
+          device_buffer > AUDIO_DEVICE_BUFFER_MAX) {
+        printf("Invalid device buffer: %d (must be %d-%d)\n", device_buffer,
+               AUDIO_DEVICE_BUFFER_MIN, AUDIO_DEVICE_BUFFER_MAX);
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--sub-block=", 12) == 0) {
+      // Borne haute vérifiée par audio_format_set_blocks() (dépend de
+      // --buffer-size)
+      sub_block = atoi(argv[i] + 12);
+      if (sub_block < AUDIO_SUB_BLOCK_MIN) {
+        printf("Invalid sub-block: %d (must be >= %d)\n", sub_block,
+               AUDIO_SUB_BLOCK_MIN);
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--reverb-decimation=", 20) == 0) {
+      reverb_decimation = atoi(argv[i] + 20);
+      if (reverb_decimation != 1 && reverb_decimation != 2 &&
+          reverb_decimation != 4) {
+        printf("Invalid reverb decimation: %d (must be 1, 2 or 4)\n",
+               reverb_decimation);
+        return EXIT_FAILURE;
+      }
+    } else if (strncmp(argv[i], "--reverb-ir=", 12) == 0) {
+      reverb_ir = argv[i] + 12;
+    } else if (strncmp(argv[i], "--audio-backend=", 16) == 0) {
+      const char *name = argv[i] + 16;
+      if (strcmp(name, "rtaudio") == 0) {
+        audio_backend = AUDIO_BACKEND_RTAUDIO;
+      } else if (strcmp(name, "null") == 0) {
+        audio_backend = AUDIO_BACKEND_NULL;
+      } else if (strcmp(name, "file") == 0) {
+        audio_backend = AUDIO_BACKEND_FILE;
+      } else {
+        printf("Invalid audio backend: %s (rtaudio, null or file)\n", name);
+        return EXIT_FAILURE;
+      }
+      printf("Audio backend: %s\n", name);
+    } else if (strncmp(argv[i], "--audio-file=", 13) == 0) {
+      audio_file = argv[i] + 13;
+      audio_backend = AUDIO_BACKEND_FILE;
+      printf("Audio output file: %s\n", audio_file);
+    } else if (strncmp(argv[i], "--record=", 9) == 0) {
+      record_file = argv[i] + 9;
+      printf("Recording master output to: %s\n", record_file);
+    } else if (strncmp(argv[i], "--scanner=", 10) == 0) {
+      int source = udp_source_add(argv[i] + 10);
+      if (source < 0) {
+        printf("Invalid scanner: %s (IPv4[:PORT], not listed twice, at most "
+               "%d)\n",
+               argv[i] + 10, UDP_MAX_SOURCES);
+        return EXIT_FAILURE;
+      }
+      printf("Scanner %d: %s\n", source + 1, argv[i] + 10);
+    } else if (strncmp(argv[i], "--scanner-map=", 14) == 0) {
+      if (scanner_map_parse_mode(argv[i] + 14, &scanner_map_mode) != 0) {
+        printf("Invalid scanner map: %s (bank or engines)\n", argv[i] + 14);
+        return EXIT_FAILURE;
+      }
+      scanner_map_given = 1;
     } else if (strcmp(argv[i], "--test-tone") == 0) {
       printf("🎵 Test tone mode enabled (440Hz)\n");
       // Enable minimal callback mode for testing
@@ -186,6 +351,35 @@ int main(int argc, char **argv) {
     }
   }
 
+  if (audio_backend == AUDIO_BACKEND_FILE && audio_file == NULL) {
+    printf("--audio-backend=file requires --audio-file=<PATH>\n");
+    return EXIT_FAILURE;
+  }
+  if (scanner_map_given && udp_source_count() < 2) {
+    printf("--scanner-map requires at least 2 --scanner\n");
+    return EXIT_FAILURE;
+  }
+
+  // Format audio fixé avant toute initialisation audio/synthèse (les buffers
+  // sont dimensionnés à partir de ces valeurs). Les moteurs tournent à
+  // --engine-rate, la sortie est suréchantillonnée vers --sample-rate.
+  if (engine_rate == 0) {
+    engine_rate = sample_rate;
+  }
+  if (sample_rate % engine_rate != 0) {
+    printf("--sample-rate (%d) must be 1, 2 or 4 times --engine-rate (%d)\n",
+           sample_rate, engine_rate);
+    return EXIT_FAILURE;
+  }
+  if (audio_format_set((unsigned int)engine_rate,
+                       (unsigned int)buffer_size) != 0 ||
+      audio_format_set_output_upsampling(
+          (unsigned int)(sample_rate / engine_rate)) != 0 ||
+      audio_format_set_blocks((unsigned int)device_buffer,
+                              (unsigned int)sub_block) != 0) {
+    return EXIT_FAILURE;
+  }
+
   int dmxFd = -1;
   if (use_dmx) {
 #ifdef USE_DMX
@@ -275,6 +469,18 @@ int main(int argc, char **argv) {
            audio_device_id);
   }
 
+  // Sortie sans périphérique (null/file) pour les tests headless
+  if (audio_backend != AUDIO_BACKEND_RTAUDIO) {
+    setRequestedAudioBackend(audio_backend, audio_file);
+  }
+  setRequestedReverbDecimation(reverb_decimation);
+  if (reverb_ir) {
+    setRequestedReverbImpulseResponse(reverb_ir);
+  }
+  if (record_file) {
+    setRequestedRecordFile(record_file);
+  }
+
   // Initialiser l'audio (RtAudio) avec le bon périphérique
   audio_Init();
 
@@ -287,13 +493,8 @@ int main(int argc, char **argv) {
   // Essayer de connecter au Launchkey Mini
   if (midi_Connect()) {
     printf("MIDI: Launchkey Mini connected\n");
-    // Setup note callbacks if MIDI connected successfully
-    // No need to check gMidiController here, the C-wrappers will do it.
-    midi_set_note_on_callback(synth_fft_note_on);
-    midi_set_note_off_callback(synth_fft_note_off);
-    printf("MIDI: Note On/Off callbacks for synth_fft registered via C API.\n");
-    // The following if(gMidiController) block is removed as it's C++ specific
-    // and was causing compilation errors in C.
+    // Note On/Off reach synth_fft through the timestamped MIDI event queue
+    // (midi_event_queue.h), no callback registration needed here.
   } else {
     printf("MIDI: No Launchkey Mini device found\n");
     // Note: nous ne pouvons pas afficher la liste des périphériques ici car
@@ -301,13 +502,18 @@ int main(int argc, char **argv) {
   }
 
   synth_IfftInit();
+  synth_fft_set_polyphony(poly_voices);
+  synth_fft_set_moving_average_window(fft_average_lines);
   synth_fftMode_init(); // Initialize the new FFT synth mode
   display_Init(window);
   // visual_freeze_init(); // Removed: Old visual-only freeze
   synth_data_freeze_init();         // Initialize synth data freeze feature
   displayable_synth_buffers_init(); // Initialize displayable synth buffers
 
-  int s = udp_Init(&si_other, &si_me);
+  // Une socket et un thread de réception par scanner (SO_REUSEPORT)
+  int udp_sockets[UDP_MAX_SOURCES];
+  int udp_receivers = udp_InitReceivers(udp_sockets, &si_me);
+  int s = udp_sockets[0];
   if (s < 0) {
     perror("Error initializing UDP");
 #ifndef NO_SFML
@@ -324,9 +530,23 @@ int main(int argc, char **argv) {
     printf("Erreur lors du démarrage audio: %d\n", status);
   }
 
-  /* Create double buffer */
+  /* Create double buffer (one ring per scanner with several scanners) */
   DoubleBuffer db;
-  initDoubleBuffer(&db);
+  DoubleBuffer *image_db = &db;
+  ScannerMap *scanner_map = NULL;
+  if (udp_source_count() > 1) {
+    scanner_map = scanner_map_create(udp_source_count(), scanner_map_mode);
+    if (scanner_map == NULL) {
+#ifndef NO_SFML
+      if (window)
+        sfRenderWindow_destroy(window);
+#endif
+      return EXIT_FAILURE;
+    }
+    image_db = scanner_map_ifft(scanner_map);
+  } else {
+    initDoubleBuffer(&db);
+  }
 
   /* Build global context structure */
   Context context = {0};
@@ -335,7 +555,9 @@ int main(int argc, char **argv) {
   context.si_other = &si_other;
   context.si_me = &si_me;
   context.audioData = NULL; // RtAudio gère maintenant le buffer audio
-  context.doubleBuffer = &db;
+  context.doubleBuffer = image_db;
+  context.fftDoubleBuffer = scanner_map ? scanner_map_fft(scanner_map) : NULL;
+  context.scannerMap = scanner_map;
   context.dmxCtx = dmxCtx;
   context.running = 1; // Flag de terminaison pour le contexte
 
@@ -372,8 +594,9 @@ int main(int argc, char **argv) {
 #endif // NO_SFML
 
   /* Create threads for UDP, Audio, and DMX (pas de thread d'affichage) */
-  pthread_t udpThreadId, audioThreadId, dmxThreadId,
+  pthread_t udpThreadIds[UDP_MAX_SOURCES], audioThreadId, dmxThreadId,
       fftSynthThreadId; // Added fftSynthThreadId
+  UdpReceiver udpReceivers[UDP_MAX_SOURCES];
 
 #ifdef USE_DMX
   if (use_dmx && dmxFd >= 0) {
@@ -390,13 +613,19 @@ int main(int argc, char **argv) {
     }
   }
 #endif
-  if (pthread_create(&udpThreadId, NULL, udpThread, (void *)&context) != 0) {
-    perror("Error creating UDP thread");
+  for (int r = 0; r < udp_receivers; r++) {
+    udpReceivers[r].ctx = &context;
+    udpReceivers[r].socket = udp_sockets[r];
+    udpReceivers[r].receiver = r;
+    if (pthread_create(&udpThreadIds[r], NULL, udpReceiverThread,
+                       (void *)&udpReceivers[r]) != 0) {
+      perror("Error creating UDP thread");
 #ifndef NO_SFML
-    if (window)
-      sfRenderWindow_destroy(window);
+      if (window)
+        sfRenderWindow_destroy(window);
 #endif
-    return EXIT_FAILURE;
+      return EXIT_FAILURE;
+    }
   }
   if (pthread_create(&audioThreadId, NULL, audioProcessingThread,
                      (void *)&context) != 0) {
@@ -452,10 +681,10 @@ int main(int argc, char **argv) {
   fflush(stdout); // S'assurer que tout est affiché immédiatement
 
   /* Boucle principale pour le mode CLI */
-  uint8_t local_main_R[CIS_MAX_PIXELS_NB]; // Buffers locaux pour DMX
-  uint8_t local_main_G[CIS_MAX_PIXELS_NB];
-  uint8_t local_main_B[CIS_MAX_PIXELS_NB];
+  ImageLineRef main_line; // Ligne lue sur place pour le DMX
+  initImageLineRef(&main_line);
   int process_this_frame_main_loop;
+  uint32_t main_loop_image_version = 0; // Dernière ligne traitée
 
   while (running && context.running && app_running) {
     process_this_frame_main_loop = 0;
@@ -483,17 +712,11 @@ int main(int argc, char **argv) {
     }
 #endif // NO_SFML
 
-    /* Vérifier si le double buffer contient de nouvelles données */
-    pthread_mutex_lock(&db.mutex);
-    if (db.dataReady) {
-      // Copier les données pour DMX pendant que le mutex est verrouillé
-      memcpy(local_main_R, db.processingBuffer_R, CIS_MAX_PIXELS_NB);
-      memcpy(local_main_G, db.processingBuffer_G, CIS_MAX_PIXELS_NB);
-      memcpy(local_main_B, db.processingBuffer_B, CIS_MAX_PIXELS_NB);
-      db.dataReady = 0; // Marquer comme consommé par la boucle principale
+    /* Vérifier si une nouvelle ligne a été publiée (sans verrou) */
+    if (getImageVersion(image_db) != main_loop_image_version) {
+      main_loop_image_version = acquireImageLine(image_db, &main_line);
       process_this_frame_main_loop = 1;
     }
-    pthread_mutex_unlock(&db.mutex);
 
     if (process_this_frame_main_loop) {
       /* Rendu de la nouvelle ligne si SFML est activé */
@@ -507,10 +730,9 @@ int main(int argc, char **argv) {
       }
 
       /* Calcul de la couleur moyenne et mise à jour du contexte DMX */
-      // DMX utilise les données copiées local_main_R,G,B (qui sont les données
-      // live de db.processingBuffer)
+      // DMX lit la ligne publiée par le thread UDP (main_line, sans copie)
       DMXSpot zoneSpots[DMX_NUM_SPOTS];
-      computeAverageColorPerZone(local_main_R, local_main_G, local_main_B,
+      computeAverageColorPerZone(main_line.R, main_line.G, main_line.B,
                                  CIS_MAX_PIXELS_NB, zoneSpots);
 
       pthread_mutex_lock(&dmxCtx->mutex);
@@ -546,15 +768,18 @@ int main(int argc, char **argv) {
 #endif // NO_SFML
 #endif // PRINT_FPS
 
+    audio_telemetry_report_if_due(audio_stats_interval);
+    udp_stats_report_if_due(audio_stats_interval);
+
     /* Petite pause pour limiter la charge CPU */
     usleep(100);
   }
 #else
   /* Boucle principale avec affichage graphique */
-  // uint8_t local_main_R,G,B sont déjà déclarés plus haut si CLI_MODE est
-  // défini. S'il n'est pas défini, il faut les déclarer ici. Pour simplifier,
-  // on les sort de la condition #ifdef. Déjà fait en dehors de la boucle
-  // CLI_MODE.
+  // main_line et main_loop_image_version sont déjà déclarés plus haut si
+  // CLI_MODE est défini. S'il n'est pas défini, il faut les déclarer ici. Pour
+  // simplifier, on les sort de la condition #ifdef. Déjà fait en dehors de la
+  // boucle CLI_MODE.
 
   while (sfRenderWindow_isOpen(
       window)) { // Cette boucle ne s'exécute que si window est valide (donc
@@ -572,16 +797,11 @@ int main(int argc, char **argv) {
     }
 #endif // NO_SFML
 
-    /* Vérifier si le double buffer contient de nouvelles données */
-    pthread_mutex_lock(&db.mutex);
-    if (db.dataReady) {
-      memcpy(local_main_R, db.processingBuffer_R, CIS_MAX_PIXELS_NB);
-      memcpy(local_main_G, db.processingBuffer_G, CIS_MAX_PIXELS_NB);
-      memcpy(local_main_B, db.processingBuffer_B, CIS_MAX_PIXELS_NB);
-      db.dataReady = 0;
+    /* Vérifier si une nouvelle ligne a été publiée (sans verrou) */
+    if (getImageVersion(image_db) != main_loop_image_version) {
+      main_loop_image_version = acquireImageLine(image_db, &main_line);
       process_this_frame_main_loop = 1;
     }
-    pthread_mutex_unlock(&db.mutex);
 
     if (process_this_frame_main_loop) {
       /* Rendu de la nouvelle ligne à partir du buffer */
@@ -593,10 +813,9 @@ int main(int argc, char **argv) {
       pthread_mutex_unlock(&g_displayable_synth_mutex);
 
       /* Calcul de la couleur moyenne et mise à jour du contexte DMX */
-      // DMX utilise les données copiées local_main_R,G,B (qui sont les données
-      // live de db.processingBuffer)
+      // DMX lit la ligne publiée par le thread UDP (main_line, sans copie)
       DMXSpot zoneSpots[DMX_NUM_SPOTS];
-      computeAverageColorPerZone(local_main_R, local_main_G, local_main_B,
+      computeAverageColorPerZone(main_line.R, main_line.G, main_line.B,
                                  CIS_MAX_PIXELS_NB, zoneSpots);
 
       pthread_mutex_lock(&dmxCtx->mutex);
@@ -628,6 +847,9 @@ int main(int argc, char **argv) {
 #endif // NO_SFML
 #endif // PRINT_FPS
 
+    audio_telemetry_report_if_due(audio_stats_interval);
+    udp_stats_report_if_due(audio_stats_interval);
+
     /* Petite pause pour limiter la charge CPU */
     usleep(100);
   }
@@ -639,13 +861,23 @@ int main(int argc, char **argv) {
   }
 #endif // NO_SFML
 
+  // Bilan de la télémétrie audio et de la réception UDP depuis le démarrage
+  AudioTelemetrySnapshot audio_stats;
+  audio_telemetry_read(&audio_stats);
+  audio_telemetry_print(&audio_stats, NULL);
+  UdpIngestStats udp_stats;
+  udp_stats_read(&udp_stats);
+  udp_stats_print(&udp_stats, NULL);
+
   printf("\nTerminaison des threads et nettoyage...\n");
   /* Terminaison et synchronisation */
   context.running = 0;
   dmxCtx->running = 0;
   keepRunning = 0; // Variable globale du module DMX
 
-  pthread_join(udpThreadId, NULL);
+  for (int r = 0; r < udp_receivers; r++) {
+    pthread_join(udpThreadIds[r], NULL);
+  }
   pthread_join(audioThreadId, NULL);
   pthread_join(fftSynthThreadId, NULL); // Join the FFT synth thread
 #ifdef USE_DMX
@@ -658,7 +890,11 @@ int main(int argc, char **argv) {
   // visual_freeze_cleanup(); // Removed: Old visual-only freeze
   displayable_synth_buffers_cleanup(); // Cleanup displayable synth buffers
   synth_data_freeze_cleanup();         // Cleanup synth data freeze resources
-  cleanupDoubleBuffer(&db);            // Cleanup DoubleBuffer resources
+  if (scanner_map) {
+    scanner_map_destroy(scanner_map); // Rings of every scanner
+  } else {
+    cleanupDoubleBuffer(&db); // Cleanup DoubleBuffer resources
+  }
   midi_Cleanup();
   audio_Cleanup(); // Nettoyage de RtAudio
 
@@ -6,14 +6,14 @@
  */
 
 #include "midi_controller.h"
+#include "audio_params.h"
 #include "audio_rtaudio.h"
 #include "config.h"
-#include "synth.h"     // For synth data freeze global variables and mutex
+#include "midi_event_queue.h"
 #include "synth_fft.h" // For synth_fft_set_vibrato_rate
 #include "three_band_eq.h"
 #include <algorithm>
 #include <iostream>
-#include <pthread.h> // Required for pthread_mutex_lock/unlock
 
 // Global instance
 MidiController *gMidiController = nullptr;
@@ -43,12 +43,7 @@ MidiController *gMidiController = nullptr;
 
 MidiController::MidiController()
     : midiIn(nullptr), isConnected(false), currentController(MIDI_NONE),
-      mix_level_synth_ifft(1.0f), // Default IFFT level to 1.0f (100%) for
-                                  // audibility when no MIDI
-      mix_level_synth_fft(0.5f),  // Default FFT level to 0.5f for audibility
-      reverb_send_synth_ifft(0.7f),
-      reverb_send_synth_fft(0.0f), // Initialize all levels
-      lfo_vibrato_speed(0.5f),     // Default LFO vibrato speed (normalized 0-1)
+      lfo_vibrato_speed(0.5f), // Default LFO vibrato speed (normalized 0-1)
       // ADSR values now in seconds (20ms to 2s). Default to mid-range (1.01s)
       envelope_fft_attack(0.02f +
                           0.5f * 1.98f), // Default FFT envelope attack (1.01s)
@@ -59,8 +54,6 @@ MidiController::MidiController()
 
   // Initialize with empty callback
   volumeChangeCallback = [](float /*volume*/) {};
-  noteOnCallback = nullptr;
-  noteOffCallback = nullptr;
 }
 
 MidiController::~MidiController() { cleanup(); }
@@ -219,16 +212,6 @@ void MidiController::setVolumeChangeCallback(
   volumeChangeCallback = callback;
 }
 
-void MidiController::setNoteOnCallback(
-    std::function<void(int noteNumber, int velocity)> callback) {
-  this->noteOnCallback = callback;
-}
-
-void MidiController::setNoteOffCallback(
-    std::function<void(int noteNumber)> callback) {
-  this->noteOffCallback = callback;
-}
-
 bool MidiController::isControllerConnected(MidiControllerType type) {
   return isConnected && (currentController == type);
 }
@@ -264,12 +247,20 @@ void MidiController::midiCallback(double timeStamp,
 
 void MidiController::processMidiMessage(double timeStamp,
                                         std::vector<unsigned char> *message) {
-  (void)timeStamp; // Mark timeStamp as unused
+  // Map the driver timestamp onto the synth clock before anything else so
+  // that filtered messages still advance the accumulated RtMidi time
+  double eventTime = midi_event_queue_stamp(timeStamp);
+
   // Check if this is a valid message
   if (message->size() < 3) {
     return; // Not enough data for a CC message - silently ignore
   }
 
+  // synth_fft events are queued and applied by the synth thread at their
+  // sample offset, voices are never touched from this thread
+  MidiEvent synthEvent = {};
+  synthEvent.time_s = eventTime;
+
   unsigned char status = message->at(0);
   unsigned char number = message->at(1);
   unsigned char value = message->at(2);
@@ -398,21 +389,21 @@ void MidiController::processMidiMessage(double timeStamp,
 
     // Volume synthèse IFFT (CC 21)
     case MIDI_CC_IFFT_VOLUME:
-      mix_level_synth_ifft = normalizedValue;
+      audio_params_set(AUDIO_PARAM_MIX_LEVEL_IFFT, normalizedValue);
       std::cout << "\033[1;37mIFFT SYNTH VOLUME: "
                 << (int)(normalizedValue * 100) << "%\033[0m" << std::endl;
       break;
 
     // Volume synthèse FFT (CC 22)
     case MIDI_CC_FFT_VOLUME:
-      mix_level_synth_fft = normalizedValue;
+      audio_params_set(AUDIO_PARAM_MIX_LEVEL_FFT, normalizedValue);
       std::cout << "\033[1;37mFFT SYNTH VOLUME: "
                 << (int)(normalizedValue * 100) << "%\033[0m" << std::endl;
       break;
 
     // Wet/Dry réverbération FFT (CC 23)
     case MIDI_CC_REVERB_WET_DRY_FFT:
-      reverb_send_synth_fft = normalizedValue;
+      audio_params_set(AUDIO_PARAM_REVERB_SEND_FFT, normalizedValue);
       std::cout << "\033[1;36mFFT REVERB WET/DRY: "
                 << (int)(normalizedValue * 100) << "%\033[0m" << std::endl;
       if (gAudioSystem && normalizedValue > 0.0f) {
@@ -424,7 +415,7 @@ void MidiController::processMidiMessage(double timeStamp,
 
     // Wet/Dry réverbération IFFT (CC 24)
     case MIDI_CC_REVERB_WET_DRY_IFFT:
-      reverb_send_synth_ifft = normalizedValue;
+      audio_params_set(AUDIO_PARAM_REVERB_SEND_IFFT, normalizedValue);
       std::cout << "\033[1;36mIFFT REVERB WET/DRY: "
                 << (int)(normalizedValue * 100) << "%\033[0m" << std::endl;
       if (gAudioSystem && normalizedValue > 0.0f) {
@@ -440,8 +431,9 @@ void MidiController::processMidiMessage(double timeStamp,
       // Hz to 10 Hz) The actual scaling factor (9.9f here) can be adjusted
       // based on desired max LFO speed. Minimum LFO speed is 0.1 Hz.
       lfo_vibrato_speed = 0.1f + normalizedValue * 9.9f;
-      synth_fft_set_vibrato_rate(
-          lfo_vibrato_speed); // Call the function to update LFO rate
+      synthEvent.type = MIDI_EVENT_VIBRATO_RATE;
+      synthEvent.value = lfo_vibrato_speed;
+      midi_event_queue_push(&synthEvent);
       std::cout << "\033[1;35mVIBRATO LFO SPEED: " << lfo_vibrato_speed
                 << " Hz\033[0m" << std::endl;
       break;
@@ -450,7 +442,9 @@ void MidiController::processMidiMessage(double timeStamp,
     case MIDI_CC_ENVELOPE_FFT_ATTACK:
       // Scale normalizedValue (0.0-1.0) to 0.02s-2.0s
       envelope_fft_attack = 0.02f + normalizedValue * 1.98f;
-      synth_fft_set_volume_adsr_attack(envelope_fft_attack); // Apply to synth
+      synthEvent.type = MIDI_EVENT_ENV_ATTACK;
+      synthEvent.value = envelope_fft_attack;
+      midi_event_queue_push(&synthEvent);
       std::cout << "\033[1;33mFFT ENV ATTACK: "
                 << (int)(envelope_fft_attack * 1000) << " ms\033[0m"
                 << std::endl;
@@ -460,7 +454,9 @@ void MidiController::processMidiMessage(double timeStamp,
     case MIDI_CC_ENVELOPE_FFT_DECAY:
       // Scale normalizedValue (0.0-1.0) to 0.02s-2.0s
       envelope_fft_decay = 0.02f + normalizedValue * 1.98f;
-      synth_fft_set_volume_adsr_decay(envelope_fft_decay); // Apply to synth
+      synthEvent.type = MIDI_EVENT_ENV_DECAY;
+      synthEvent.value = envelope_fft_decay;
+      midi_event_queue_push(&synthEvent);
       std::cout << "\033[1;33mFFT ENV DECAY: "
                 << (int)(envelope_fft_decay * 1000) << " ms\033[0m"
                 << std::endl;
@@ -470,7 +466,9 @@ void MidiController::processMidiMessage(double timeStamp,
     case MIDI_CC_ENVELOPE_FFT_RELEASE:
       // Scale normalizedValue (0.0-1.0) to 0.02s-2.0s
       envelope_fft_release = 0.02f + normalizedValue * 1.98f;
-      synth_fft_set_volume_adsr_release(envelope_fft_release); // Apply to synth
+      synthEvent.type = MIDI_EVENT_ENV_RELEASE;
+      synthEvent.value = envelope_fft_release;
+      midi_event_queue_push(&synthEvent);
       std::cout << "\033[1;33mFFT ENV RELEASE: "
                 << (int)(envelope_fft_release * 1000) << " ms\033[0m"
                 << std::endl;
@@ -480,10 +478,8 @@ void MidiController::processMidiMessage(double timeStamp,
     case MIDI_CC_VISUAL_FREEZE: // CC 105 - Keeping define name for now, but
                                 // controls synth data
       if (value > 0) {
-        pthread_mutex_lock(&g_synth_data_freeze_mutex);
-        g_is_synth_data_frozen = 1;
-        g_is_synth_data_fading_out = 0; // Stop any ongoing fade
-        pthread_mutex_unlock(&g_synth_data_freeze_mutex);
+        // Also stops an ongoing fade (synth thread, see synth_AudioProcess)
+        audio_params_set(AUDIO_PARAM_SYNTH_FREEZE, 1.0f);
         std::cout << "\033[1;34mSYNTH DATA FREEZE: ON\033[0m" << std::endl;
       }
       break;
@@ -491,13 +487,8 @@ void MidiController::processMidiMessage(double timeStamp,
     case MIDI_CC_VISUAL_RESUME: // CC 115 - Keeping define name for now, but
                                 // controls synth data
       if (value > 0) {
-        pthread_mutex_lock(&g_synth_data_freeze_mutex);
-        if (g_is_synth_data_frozen && !g_is_synth_data_fading_out) {
-          g_is_synth_data_fading_out = 1;
-          // g_synth_data_fade_start_time will be set in synth.c when fade
-          // starts
-        }
-        pthread_mutex_unlock(&g_synth_data_freeze_mutex);
+        // The synth thread starts the fade if the data is frozen
+        audio_params_set(AUDIO_PARAM_SYNTH_FREEZE, 0.0f);
         std::cout << "\033[1;34mSYNTH DATA RESUME: Initiating fade out\033[0m"
                   << std::endl;
       }
@@ -566,14 +557,14 @@ void MidiController::processMidiMessage(double timeStamp,
     //               << ", Note=" << noteNumber << ", Velocity=" << velocity
     //               << std::endl;
     // #endif
+    synthEvent.note = noteNumber;
+    synthEvent.velocity = velocity;
     if (velocity > 0) {
-      if (noteOnCallback) {
-        noteOnCallback(noteNumber, velocity);
-      }
+      synthEvent.type = MIDI_EVENT_NOTE_ON;
+      midi_event_queue_push(&synthEvent);
     } else { // Velocity 0 is typically a Note Off
-      if (noteOffCallback) {
-        noteOffCallback(noteNumber);
-      }
+      synthEvent.type = MIDI_EVENT_NOTE_OFF;
+      midi_event_queue_push(&synthEvent);
     }
   } else if (messageType == 0x80) { // Note Off message
     int noteNumber = number;        // message->at(1) is 'number'
@@ -583,9 +574,9 @@ void MidiController::processMidiMessage(double timeStamp,
     //               << ", Note=" << noteNumber << ", Velocity=" << (int)value
     //               << std::endl;
     // #endif
-    if (noteOffCallback) {
-      noteOffCallback(noteNumber);
-    }
+    synthEvent.type = MIDI_EVENT_NOTE_OFF;
+    synthEvent.note = noteNumber;
+    midi_event_queue_push(&synthEvent);
   }
   // Other MIDI messages (Pitch Bend, Program Change, etc.) can be handled here
 }
@@ -597,20 +588,20 @@ float MidiController::convertCCToVolume(unsigned char value) {
 
 // Accessors for mix levels
 float MidiController::getMixLevelSynthIfft() const {
-  return mix_level_synth_ifft;
+  return audio_params_get(AUDIO_PARAM_MIX_LEVEL_IFFT);
 }
 
 float MidiController::getMixLevelSynthFft() const {
-  return mix_level_synth_fft;
+  return audio_params_get(AUDIO_PARAM_MIX_LEVEL_FFT);
 }
 
 // Accessors for reverb send levels
 float MidiController::getReverbSendSynthIfft() const {
-  return reverb_send_synth_ifft;
+  return audio_params_get(AUDIO_PARAM_REVERB_SEND_IFFT);
 }
 
 float MidiController::getReverbSendSynthFft() const {
-  return reverb_send_synth_fft;
+  return audio_params_get(AUDIO_PARAM_REVERB_SEND_FFT);
 }
 
 // Accessors for new MIDI controls
@@ -679,19 +670,4 @@ void midi_SetupVolumeControl() {
   }
 }
 
-// Implementation of C-wrapper functions for setting note callbacks
-void midi_set_note_on_callback(void (*callback)(int noteNumber, int velocity)) {
-  if (gMidiController) {
-    // The std::function can wrap a C function pointer
-    gMidiController->setNoteOnCallback(callback);
-  }
-}
-
-void midi_set_note_off_callback(void (*callback)(int noteNumber)) {
-  if (gMidiController) {
-    // The std::function can wrap a C function pointer
-    gMidiController->setNoteOffCallback(callback);
-  }
-}
-
 } // extern "C"
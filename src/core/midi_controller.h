@@ -50,9 +50,6 @@ private:
 
   // Callback function for volume change
   std::function<void(float)> volumeChangeCallback;
-  // Callbacks for Note On/Off events
-  std::function<void(int noteNumber, int velocity)> noteOnCallback;
-  std::function<void(int noteNumber)> noteOffCallback;
 
   // Static callback wrapper required by RtMidi
   static void midiCallback(double timeStamp,
@@ -66,13 +63,8 @@ private:
   float convertCCToVolume(unsigned char value);
 
 public:
-  // Variables to store mix levels for the two synths
-  float mix_level_synth_ifft;
-  float mix_level_synth_fft;
-
-  // Variables to store reverb send levels for each synth
-  float reverb_send_synth_ifft;
-  float reverb_send_synth_fft;
+  // Mix and reverb send levels of the two synths live in audio_params
+  // (AUDIO_PARAM_MIX_LEVEL_*, AUDIO_PARAM_REVERB_SEND_*)
 
   // Variables for new MIDI controls
   float lfo_vibrato_speed;
@@ -98,10 +90,6 @@ public:
 
   // Set callback for volume changes
   void setVolumeChangeCallback(std::function<void(float)> callback);
-  // Set callbacks for Note On/Off events
-  void
-  setNoteOnCallback(std::function<void(int noteNumber, int velocity)> callback);
-  void setNoteOffCallback(std::function<void(int noteNumber)> callback);
 
   // Check if specific controller is connected
   bool isControllerConnected(MidiControllerType type);
@@ -137,10 +125,6 @@ int midi_Connect();
 void midi_Disconnect();
 void midi_SetupVolumeControl(); // Nouvelle fonction pour le contrôle du volume
                                 // en mode CLI
-
-// C-wrapper functions for setting note callbacks
-void midi_set_note_on_callback(void (*callback)(int noteNumber, int velocity));
-void midi_set_note_off_callback(void (*callback)(int noteNumber));
 }
 
 #endif /* MIDI_CONTROLLER_H */
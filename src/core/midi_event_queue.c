@@ -0,0 +1,86 @@
+/*
+ * midi_event_queue.c
+ */
+
+#include "midi_event_queue.h"
+#include <stdatomic.h>
+#include <time.h>
+
+#if (MIDI_EVENT_QUEUE_SIZE & (MIDI_EVENT_QUEUE_SIZE - 1)) != 0
+#error "MIDI_EVENT_QUEUE_SIZE must be a power of two."
+#endif
+
+#define MIDI_EVENT_QUEUE_MASK (MIDI_EVENT_QUEUE_SIZE - 1)
+
+// Head and tail live on separate cache lines so producer and consumer do not
+// bounce the same line on every event.
+static struct {
+  _Alignas(64) atomic_uint head; // Written by producer
+  _Alignas(64) atomic_uint tail; // Written by consumer
+  _Alignas(64) MidiEvent events[MIDI_EVENT_QUEUE_SIZE];
+} g_midi_queue;
+
+static atomic_ulong g_midi_queue_dropped;
+
+int midi_event_queue_push(const MidiEvent *event) {
+  unsigned int head =
+      atomic_load_explicit(&g_midi_queue.head, memory_order_relaxed);
+  unsigned int tail =
+      atomic_load_explicit(&g_midi_queue.tail, memory_order_acquire);
+
+  if (head - tail >= MIDI_EVENT_QUEUE_SIZE) {
+    atomic_fetch_add_explicit(&g_midi_queue_dropped, 1, memory_order_relaxed);
+    return -1;
+  }
+
+  g_midi_queue.events[head & MIDI_EVENT_QUEUE_MASK] = *event;
+  atomic_store_explicit(&g_midi_queue.head, head + 1, memory_order_release);
+  return 0;
+}
+
+int midi_event_queue_pop(MidiEvent *event) {
+  unsigned int tail =
+      atomic_load_explicit(&g_midi_queue.tail, memory_order_relaxed);
+  unsigned int head =
+      atomic_load_explicit(&g_midi_queue.head, memory_order_acquire);
+
+  if (tail == head) {
+    return 0;
+  }
+
+  *event = g_midi_queue.events[tail & MIDI_EVENT_QUEUE_MASK];
+  atomic_store_explicit(&g_midi_queue.tail, tail + 1, memory_order_release);
+  return 1;
+}
+
+double midi_event_queue_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+double midi_event_queue_stamp(double rtmidi_delta_s) {
+  // RtMidi reports the time since the previous message (0 for the first one).
+  // Accumulate it and map it onto CLOCK_MONOTONIC through an offset that is
+  // reset when the driver clock and ours disagree by more than
+  // MIDI_EVENT_MAX_SKEW_S (first event, idle gaps, drift).
+  static double device_time_s = 0.0;
+  static double anchor_offset_s = 0.0;
+  static int anchored = 0;
+
+  double now = midi_event_queue_now();
+  device_time_s += rtmidi_delta_s;
+  double event_time = device_time_s + anchor_offset_s;
+
+  if (!anchored || event_time > now ||
+      now - event_time > MIDI_EVENT_MAX_SKEW_S) {
+    anchor_offset_s = now - device_time_s;
+    event_time = now;
+    anchored = 1;
+  }
+  return event_time;
+}
+
+unsigned long midi_event_queue_dropped(void) {
+  return atomic_load_explicit(&g_midi_queue_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,54 @@
+/*
+ * midi_event_queue.h
+ *
+ * Lock-free single-producer / single-consumer queue carrying timestamped MIDI
+ * events from the RtMidi input thread to the synth_fft thread.
+ * Producer: MIDI input thread only. Consumer: synth_fft thread only.
+ */
+
+#ifndef MIDI_EVENT_QUEUE_H
+#define MIDI_EVENT_QUEUE_H
+
+#define MIDI_EVENT_QUEUE_SIZE 1024 // Must be a power of two
+#define MIDI_EVENT_MAX_SKEW_S                                                  \
+  0.050 // Re-anchor RtMidi time when it drifts more than this from the clock
+
+typedef enum {
+  MIDI_EVENT_NOTE_ON,
+  MIDI_EVENT_NOTE_OFF,
+  MIDI_EVENT_VIBRATO_RATE,  // value: rate in Hz
+  MIDI_EVENT_ENV_ATTACK,    // value: time in seconds
+  MIDI_EVENT_ENV_DECAY,     // value: time in seconds
+  MIDI_EVENT_ENV_RELEASE    // value: time in seconds
+} MidiEventType;
+
+typedef struct {
+  double time_s; // Event time on CLOCK_MONOTONIC, in seconds
+  MidiEventType type;
+  int note;
+  int velocity;
+  float value;
+} MidiEvent;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns 0 on success, -1 if the queue is full (event dropped and counted)
+int midi_event_queue_push(const MidiEvent *event);
+// Returns 1 if an event was popped, 0 if the queue is empty
+int midi_event_queue_pop(MidiEvent *event);
+
+// CLOCK_MONOTONIC time in seconds
+double midi_event_queue_now(void);
+// Converts an RtMidi delta timestamp into CLOCK_MONOTONIC time. Keeps the
+// relative timing reported by the MIDI driver, producer thread only.
+double midi_event_queue_stamp(double rtmidi_delta_s);
+
+unsigned long midi_event_queue_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIDI_EVENT_QUEUE_H */
@@ -0,0 +1,386 @@
+/*
+ * mix_graph.cpp
+ *
+ * Compiled block mixing graph of the audio callback (see mix_graph.h).
+ */
+
+#include "mix_graph.h"
+#include "audio_telemetry.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Block kernels: one short branch-free loop each, vectorized by the compiler.
+// The gain of frame i is gain + step * i (linear ramp over the chunk).
+template <bool Assign>
+static void mixMono(float *__restrict outL, float *__restrict outR,
+                    const float *__restrict in, float gain, float step,
+                    unsigned int n) {
+  for (unsigned int i = 0; i < n; i++) {
+    const float v = in[i] * (gain + step * (float)i);
+    outL[i] = Assign ? v : outL[i] + v;
+    outR[i] = Assign ? v : outR[i] + v;
+  }
+}
+
+template <bool Assign>
+static void mixStereo(float *__restrict outL, float *__restrict outR,
+                      const float *__restrict inL,
+                      const float *__restrict inR, float gain, float step,
+                      unsigned int n) {
+  for (unsigned int i = 0; i < n; i++) {
+    const float g = gain + step * (float)i;
+    outL[i] = Assign ? inL[i] * g : outL[i] + inL[i] * g;
+    outR[i] = Assign ? inR[i] * g : outR[i] + inR[i] * g;
+  }
+}
+
+static void applyGain(float *__restrict outL, float *__restrict outR,
+                      unsigned int n, float gain, float step) {
+  for (unsigned int i = 0; i < n; i++) {
+    const float g = gain + step * (float)i;
+    outL[i] *= g;
+    outR[i] *= g;
+  }
+}
+
+// Last safety stage: hard clip to [-1, 1], returns the clipped samples
+static unsigned int clipOutput(float *__restrict outL, float *__restrict outR,
+                               unsigned int n) {
+  unsigned int clipped = 0;
+  for (unsigned int i = 0; i < n; i++) {
+    clipped += (fabsf(outL[i]) > 1.0f) + (fabsf(outR[i]) > 1.0f);
+    outL[i] = fminf(fmaxf(outL[i], -1.0f), 1.0f);
+    outR[i] = fminf(fmaxf(outR[i], -1.0f), 1.0f);
+  }
+  return clipped;
+}
+
+MixGraph::MixGraph()
+    : sourceCount(0), returnCount(0), masterInsertCount(0),
+      masterVolume{1.0f, 1.0f}, unity{1.0f, 1.0f}, opCount(0), busCount(1) {
+  for (int b = 0; b < MAX_BUSES; b++) {
+    busLeft[b] = nullptr;
+    busRight[b] = nullptr;
+  }
+  // Graphe vide: silence
+  ops[0] = Op{OP_CLEAR, -1, -1, MASTER_BUS, true, nullptr, nullptr, nullptr,
+              nullptr};
+  ops[1] = Op{OP_OUTPUT, -1, -1, MASTER_BUS, false, nullptr, nullptr, nullptr,
+              nullptr};
+  opCount = 2;
+}
+
+MixGraph::~MixGraph() {
+  for (int b = 1; b < MAX_BUSES; b++) {
+    delete[] busLeft[b];
+    delete[] busRight[b];
+  }
+}
+
+int MixGraph::addSource(const char *name) {
+  if (sourceCount >= MAX_SOURCES)
+    return -1;
+  Source &s = sources[sourceCount];
+  s.name = name;
+  s.input = nullptr;
+  s.gain = Gain{1.0f, 1.0f};
+  for (int r = 0; r < MAX_RETURNS; r++) {
+    s.sendLevel[r] = Gain{0.0f, 0.0f};
+    s.hasSend[r] = false;
+  }
+  s.insertCount = 0;
+  return sourceCount++;
+}
+
+int MixGraph::addReturn(const char *name) {
+  if (returnCount >= MAX_RETURNS)
+    return -1;
+  Return &r = returns[returnCount];
+  r.name = name;
+  r.gain = Gain{1.0f, 1.0f};
+  r.enabled = true;
+  r.insertCount = 0;
+  return returnCount++;
+}
+
+bool MixGraph::addSend(int source, int ret, float level) {
+  if (source < 0 || source >= sourceCount || ret < 0 || ret >= returnCount)
+    return false;
+  sources[source].hasSend[ret] = true;
+  sources[source].sendLevel[ret] = Gain{level, level};
+  return true;
+}
+
+bool MixGraph::addSourceInsert(int source, MixProcessor *processor) {
+  if (source < 0 || source >= sourceCount || !processor ||
+      sources[source].insertCount >= MAX_INSERTS)
+    return false;
+  sources[source].inserts[sources[source].insertCount++] = processor;
+  return true;
+}
+
+bool MixGraph::addReturnInsert(int ret, MixProcessor *processor) {
+  if (ret < 0 || ret >= returnCount || !processor ||
+      returns[ret].insertCount >= MAX_INSERTS)
+    return false;
+  returns[ret].inserts[returns[ret].insertCount++] = processor;
+  return true;
+}
+
+bool MixGraph::addMasterInsert(MixProcessor *processor) {
+  if (!processor || masterInsertCount >= MAX_INSERTS)
+    return false;
+  masterInserts[masterInsertCount++] = processor;
+  return true;
+}
+
+void MixGraph::setSendLevel(int source, int ret, float start, float end) {
+  sources[source].sendLevel[ret] = Gain{start, end};
+}
+
+void MixGraph::addOp(Op *list, int *count, const Op &op, bool *fits) const {
+  if (*count >= MAX_OPS) {
+    *fits = false;
+    return;
+  }
+  list[(*count)++] = op;
+}
+
+bool MixGraph::compile() {
+  Op plan[MAX_OPS];
+  int count = 0;
+  bool fits = true;
+  int bus = 1;
+  int busOfSource[MAX_SOURCES];
+  int busOfReturn[MAX_RETURNS];
+
+  // 1. Sources avec inserts: rendues sur leur propre bus (post-fader)
+  for (int s = 0; s < sourceCount; s++) {
+    const Source &src = sources[s];
+    if (src.insertCount == 0) {
+      busOfSource[s] = MASTER_BUS;
+      continue;
+    }
+    busOfSource[s] = bus++;
+    addOp(plan, &count,
+          Op{OP_SOURCE, s, -1, busOfSource[s], true, &src.gain, &unity,
+             nullptr, nullptr},
+          &fits);
+    for (int i = 0; i < src.insertCount; i++)
+      addOp(plan, &count,
+            Op{OP_INSERT, -1, -1, busOfSource[s], false, nullptr, nullptr,
+               nullptr, src.inserts[i]},
+            &fits);
+  }
+
+  // 2. Retours: somme des sends puis inserts
+  for (int r = 0; r < returnCount; r++) {
+    const Return &ret = returns[r];
+    busOfReturn[r] = bus++;
+    bool first = true;
+    for (int s = 0; s < sourceCount; s++) {
+      const Source &src = sources[s];
+      if (!src.hasSend[r])
+        continue;
+      if (busOfSource[s] == MASTER_BUS) {
+        addOp(plan, &count,
+              Op{OP_SOURCE, s, -1, busOfReturn[r], first, &src.gain,
+                 &src.sendLevel[r], &ret.enabled, nullptr},
+              &fits);
+      } else {
+        addOp(plan, &count,
+              Op{OP_BUS, -1, busOfSource[s], busOfReturn[r], first,
+                 &src.sendLevel[r], &unity, &ret.enabled, nullptr},
+              &fits);
+      }
+      first = false;
+    }
+    if (first)
+      addOp(plan, &count,
+            Op{OP_CLEAR, -1, -1, busOfReturn[r], true, nullptr, nullptr,
+               &ret.enabled, nullptr},
+            &fits);
+    for (int i = 0; i < ret.insertCount; i++)
+      addOp(plan, &count,
+            Op{OP_INSERT, -1, -1, busOfReturn[r], false, nullptr, nullptr,
+               &ret.enabled, ret.inserts[i]},
+            &fits);
+  }
+
+  // 3. Master: sources, retours, volume, inserts et écrêtage de sécurité
+  bool first = true;
+  for (int s = 0; s < sourceCount; s++) {
+    if (busOfSource[s] == MASTER_BUS) {
+      addOp(plan, &count,
+            Op{OP_SOURCE, s, -1, MASTER_BUS, first, &sources[s].gain, &unity,
+               nullptr, nullptr},
+            &fits);
+    } else {
+      addOp(plan, &count,
+            Op{OP_BUS, -1, busOfSource[s], MASTER_BUS, first, &unity, &unity,
+               nullptr, nullptr},
+            &fits);
+    }
+    first = false;
+  }
+  for (int r = 0; r < returnCount; r++) {
+    addOp(plan, &count,
+          Op{OP_BUS, -1, busOfReturn[r], MASTER_BUS, first, &returns[r].gain,
+             &unity, &returns[r].enabled, nullptr},
+          &fits);
+    first = false;
+  }
+  if (first)
+    addOp(plan, &count,
+          Op{OP_CLEAR, -1, -1, MASTER_BUS, true, nullptr, nullptr, nullptr,
+             nullptr},
+          &fits);
+  addOp(plan, &count,
+        Op{OP_VOLUME, -1, -1, MASTER_BUS, false, &masterVolume, &unity,
+           nullptr, nullptr},
+        &fits);
+  for (int i = 0; i < masterInsertCount; i++)
+    addOp(plan, &count,
+          Op{OP_INSERT, -1, -1, MASTER_BUS, false, nullptr, nullptr, nullptr,
+             masterInserts[i]},
+          &fits);
+  addOp(plan, &count,
+        Op{OP_OUTPUT, -1, -1, MASTER_BUS, false, nullptr, nullptr, nullptr,
+           nullptr},
+        &fits);
+
+  if (!fits) {
+    printf("[MIX] Graphe trop grand (%d opérations max), plan inchangé\n",
+           MAX_OPS);
+    return false;
+  }
+
+  for (int b = 1; b < bus; b++) {
+    if (!busLeft[b]) {
+      busLeft[b] = new float[AUDIO_BUFFER_SIZE_MAX]();
+      busRight[b] = new float[AUDIO_BUFFER_SIZE_MAX]();
+    }
+  }
+  for (int s = 0; s < sourceCount; s++)
+    sourceBus[s] = busOfSource[s];
+  for (int r = 0; r < returnCount; r++)
+    returnBus[r] = busOfReturn[r];
+  busCount = bus;
+  std::memcpy(ops, plan, count * sizeof(Op));
+  opCount = count;
+  return true;
+}
+
+const char *MixGraph::busName(int bus) const {
+  if (bus == MASTER_BUS)
+    return "master";
+  for (int s = 0; s < sourceCount; s++)
+    if (sourceBus[s] == bus)
+      return sources[s].name;
+  for (int r = 0; r < returnCount; r++)
+    if (returnBus[r] == bus)
+      return returns[r].name;
+  return "?";
+}
+
+void MixGraph::printPlan() const {
+  printf("[MIX] Plan de mixage: %d opérations, %d bus\n", opCount, busCount);
+  for (int i = 0; i < opCount; i++) {
+    const Op &op = ops[i];
+    const char *verb = op.assign ? "=" : "+=";
+    switch (op.type) {
+    case OP_SOURCE:
+      printf("[MIX]  %2d  %s %s source %s\n", i, busName(op.to), verb,
+             sources[op.source].name);
+      break;
+    case OP_BUS:
+      printf("[MIX]  %2d  %s %s bus %s\n", i, busName(op.to), verb,
+             busName(op.from));
+      break;
+    case OP_INSERT:
+      printf("[MIX]  %2d  insert sur %s\n", i, busName(op.to));
+      break;
+    case OP_CLEAR:
+      printf("[MIX]  %2d  %s = 0\n", i, busName(op.to));
+      break;
+    case OP_VOLUME:
+      printf("[MIX]  %2d  volume master\n", i);
+      break;
+    case OP_OUTPUT:
+      printf("[MIX]  %2d  écrêtage [-1, 1]\n", i);
+      break;
+    }
+  }
+}
+
+void MixGraph::process(float *outL, float *outR, unsigned int nFrames) {
+  busLeft[MASTER_BUS] = outL;
+  busRight[MASTER_BUS] = outR;
+
+  for (int i = 0; i < opCount; i++) {
+    const Op &op = ops[i];
+    float *toL = busLeft[op.to];
+    float *toR = busRight[op.to];
+    if (op.enabled && !*op.enabled) {
+      // Retour désactivé: son bus n'est plus lu, sauf le master à initialiser
+      if (op.assign && op.to == MASTER_BUS) {
+        std::memset(toL, 0, nFrames * sizeof(float));
+        std::memset(toR, 0, nFrames * sizeof(float));
+      }
+      continue;
+    }
+
+    switch (op.type) {
+    case OP_SOURCE:
+    case OP_BUS: {
+      const float gain = op.gain->start * op.gain2->start;
+      const float step =
+          (op.gain->end * op.gain2->end - gain) / (float)nFrames;
+      const float *in = (op.type == OP_SOURCE) ? sources[op.source].input
+                                               : busLeft[op.from];
+      if (!in || (gain == 0.0f && step == 0.0f)) {
+        // Rien à ajouter, mais une première écriture doit initialiser le bus
+        if (op.assign) {
+          std::memset(toL, 0, nFrames * sizeof(float));
+          std::memset(toR, 0, nFrames * sizeof(float));
+        }
+        break;
+      }
+      if (op.type == OP_SOURCE) {
+        if (op.assign)
+          mixMono<true>(toL, toR, in, gain, step, nFrames);
+        else
+          mixMono<false>(toL, toR, in, gain, step, nFrames);
+      } else {
+        if (op.assign)
+          mixStereo<true>(toL, toR, in, busRight[op.from], gain, step,
+                          nFrames);
+        else
+          mixStereo<false>(toL, toR, in, busRight[op.from], gain, step,
+                           nFrames);
+      }
+      break;
+    }
+    case OP_INSERT:
+      if (op.processor->isActive())
+        op.processor->process(toL, toR, nFrames);
+      break;
+    case OP_CLEAR:
+      std::memset(toL, 0, nFrames * sizeof(float));
+      std::memset(toR, 0, nFrames * sizeof(float));
+      break;
+    case OP_VOLUME:
+      if (op.gain->start != 1.0f || op.gain->end != 1.0f)
+        applyGain(toL, toR, nFrames, op.gain->start,
+                  (op.gain->end - op.gain->start) / (float)nFrames);
+      break;
+    case OP_OUTPUT: {
+      const unsigned int clipped = clipOutput(toL, toR, nFrames);
+      if (clipped)
+        audio_telemetry_clipped(clipped);
+      break;
+    }
+    }
+  }
+}
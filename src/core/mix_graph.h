@@ -0,0 +1,155 @@
+/*
+ * mix_graph.h
+ *
+ * Block-based mixing graph of the audio callback: mono sources with a gain,
+ * post-fader sends to stereo return buses, insert chains on sources and
+ * returns, then master volume, master inserts (the lookahead limiter last) and
+ * a safety clip whose clipped samples go to the telemetry.
+ *
+ * The topology is declared up front and compile() turns it into a flat list
+ * of block operations (mix, insert, clear, volume, output). process() only
+ * walks that list: no allocation, no lock, and each operation is a short loop
+ * over the chunk, so adding an effect adds an operation instead of work in a
+ * shared per-sample loop. Buses are preallocated for AUDIO_BUFFER_SIZE_MAX
+ * frames.
+ *
+ * Gains are given for the start and the end of each chunk and ramp linearly
+ * per sample in between, so control-rate updates do not step.
+ *
+ * Threading: structure (add*, compile) while the callback is not running;
+ * inputs, gains and enables from the audio thread, once per chunk.
+ */
+
+#ifndef MIX_GRAPH_H
+#define MIX_GRAPH_H
+
+#include "config.h"
+
+// In-place stereo block effect, inserted on a source, a return or the master
+class MixProcessor {
+public:
+  virtual ~MixProcessor() {}
+  // Inactive processors are skipped for the chunk (bypass)
+  virtual bool isActive() const { return true; }
+  virtual void process(float *left, float *right, unsigned int nFrames) = 0;
+};
+
+class MixGraph {
+public:
+  static const int MAX_SOURCES = 8;
+  static const int MAX_RETURNS = 4;
+  static const int MAX_INSERTS = 4; // Per source, return or master
+  static const int MAX_OPS = 64;
+
+  MixGraph();
+  ~MixGraph();
+
+  // Structure (not from the audio thread). Indices returned, -1 when full.
+  int addSource(const char *name);
+  int addReturn(const char *name);
+  bool addSend(int source, int ret, float level = 0.0f);
+  bool addSourceInsert(int source, MixProcessor *processor);
+  bool addReturnInsert(int ret, MixProcessor *processor);
+  bool addMasterInsert(MixProcessor *processor);
+  // Builds the execution list; false (and the previous list kept) if the
+  // graph does not fit in MAX_OPS
+  bool compile();
+  void printPlan() const;
+
+  // Audio thread, before process(): nullptr input = silent source. Gains
+  // ramp from start (first frame of the chunk) to end (frame after its last)
+  void setSourceInput(int source, const float *input) {
+    sources[source].input = input;
+  }
+  void setSourceGain(int source, float start, float end) {
+    sources[source].gain = Gain{start, end};
+  }
+  void setSendLevel(int source, int ret, float start, float end);
+  void setReturnGain(int ret, float start, float end) {
+    returns[ret].gain = Gain{start, end};
+  }
+  // A disabled return is neither fed, processed nor mixed
+  void setReturnEnabled(int ret, bool enabled) {
+    returns[ret].enabled = enabled;
+  }
+  void setMasterVolume(float start, float end) {
+    masterVolume = Gain{start, end};
+  }
+
+  // Runs the execution list for nFrames (<= AUDIO_BUFFER_SIZE_MAX) into the
+  // non-interleaved outputs, clipped to [-1, 1]
+  void process(float *outL, float *outR, unsigned int nFrames);
+
+private:
+  enum OpType {
+    OP_SOURCE, // Mono source * gain -> stereo bus
+    OP_BUS,    // Stereo bus * gain -> stereo bus
+    OP_INSERT, // Processor on a bus
+    OP_CLEAR,  // Bus without any input
+    OP_VOLUME, // Master volume, before the master inserts
+    OP_OUTPUT  // Safety clip to [-1, 1]
+  };
+
+  // Gain over the chunk being processed
+  struct Gain {
+    float start;
+    float end;
+  };
+
+  struct Op {
+    OpType type;
+    int source;             // OP_SOURCE
+    int from;               // OP_BUS: source bus
+    int to;                 // Destination or processed bus
+    bool assign;            // First write to the bus: store instead of add
+    const Gain *gain;       // Effective gain: *gain * *gain2
+    const Gain *gain2;
+    const bool *enabled;    // Skipped when false (nullptr: always)
+    MixProcessor *processor; // OP_INSERT
+  };
+
+  struct Source {
+    const char *name;
+    const float *input;
+    Gain gain;
+    Gain sendLevel[MAX_RETURNS];
+    bool hasSend[MAX_RETURNS];
+    MixProcessor *inserts[MAX_INSERTS];
+    int insertCount;
+  };
+
+  struct Return {
+    const char *name;
+    Gain gain;
+    bool enabled;
+    MixProcessor *inserts[MAX_INSERTS];
+    int insertCount;
+  };
+
+  // Bus 0 is the master (the output buffers), then one bus per source with
+  // inserts and one per return
+  static const int MAX_BUSES = 1 + MAX_RETURNS + MAX_SOURCES;
+  static const int MASTER_BUS = 0;
+
+  void addOp(Op *list, int *count, const Op &op, bool *fits) const;
+  const char *busName(int bus) const;
+
+  Source sources[MAX_SOURCES];
+  int sourceCount;
+  Return returns[MAX_RETURNS];
+  int returnCount;
+  MixProcessor *masterInserts[MAX_INSERTS];
+  int masterInsertCount;
+  Gain masterVolume;
+  const Gain unity;
+
+  Op ops[MAX_OPS];
+  int opCount;
+  int sourceBus[MAX_SOURCES]; // Bus of each source (master if no insert)
+  int returnBus[MAX_RETURNS];
+  int busCount;
+  float *busLeft[MAX_BUSES]; // Buses 1..: preallocated buffers
+  float *busRight[MAX_BUSES];
+};
+
+#endif // MIX_GRAPH_H
@@ -4,9 +4,11 @@
 #include "audio_c_api.h"
 #include "config.h"
 #include "context.h"
+#include "denormals.h"
 #include "display.h"
 #include "dmx.h"
 #include "error.h"
+#include "scanner_map.h"
 #include "synth.h"
 #include "udp.h"
 
@@ -17,6 +19,7 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,6 +40,12 @@ static void WaitForDMXColorUpdate(DMXContext *ctx) {
 }
 */
 
+// Shown by readers until the first line is published (silence)
+static const uint8_t black_line[CIS_MAX_PIXELS_NB];
+
+#define IMAGE_SLOT_BITS 5
+#define IMAGE_SLOT_MASK ((1u << IMAGE_SLOT_BITS) - 1)
+
 void initDoubleBuffer(DoubleBuffer *db) {
   if (pthread_mutex_init(&db->mutex, NULL) != 0) {
     fprintf(stderr, "Error: Mutex initialization failed\n");
@@ -47,37 +56,22 @@ void initDoubleBuffer(DoubleBuffer *db) {
     exit(EXIT_FAILURE);
   }
 
-  db->activeBuffer_R = (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-  db->activeBuffer_G = (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-  db->activeBuffer_B = (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-
-  db->processingBuffer_R =
-      (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-  db->processingBuffer_G =
-      (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-  db->processingBuffer_B =
-      (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-
-  // Allocate persistent image buffers for audio continuity
-  db->lastValidImage_R = (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-  db->lastValidImage_G = (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-  db->lastValidImage_B = (uint8_t *)malloc(CIS_MAX_PIXELS_NB * sizeof(uint8_t));
-
-  if (!db->activeBuffer_R || !db->activeBuffer_G || !db->activeBuffer_B ||
-      !db->processingBuffer_R || !db->processingBuffer_G ||
-      !db->processingBuffer_B || !db->lastValidImage_R ||
-      !db->lastValidImage_G || !db->lastValidImage_B) {
+  db->slot_memory = (uint8_t *)calloc((size_t)IMAGE_LINE_SLOTS * 3,
+                                      CIS_MAX_PIXELS_NB * sizeof(uint8_t));
+  if (!db->slot_memory) {
     fprintf(stderr, "Error: Allocation of image buffers failed\n");
     exit(EXIT_FAILURE);
   }
+  for (int i = 0; i < IMAGE_LINE_SLOTS; i++) {
+    uint8_t *line = db->slot_memory + (size_t)i * 3 * CIS_MAX_PIXELS_NB;
+    db->slots[i].R = line;
+    db->slots[i].G = line + CIS_MAX_PIXELS_NB;
+    db->slots[i].B = line + 2 * CIS_MAX_PIXELS_NB;
+    __atomic_store_n(&db->slots[i].readers, 0, __ATOMIC_RELAXED);
+    db->slots[i].writer_owned = 0;
+  }
 
-  // Initialize persistent image with black (zero)
-  memset(db->lastValidImage_R, 0, CIS_MAX_PIXELS_NB);
-  memset(db->lastValidImage_G, 0, CIS_MAX_PIXELS_NB);
-  memset(db->lastValidImage_B, 0, CIS_MAX_PIXELS_NB);
-
-  db->dataReady = 0;
-  db->lastValidImageExists = 0;
+  __atomic_store_n(&db->latest, 0, __ATOMIC_RELEASE);
   db->udp_frames_received = 0;
   db->audio_frames_processed = 0;
   db->last_udp_frame_time = time(NULL);
@@ -85,90 +79,181 @@ void initDoubleBuffer(DoubleBuffer *db) {
 
 void cleanupDoubleBuffer(DoubleBuffer *db) {
   if (db) {
-    free(db->activeBuffer_R);
-    free(db->activeBuffer_G);
-    free(db->activeBuffer_B);
-    free(db->processingBuffer_R);
-    free(db->processingBuffer_G);
-    free(db->processingBuffer_B);
-    free(db->lastValidImage_R);
-    free(db->lastValidImage_G);
-    free(db->lastValidImage_B);
-
-    db->activeBuffer_R = NULL;
-    db->activeBuffer_G = NULL;
-    db->activeBuffer_B = NULL;
-    db->processingBuffer_R = NULL;
-    db->processingBuffer_G = NULL;
-    db->processingBuffer_B = NULL;
-    db->lastValidImage_R = NULL;
-    db->lastValidImage_G = NULL;
-    db->lastValidImage_B = NULL;
+    free(db->slot_memory);
+    db->slot_memory = NULL;
+    for (int i = 0; i < IMAGE_LINE_SLOTS; i++) {
+      db->slots[i].R = db->slots[i].G = db->slots[i].B = NULL;
+    }
 
     pthread_mutex_destroy(&db->mutex);
     pthread_cond_destroy(&db->cond);
   }
 }
 
-void swapBuffers(DoubleBuffer *db) {
-  uint8_t *temp = NULL;
-
-  temp = db->activeBuffer_R;
-  db->activeBuffer_R = db->processingBuffer_R;
-  db->processingBuffer_R = temp;
-
-  temp = db->activeBuffer_G;
-  db->activeBuffer_G = db->processingBuffer_G;
-  db->processingBuffer_G = temp;
+/**
+ * @brief Reserve a slot to assemble a line in
+ * @param db DoubleBuffer structure
+ * @return Slot index, -1 if every slot is pinned or already reserved
+ * @note Single writer: must only be called from the UDP thread
+ */
+int reserveImageSlot(DoubleBuffer *db) {
+  uint32_t latest = __atomic_load_n(&db->latest, __ATOMIC_SEQ_CST);
+  for (int i = 0; i < IMAGE_LINE_SLOTS; i++) {
+    if (db->slots[i].writer_owned ||
+        (latest != 0 && (int)(latest & IMAGE_SLOT_MASK) == i)) {
+      continue;
+    }
+    // Pairs with the pin in acquireImageLine(): a reader either sees a newer
+    // 'latest' and unpins, or its pin is seen here
+    if (__atomic_load_n(&db->slots[i].readers, __ATOMIC_SEQ_CST) == 0) {
+      db->slots[i].writer_owned = 1;
+      return i;
+    }
+  }
+  return -1;
+}
 
-  temp = db->activeBuffer_B;
-  db->activeBuffer_B = db->processingBuffer_B;
-  db->processingBuffer_B = temp;
+/**
+ * @brief Give back a reserved slot whose line was not published
+ * @param db DoubleBuffer structure
+ * @param slot Slot returned by reserveImageSlot()
+ */
+void releaseImageSlot(DoubleBuffer *db, int slot) {
+  if (slot >= 0) {
+    db->slots[slot].writer_owned = 0;
+  }
 }
 
 /**
- * @brief Update the persistent image buffer with latest valid image
+ * @brief Publish an assembled slot as the newest line and wake all readers
  * @param db DoubleBuffer structure
- * @note Mutex must be locked before calling this function
+ * @param slot Slot returned by reserveImageSlot(), complete
+ * @note Single writer: must only be called from the UDP thread
  */
-void updateLastValidImage(DoubleBuffer *db) {
-  // Copy processing buffer to persistent image buffer
-  memcpy(db->lastValidImage_R, db->processingBuffer_R, CIS_MAX_PIXELS_NB);
-  memcpy(db->lastValidImage_G, db->processingBuffer_G, CIS_MAX_PIXELS_NB);
-  memcpy(db->lastValidImage_B, db->processingBuffer_B, CIS_MAX_PIXELS_NB);
+void publishImageSlot(DoubleBuffer *db, int slot) {
+  uint32_t version =
+      (__atomic_load_n(&db->latest, __ATOMIC_RELAXED) >> IMAGE_SLOT_BITS) + 1;
+  if ((version & ((1u << (32 - IMAGE_SLOT_BITS)) - 1)) == 0) {
+    version = 1; // 0 is reserved for "nothing published"
+  }
+
+  // The slot stays protected as the newest line, then by its readers' pins
+  db->slots[slot].writer_owned = 0;
+  __atomic_store_n(&db->latest, (version << IMAGE_SLOT_BITS) | (uint32_t)slot,
+                   __ATOMIC_SEQ_CST);
 
-  db->lastValidImageExists = 1;
   db->udp_frames_received++;
   db->last_udp_frame_time = time(NULL);
 
-  // Debug logs removed for production use
+  // One broadcast reaches every consumer; the mutex only orders the wake-up
+  // against a reader that is about to sleep
+  pthread_mutex_lock(&db->mutex);
+  pthread_cond_broadcast(&db->cond);
+  pthread_mutex_unlock(&db->mutex);
 }
 
 /**
- * @brief Get the last valid image for audio processing (thread-safe)
+ * @brief Version of the newest published line (0 if none yet)
  * @param db DoubleBuffer structure
- * @param out_R Output buffer for red channel
- * @param out_G Output buffer for green channel
- * @param out_B Output buffer for blue channel
+ * @return Published line version
  */
-void getLastValidImageForAudio(DoubleBuffer *db, uint8_t *out_R, uint8_t *out_G,
-                               uint8_t *out_B) {
-  pthread_mutex_lock(&db->mutex);
+uint32_t getImageVersion(DoubleBuffer *db) {
+  return __atomic_load_n(&db->latest, __ATOMIC_ACQUIRE) >> IMAGE_SLOT_BITS;
+}
 
-  if (db->lastValidImageExists) {
-    memcpy(out_R, db->lastValidImage_R, CIS_MAX_PIXELS_NB);
-    memcpy(out_G, db->lastValidImage_G, CIS_MAX_PIXELS_NB);
-    memcpy(out_B, db->lastValidImage_B, CIS_MAX_PIXELS_NB);
-    db->audio_frames_processed++;
-  } else {
-    // If no valid image exists, use black (silence)
-    memset(out_R, 0, CIS_MAX_PIXELS_NB);
-    memset(out_G, 0, CIS_MAX_PIXELS_NB);
-    memset(out_B, 0, CIS_MAX_PIXELS_NB);
-    // Debug log removed for production use
+void initImageLineRef(ImageLineRef *ref) {
+  ref->R = ref->G = ref->B = black_line;
+  ref->version = 0;
+  ref->slot = -1;
+}
+
+void releaseImageLine(DoubleBuffer *db, ImageLineRef *ref) {
+  if (ref->slot >= 0) {
+    // Release: our reads of the line complete before the writer reuses it
+    __atomic_fetch_sub(&db->slots[ref->slot].readers, 1, __ATOMIC_RELEASE);
+  }
+  initImageLineRef(ref);
+}
+
+/**
+ * @brief Pin the newest complete line without locking
+ * @param db DoubleBuffer structure
+ * @param ref Line held by the caller, moved to the newest one
+ * @return Version of the pinned line (0 if nothing was published yet)
+ * @note The line is read in place through ref->R/G/B until the next call
+ */
+uint32_t acquireImageLine(DoubleBuffer *db, ImageLineRef *ref) {
+  for (;;) {
+    uint32_t latest = __atomic_load_n(&db->latest, __ATOMIC_SEQ_CST);
+    uint32_t version = latest >> IMAGE_SLOT_BITS;
+    if (version == ref->version) {
+      return version; // Already holding it (or still nothing published)
+    }
+    int slot = (int)(latest & IMAGE_SLOT_MASK);
+
+    __atomic_fetch_add(&db->slots[slot].readers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&db->latest, __ATOMIC_SEQ_CST) != latest) {
+      // Superseded before the pin: the writer may already reuse the slot
+      __atomic_fetch_sub(&db->slots[slot].readers, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    releaseImageLine(db, ref);
+    ref->R = db->slots[slot].R;
+    ref->G = db->slots[slot].G;
+    ref->B = db->slots[slot].B;
+    ref->version = version;
+    ref->slot = slot;
+    return version;
+  }
+}
+
+/**
+ * @brief Wait until a line newer than last_version is published
+ * @param db DoubleBuffer structure
+ * @param last_version Version the caller already consumed
+ * @param timeout_ms Maximum wait in milliseconds
+ * @return Newest version (equal to last_version on timeout)
+ */
+uint32_t waitForNewImage(DoubleBuffer *db, uint32_t last_version,
+                         int timeout_ms) {
+  uint32_t version = getImageVersion(db);
+  if (version != last_version) {
+    return version;
   }
 
+  struct timespec timeout;
+  clock_gettime(CLOCK_REALTIME, &timeout);
+  timeout.tv_sec += timeout_ms / 1000;
+  timeout.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+  if (timeout.tv_nsec >= 1000000000L) {
+    timeout.tv_sec += 1;
+    timeout.tv_nsec -= 1000000000L;
+  }
+
+  pthread_mutex_lock(&db->mutex);
+  while ((version = getImageVersion(db)) == last_version) {
+    if (pthread_cond_timedwait(&db->cond, &db->mutex, &timeout) ==
+        ETIMEDOUT) {
+      version = getImageVersion(db);
+      break;
+    }
+  }
   pthread_mutex_unlock(&db->mutex);
+  return version;
+}
+
+/**
+ * @brief Get the last valid image for audio processing (lock-free)
+ * @param db DoubleBuffer structure
+ * @param ref Line held by the audio thread, moved to the newest one
+ * @return Version of the pinned line
+ * @note Black (silence) until the first line has been published
+ */
+uint32_t getLastValidImageForAudio(DoubleBuffer *db, ImageLineRef *ref) {
+  uint32_t version = acquireImageLine(db, ref);
+  __atomic_fetch_add(&db->audio_frames_processed, 1, __ATOMIC_RELAXED);
+  return version;
 }
 
 /**
@@ -177,107 +262,510 @@ void getLastValidImageForAudio(DoubleBuffer *db, uint8_t *out_R, uint8_t *out_G,
  * @return 1 if valid image exists, 0 otherwise
  */
 int hasValidImageForAudio(DoubleBuffer *db) {
-  pthread_mutex_lock(&db->mutex);
-  int exists = db->lastValidImageExists;
-  pthread_mutex_unlock(&db->mutex);
-  return exists;
+  return getImageVersion(db) != 0;
 }
 
 /*------------------------------------------------------------------------------
     Thread Implementations
 ------------------------------------------------------------------------------*/
-// Assume that Context, DoubleBuffer, packet_Image, UDP_MAX_NB_PACKET_PER_LINE,
-// IMAGE_DATA_HEADER and swapBuffers() are defined elsewhere.
-// It is also assumed that the Context structure now contains a boolean field
+// It is assumed that the Context structure contains a boolean field
 // 'enableImageTransform' to toggle image transformation at runtime.
 
-void *udpThread(void *arg) {
-  Context *ctx = (Context *)arg;
-  DoubleBuffer *db = ctx->doubleBuffer;
-  int s = ctx->socket;
-  struct sockaddr_in *si_other = ctx->si_other;
-  socklen_t slen = sizeof(*si_other);
-  ssize_t recv_len;
-  struct packet_Image packet;
-
-  // Local variables for reassembling line fragments
-  uint32_t currentLineId = 0;
-  int *receivedFragments =
-      (int *)calloc(UDP_MAX_NB_PACKET_PER_LINE, sizeof(int));
-  if (receivedFragments == NULL) {
-    perror("Error allocating receivedFragments");
-    exit(EXIT_FAILURE);
+// Reassembly table: lines base .. base + UDP_ASSEMBLY_LINES - 1, keyed by
+// line_id. It holds the lines still open for reordering
+// (UDP_REORDER_DEPTH_LINES behind the newest) and those the next batch may
+// already contain.
+#define UDP_ASSEMBLY_LINES                                                     \
+  (UDP_RECV_BATCH / UDP_MAX_NB_PACKET_PER_LINE + 2 + UDP_REORDER_DEPTH_LINES)
+
+// A line_id this far from the table is a sender restart, not a late or
+// skipped line
+#define UDP_LINE_RESTART_DISTANCE (1024)
+
+#if UDP_MAX_NB_PACKET_PER_LINE > 32
+#error "UDP_MAX_NB_PACKET_PER_LINE must fit in the 32-bit fragment mask."
+#endif
+// Table + newest line + one pinned line per reader of the ring (a reader
+// pins the new line, always the newest, before unpinning the old one)
+#if IMAGE_LINE_SLOTS < UDP_ASSEMBLY_LINES + 1 + IMAGE_LINE_READERS
+#error "IMAGE_LINE_SLOTS is too small for UDP_RECV_BATCH."
+#endif
+
+typedef struct {
+  int slot;                // Reserved ring slot, -1: none yet
+  uint32_t received;       // Bitmask of fragment_id
+  uint32_t count;          // Fragments received
+  uint8_t total_fragments; // 0: no fragment yet
+  uint8_t highest_fragment;
+  uint16_t fragment_size;
+} LineAssembly;
+
+typedef struct UdpReceiverState UdpReceiverState;
+
+// Lines of one scanner, in its own ring
+typedef struct {
+  DoubleBuffer *db;
+  int source;
+  UdpReceiverState *rx; // Receive thread of the scanner
+  LineAssembly lines[UDP_ASSEMBLY_LINES];
+  uint32_t base;        // line_id of lines[0]
+  uint32_t newest_line; // Newest line_id with a fragment
+  int has_base;
+  int previous_slot; // Last published line, -1: none
+
+  // Head of the stream (newest fragment), used to target the next batch
+  uint32_t next_line;
+  uint8_t next_fragment;
+  uint8_t total_fragments;
+  uint16_t fragment_size;
+} LineReassembly;
+
+// Receive thread: batch of datagrams, and the tables of the scanners steered
+// to its socket
+struct UdpReceiverState {
+  UdpRecvBatch *batch;
+  LineReassembly *sources[UDP_MAX_SOURCES]; // NULL: served by another thread
+  LineReassembly *head; // Scanner of the last datagram, targets the next batch
+
+  // Where each datagram of the batch was received (slot -1: in its packet)
+  struct {
+    LineReassembly *table;
+    uint32_t line_id;
+    uint8_t fragment_id;
+    uint16_t fragment_size;
+    int slot;
+  } expected[UDP_RECV_BATCH];
+
+  // Datagrams of the batch not processed yet
+  int pending_from;
+  int pending_count;
+};
+
+static void reassembly_reset_line(LineAssembly *line) {
+  line->slot = -1;
+  line->received = 0;
+  line->count = 0;
+  line->total_fragments = 0;
+  line->highest_fragment = 0;
+  line->fragment_size = 0;
+}
+
+static int reassembly_slot(LineReassembly *r, uint32_t d) {
+  LineAssembly *line = &r->lines[d];
+  if (line->slot < 0) {
+    line->slot = reserveImageSlot(r->db);
   }
-  uint32_t fragmentCount = 0;
+  return line->slot;
+}
 
-  while (ctx->running) {
-    recv_len = recvfrom(s, &packet, sizeof(packet), 0,
-                        (struct sockaddr *)si_other, &slen);
-    if (recv_len < 0) {
-      continue;
+// Before the slot is written by anything else than its own fragments (fill)
+// or given back: the pending datagrams received in it go back to their
+// packet
+static void reassembly_detach(LineReassembly *r, int slot) {
+  UdpReceiverState *rx = r->rx;
+  for (int i = rx->pending_from; i < rx->pending_count; i++) {
+    if (rx->expected[i].table == r && rx->expected[i].slot == slot) {
+      udp_recv_batch_gather(rx->batch, i);
+      rx->expected[i].slot = -1;
+    }
+  }
+}
+
+static void reassembly_publish(LineReassembly *r, Context *ctx,
+                               const LineAssembly *line) {
+  int slot = line->slot;
+#if ENABLE_IMAGE_TRANSFORM
+  int lineSize = line->total_fragments * line->fragment_size;
+  if (ctx->enableImageTransform) {
+    uint8_t *line_R = r->db->slots[slot].R;
+    uint8_t *line_G = r->db->slots[slot].G;
+    uint8_t *line_B = r->db->slots[slot].B;
+    for (int i = 0; i < lineSize; i++) {
+      // Retrieve original RGB values
+      unsigned char red = line_R[i];
+      unsigned char green = line_G[i];
+      unsigned char blue = line_B[i];
+
+      // Step 2: Calculate perceived luminance: Y = 0.299 * r + 0.587 * g +
+      // 0.114 * b
+      double luminance = 0.299 * red + 0.587 * green + 0.114 * blue;
+
+      // Step 3: Inversion and normalization:
+      // Y_inv = 255 - Y, then I = Y_inv / 255.
+      double invertedLuminance = 255.0 - luminance;
+      double intensity = invertedLuminance / 255.0;
+
+      // Step 4: Gamma correction: I_corr = intensity^(IMAGE_GAMMA)
+      double correctedIntensity = pow(intensity, IMAGE_GAMMA);
+
+      // Step 5: Modulate original RGB channels by the corrected intensity.
+      line_R[i] = (uint8_t)round(red * correctedIntensity);
+      line_G[i] = (uint8_t)round(green * correctedIntensity);
+      line_B[i] = (uint8_t)round(blue * correctedIntensity);
     }
+  }
+#endif
+  publishImageSlot(r->db, slot); // Published by index, wakes every consumer
+  r->previous_slot = slot;
+  if (ctx->scannerMap) {
+    scanner_map_line_published(ctx->scannerMap, r->source);
+  }
+}
 
-    if (packet.type != IMAGE_DATA_HEADER) {
+// Missing fragments taken from the previous line (black before the first)
+static void reassembly_fill(LineReassembly *r, const LineAssembly *line) {
+  const ImageSlot *dst = &r->db->slots[line->slot];
+  const ImageSlot *src =
+      r->previous_slot >= 0 ? &r->db->slots[r->previous_slot] : NULL;
+
+  for (int f = 0; f < line->total_fragments; f++) {
+    if (line->received & (1u << f)) {
       continue;
     }
+    size_t offset = (size_t)f * line->fragment_size;
+    if (src) {
+      memcpy(dst->R + offset, src->R + offset, line->fragment_size);
+      memcpy(dst->G + offset, src->G + offset, line->fragment_size);
+      memcpy(dst->B + offset, src->B + offset, line->fragment_size);
+    } else {
+      memset(dst->R + offset, 0, line->fragment_size);
+      memset(dst->G + offset, 0, line->fragment_size);
+      memset(dst->B + offset, 0, line->fragment_size);
+    }
+  }
+}
+
+// Closes lines[0] and slides the table by one line. A complete line is
+// published; an incomplete one is completed from the previous line when few
+// fragments are missing (UDP_FILL_MAX_MISSING), dropped otherwise.
+static void reassembly_close_front(LineReassembly *r, Context *ctx) {
+  LineAssembly *line = &r->lines[0];
 
-    if (currentLineId != packet.line_id) {
-      currentLineId = packet.line_id;
-      memset(receivedFragments, 0, packet.total_fragments * sizeof(int));
-      fragmentCount = 0;
+  if (line->count == 0) {
+    // Never seen: lost between two received lines, or nothing sent yet
+    if ((int32_t)(r->newest_line - r->base) > 0) {
+      udp_stats_line(r->source, UDP_LINE_DROPPED, r->total_fragments);
     }
+    if (line->slot >= 0) {
+      reassembly_detach(r, line->slot);
+      releaseImageSlot(r->db, line->slot);
+    }
+  } else if (line->count == line->total_fragments) {
+    reassembly_publish(r, ctx, line);
+    udp_stats_line(r->source, UDP_LINE_COMPLETE, 0);
+  } else {
+    unsigned int missing = line->total_fragments - line->count;
+    reassembly_detach(r, line->slot);
+    if (missing <= UDP_FILL_MAX_MISSING) {
+      reassembly_fill(r, line);
+      reassembly_publish(r, ctx, line);
+      udp_stats_line(r->source, UDP_LINE_FILLED, missing);
+    } else {
+      releaseImageSlot(r->db, line->slot);
+      udp_stats_line(r->source, UDP_LINE_DROPPED, missing);
+    }
+  }
 
-    uint32_t offset = packet.fragment_id * packet.fragment_size;
-    if (!receivedFragments[packet.fragment_id]) {
-      receivedFragments[packet.fragment_id] = 1;
-      fragmentCount++;
-      memcpy(&db->activeBuffer_R[offset], packet.imageData_R,
-             packet.fragment_size);
-      memcpy(&db->activeBuffer_G[offset], packet.imageData_G,
-             packet.fragment_size);
-      memcpy(&db->activeBuffer_B[offset], packet.imageData_B,
-             packet.fragment_size);
+  memmove(&r->lines[0], &r->lines[1],
+          (UDP_ASSEMBLY_LINES - 1) * sizeof(LineAssembly));
+  reassembly_reset_line(&r->lines[UDP_ASSEMBLY_LINES - 1]);
+  r->base++;
+}
+
+// Publishes the complete lines in line_id order. An incomplete line holds the
+// newer ones back until UDP_REORDER_DEPTH_LINES newer lines have started.
+static void reassembly_flush(LineReassembly *r, Context *ctx) {
+  while (r->has_base && (int32_t)(r->newest_line - r->base) >= 0) {
+    const LineAssembly *line = &r->lines[0];
+    if (line->count == 0 || line->count < line->total_fragments) {
+      if (r->newest_line - r->base <= UDP_REORDER_DEPTH_LINES) {
+        break;
+      }
     }
+    reassembly_close_front(r, ctx);
+  }
+}
 
-    if (fragmentCount == packet.total_fragments) {
-#if ENABLE_IMAGE_TRANSFORM
-      if (ctx->enableImageTransform) {
-        int lineSize = packet.total_fragments * packet.fragment_size;
-        for (int i = 0; i < lineSize; i++) {
-          // Retrieve original RGB values
-          unsigned char r = db->activeBuffer_R[i];
-          unsigned char g = db->activeBuffer_G[i];
-          unsigned char b = db->activeBuffer_B[i];
-
-          // Step 2: Calculate perceived luminance: Y = 0.299 * r + 0.587 * g +
-          // 0.114 * b
-          double luminance = 0.299 * r + 0.587 * g + 0.114 * b;
-
-          // Step 3: Inversion and normalization:
-          // Y_inv = 255 - Y, then I = Y_inv / 255.
-          double invertedLuminance = 255.0 - luminance;
-          double intensity = invertedLuminance / 255.0;
-
-          // Step 4: Gamma correction: I_corr = intensity^(IMAGE_GAMMA)
-          double correctedIntensity = pow(intensity, IMAGE_GAMMA);
-
-          // Step 5: Modulate original RGB channels by the corrected intensity.
-          db->activeBuffer_R[i] = (uint8_t)round(r * correctedIntensity);
-          db->activeBuffer_G[i] = (uint8_t)round(g * correctedIntensity);
-          db->activeBuffer_B[i] = (uint8_t)round(b * correctedIntensity);
+// Closes every open line (end of a burst, sender restart)
+static void reassembly_flush_all(LineReassembly *r, Context *ctx) {
+  while (r->has_base && (int32_t)(r->newest_line - r->base) >= 0) {
+    reassembly_close_front(r, ctx);
+  }
+}
+
+// Gives back the slots reserved ahead of the stream, before the table is
+// moved to an unrelated line_id
+static void reassembly_clear(LineReassembly *r) {
+  for (int d = 0; d < UDP_ASSEMBLY_LINES; d++) {
+    if (r->lines[d].slot >= 0) {
+      reassembly_detach(r, r->lines[d].slot);
+      releaseImageSlot(r->db, r->lines[d].slot);
+    }
+    reassembly_reset_line(&r->lines[d]);
+  }
+}
+
+// Index of line_id in the table, sliding or restarting the table as needed.
+// -1: the line was already closed.
+static int reassembly_locate(LineReassembly *r, Context *ctx,
+                             uint32_t line_id) {
+  int32_t delta = (int32_t)(line_id - r->base);
+
+  if (r->has_base && (delta <= -UDP_LINE_RESTART_DISTANCE ||
+                      delta >= UDP_LINE_RESTART_DISTANCE)) {
+    reassembly_flush_all(r, ctx);
+    reassembly_clear(r);
+    r->has_base = 0;
+  }
+  if (!r->has_base) {
+    r->base = line_id;
+    r->newest_line = line_id;
+    r->has_base = 1;
+    r->next_line = line_id;
+    r->next_fragment = 0;
+    return 0;
+  }
+  if (delta < 0) {
+    return -1;
+  }
+
+  // Far ahead: the oldest lines age out to make room
+  while (line_id - r->base >= UDP_ASSEMBLY_LINES) {
+    if ((int32_t)(r->newest_line - r->base) < 0) {
+      reassembly_clear(r); // Nothing open any more
+      r->base = line_id;
+      break;
+    }
+    reassembly_close_front(r, ctx);
+  }
+  if ((int32_t)(line_id - r->newest_line) > 0) {
+    r->newest_line = line_id;
+  }
+  return (int)(line_id - r->base);
+}
+
+// Targets each datagram of the next batch at the position of the fragment
+// that follows the head of the stream, when that fragment is still missing.
+// Several scanners on one socket: the scanner of the last datagram.
+static void reassembly_predict(UdpReceiverState *rx) {
+  LineReassembly *r = rx->head;
+  UdpRecvBatch *batch = rx->batch;
+  if (r == NULL) {
+    for (int i = 0; i < UDP_RECV_BATCH; i++) {
+      rx->expected[i].slot = -1;
+      udp_recv_batch_target(batch, i, NULL, NULL, NULL, 0);
+    }
+    return;
+  }
+  uint32_t line_id = r->next_line;
+  uint8_t fragment = r->next_fragment;
+
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    uint32_t d = line_id - r->base;
+    uint32_t offset = (uint32_t)fragment * r->fragment_size;
+    int slot = -1;
+    if (r->has_base && d < UDP_ASSEMBLY_LINES && r->total_fragments > 0 &&
+        offset + r->fragment_size <= CIS_MAX_PIXELS_NB &&
+        !(r->lines[d].received & (1u << fragment))) {
+      slot = reassembly_slot(r, d);
+    }
+
+    rx->expected[i].table = r;
+    rx->expected[i].slot = slot;
+    if (slot >= 0) {
+      ImageSlot *line = &r->db->slots[slot];
+      rx->expected[i].line_id = line_id;
+      rx->expected[i].fragment_id = fragment;
+      rx->expected[i].fragment_size = r->fragment_size;
+      udp_recv_batch_target(batch, i, line->R + offset, line->G + offset,
+                            line->B + offset, r->fragment_size);
+    } else {
+      udp_recv_batch_target(batch, i, NULL, NULL, NULL, 0);
+    }
+
+    if (r->total_fragments > 0 && ++fragment >= r->total_fragments) {
+      fragment = 0;
+      line_id++;
+    }
+  }
+}
+
+// Adds one valid fragment to the table
+static void reassembly_add(LineReassembly *r, Context *ctx, int p,
+                           const struct packet_Image *packet) {
+  int d = reassembly_locate(r, ctx, packet->line_id);
+  if (d < 0) {
+    // Its line was already closed
+    udp_stats_fragment(r->source, UDP_FRAGMENT_LATE);
+    return;
+  }
+  LineAssembly *line = &r->lines[d];
+
+  if (line->total_fragments == 0) {
+    line->total_fragments = packet->total_fragments;
+    line->fragment_size = packet->fragment_size;
+  } else if (line->total_fragments != packet->total_fragments ||
+             line->fragment_size != packet->fragment_size) {
+    // Disagrees with its line
+    udp_stats_fragment(r->source, UDP_FRAGMENT_MALFORMED);
+    return;
+  }
+
+  // Head of the stream: the next batch is targeted after this fragment
+  int32_t ahead = (int32_t)(packet->line_id - r->next_line);
+  if (ahead > 0 || (ahead == 0 && packet->fragment_id >= r->next_fragment)) {
+    r->total_fragments = packet->total_fragments;
+    r->fragment_size = packet->fragment_size;
+    r->next_line = packet->line_id;
+    r->next_fragment = packet->fragment_id + 1;
+    if (r->next_fragment >= packet->total_fragments) {
+      r->next_line++;
+      r->next_fragment = 0;
+    }
+  }
+
+  uint32_t bit = 1u << packet->fragment_id;
+  if (line->received & bit) {
+    udp_stats_fragment(r->source, UDP_FRAGMENT_DUPLICATE);
+    return;
+  }
+  if (packet->line_id != r->newest_line ||
+      packet->fragment_id < line->highest_fragment) {
+    udp_stats_fragment(r->source, UDP_FRAGMENT_REORDERED);
+  }
+  int slot = reassembly_slot(r, (uint32_t)d);
+  if (slot < 0) {
+    return; // Every line pinned: cannot happen with enough slots
+  }
+
+  if (r->rx->expected[p].slot != slot) {
+    // Not received in place: single copy from the packet
+    uint32_t offset = packet->fragment_id * packet->fragment_size;
+    ImageSlot *dst = &r->db->slots[slot];
+    memcpy(dst->R + offset, packet->imageData_R, packet->fragment_size);
+    memcpy(dst->G + offset, packet->imageData_G, packet->fragment_size);
+    memcpy(dst->B + offset, packet->imageData_B, packet->fragment_size);
+  }
+  line->received |= bit;
+  line->count++;
+  if (packet->fragment_id > line->highest_fragment) {
+    line->highest_fragment = packet->fragment_id;
+  }
+
+  reassembly_flush(r, ctx);
+}
+
+// Receives the datagrams of one socket and assembles the lines of the
+// scanners steered to it
+static void udp_receive(Context *ctx, int s, int receiver) {
+  // Datagrams received in batches, buffers allocated once
+  UdpRecvBatch *batch = udp_recv_batch_create(receiver);
+  UdpReceiverState *rx =
+      (UdpReceiverState *)calloc(1, sizeof(UdpReceiverState));
+  if (batch == NULL || rx == NULL) {
+    perror("Error allocating UDP reassembly buffers");
+    exit(EXIT_FAILURE);
+  }
+  rx->batch = batch;
+
+  const int sources = udp_source_count();
+  for (int k = 0; k < sources; k++) {
+    if (udp_source_receiver(k) != receiver) {
+      continue;
+    }
+    LineReassembly *r = (LineReassembly *)calloc(1, sizeof(LineReassembly));
+    if (r == NULL) {
+      perror("Error allocating UDP reassembly buffers");
+      exit(EXIT_FAILURE);
+    }
+    // One ring per scanner, or the single ring of the context
+    r->db = ctx->scannerMap ? scanner_map_source(ctx->scannerMap, k)
+                            : ctx->doubleBuffer;
+    r->source = k;
+    r->rx = rx;
+    r->previous_slot = -1;
+    for (int d = 0; d < UDP_ASSEMBLY_LINES; d++) {
+      reassembly_reset_line(&r->lines[d]);
+    }
+    rx->sources[k] = r;
+    if (rx->head == NULL) {
+      rx->head = r;
+    }
+  }
+
+  while (ctx->running) {
+    reassembly_predict(rx);
+    int received = udp_recv_batch(s, batch);
+    if (received == 0) {
+      // Stream paused: the open lines will not complete
+      for (int k = 0; k < sources; k++) {
+        if (rx->sources[k]) {
+          reassembly_flush_all(rx->sources[k], ctx);
         }
       }
-#endif
-      pthread_mutex_lock(&db->mutex);
-      swapBuffers(db);
-      updateLastValidImage(db); // Save image for audio persistence
-      db->dataReady = 1;
-      pthread_cond_signal(&db->cond);
-      pthread_mutex_unlock(&db->mutex);
+      continue;
+    }
+
+    // Datagrams that are not the expected fragment go back to their packet.
+    // A fragment size change invalidates every target of the batch (the
+    // planes would overlap).
+    int resized = 0;
+    for (int p = 0; p < received; p++) {
+      const struct packet_Image *packet = udp_recv_batch_packet(batch, p);
+      if (rx->expected[p].slot >= 0 &&
+          udp_recv_batch_source(batch, p) == rx->expected[p].table->source &&
+          packet->fragment_size != rx->expected[p].fragment_size) {
+        resized = 1;
+      }
+    }
+    for (int p = 0; p < received; p++) {
+      const struct packet_Image *packet = udp_recv_batch_packet(batch, p);
+      if (rx->expected[p].slot >= 0 &&
+          (resized ||
+           udp_recv_batch_source(batch, p) != rx->expected[p].table->source ||
+           packet->type != IMAGE_DATA_HEADER ||
+           packet->line_id != rx->expected[p].line_id ||
+           packet->fragment_id != rx->expected[p].fragment_id)) {
+        udp_recv_batch_gather(batch, p);
+        rx->expected[p].slot = -1;
+      }
+    }
+
+    rx->pending_count = received;
+    for (int p = 0; p < received; p++) {
+      const struct packet_Image *packet = udp_recv_batch_packet(batch, p);
+      const int source = udp_recv_batch_source(batch, p);
+      rx->pending_from = p + 1;
+
+      if (source < 0 || packet->type != IMAGE_DATA_HEADER) {
+        continue;
+      }
+      if (!udp_packet_is_valid(packet)) {
+        udp_stats_fragment(source, UDP_FRAGMENT_MALFORMED);
+        continue;
+      }
+      rx->head = rx->sources[source];
+      reassembly_add(rx->head, ctx, p, packet);
     }
+    rx->pending_count = 0;
   }
 
-  free(receivedFragments);
+  udp_recv_batch_destroy(batch);
+  for (int k = 0; k < sources; k++) {
+    free(rx->sources[k]);
+  }
+  free(rx);
+}
+
+void *udpThread(void *arg) {
+  Context *ctx = (Context *)arg;
+  udp_receive(ctx, ctx->socket, 0);
+  return NULL;
+}
+
+void *udpReceiverThread(void *arg) {
+  UdpReceiver *receiver = (UdpReceiver *)arg;
+  udp_receive(receiver->ctx, receiver->socket, receiver->receiver);
   return NULL;
 }
 
@@ -357,72 +845,38 @@ void *dmxSendingThread(void *arg) {
 void *audioProcessingThread(void *arg) {
   Context *context = (Context *)arg;
   DoubleBuffer *db = context->doubleBuffer;
-  // Local buffers for synth_AudioProcess to avoid holding mutex during synth
-  uint8_t local_R[CIS_MAX_PIXELS_NB];
-  uint8_t local_G[CIS_MAX_PIXELS_NB];
-  uint8_t local_B[CIS_MAX_PIXELS_NB];
+  // Line read in place by synth_AudioProcess (pinned, no copy)
+  ImageLineRef line;
+  initImageLineRef(&line);
+
+  uint32_t last_version = 0;
 
   // Timeout configuration for non-blocking audio processing
-  struct timespec timeout;
-  const long TIMEOUT_MS =
+  const int TIMEOUT_MS =
       10; // 10ms timeout - audio continues even without new frames
 
+  enable_flush_to_zero();
+
   printf("[AUDIO] Audio processing thread started with 10ms timeout\n");
 
   while (context->running) {
-    // Calculate timeout time (current time + TIMEOUT_MS)
-    clock_gettime(CLOCK_REALTIME, &timeout);
-    timeout.tv_nsec += TIMEOUT_MS * 1000000L; // Convert ms to nanoseconds
-    if (timeout.tv_nsec >= 1000000000L) {
-      timeout.tv_sec += 1;
-      timeout.tv_nsec -= 1000000000L;
-    }
-
-    pthread_mutex_lock(&db->mutex);
-
-    // Wait for new data with timeout, or continue if timeout expires
-    int wait_result = 0;
-    while (!db->dataReady && context->running) {
-      wait_result = pthread_cond_timedwait(&db->cond, &db->mutex, &timeout);
-      if (wait_result == ETIMEDOUT) {
-        // Timeout occurred - continue with last valid image
-        break;
-      }
-    }
+    // Wait for a new line, or continue with the last valid image on timeout
+    waitForNewImage(db, last_version, TIMEOUT_MS);
 
     if (!context->running) {
-      pthread_mutex_unlock(&db->mutex);
       break;
     }
 
-    static uint64_t audio_log_counter = 0;
-
-    if (db->dataReady) {
-      // New data available - copy fresh image and reset dataReady flag
-      memcpy(local_R, db->processingBuffer_R, CIS_MAX_PIXELS_NB);
-      memcpy(local_G, db->processingBuffer_G, CIS_MAX_PIXELS_NB);
-      memcpy(local_B, db->processingBuffer_B, CIS_MAX_PIXELS_NB);
-
-      db->dataReady = 0; // Mark as consumed
-
-      // Debug logs removed for production use
-      ++audio_log_counter;
-
-    } else {
-      // Timeout occurred or no new data - use persistent image
-      // Debug logs removed for production use
-    }
-
-    pthread_mutex_unlock(&db->mutex);
-
     // Always get the most recent valid image for audio processing
     // This ensures audio continuity even when UDP stream stops
-    getLastValidImageForAudio(db, local_R, local_G, local_B);
+    last_version = getLastValidImageForAudio(db, &line);
 
     // Call synthesis routine with image data (fresh, persistent, or test)
-    synth_AudioProcess(local_R, local_G, local_B);
+    synth_AudioProcess(line.R, line.G, line.B);
   }
 
+  releaseImageLine(db, &line);
+
   printf("[AUDIO] Audio processing thread terminated\n");
   return NULL;
 }
@@ -162,8 +162,8 @@ struct PACKED_STRUCT cisRgbBuffers
 //---------------------------------------------------------------------------------------------------------------------------------------------------------
 
 void initDoubleBuffer(DoubleBuffer *db);
-void swapBuffers(DoubleBuffer *db);
-void *udpThread(void *arg);
+void *udpThread(void *arg);         // Context: ctx->socket, single scanner
+void *udpReceiverThread(void *arg); // UdpReceiver: scanners of one socket
 void *imageProcessingThread(void *arg);
 void *dmxSendingThread(void *arg);
 void *audioProcessingThread(void *arg);
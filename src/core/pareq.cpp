@@ -133,62 +133,98 @@ void Pareq::calcpar1 (int nsamp, float g, float f)
 
 void Pareq::process1 (int nsamp, int nchan, float *data[])
 {
-    int   i, j;
-    float c1, c2, gg;
+    int   i;
+    float coef [3];
+
+    // Channels are processed in pairs: the two recursions are independent,
+    // so running them in the same sample loop hides the latency of each
+    // filter chain and lets the compiler pack both lanes in one register.
+    for (i = 0; i + 1 < nchan; i += 2) process2 (nsamp, i, data [i], data [i + 1], coef);
+    if (i < nchan) process1ch (nsamp, i, data [i], coef);
+
+    if (_state == SMOOTH)
+    {
+        _c1 = coef [0];
+        _c2 = coef [1];
+        _gg = coef [2];
+    }
+}
+
+
+void Pareq::process1ch (int nsamp, int ch, float *p, float *coef)
+{
+    int   j;
+    float c1, c2, gg, dc1, dc2, dgg;
     float x, y, z1, z2;
-    float *p;
 
     c1 = _c1;
     c2 = _c2;
     gg = _gg;
-    if (_state == SMOOTH)
+    dc1 = (_state == SMOOTH) ? _dc1 : 0.0f;
+    dc2 = (_state == SMOOTH) ? _dc2 : 0.0f;
+    dgg = (_state == SMOOTH) ? _dgg : 0.0f;
+    z1 = _z1 [ch];
+    z2 = _z2 [ch];
+    for (j = 0; j < nsamp; j++)
     {
-	for (i = 0; i < nchan; i++)
-	{
-	    p = data [i];
-            z1 = _z1 [i];
-            z2 = _z2 [i];
-            c1 = _c1;
-            c2 = _c2;
-            gg = _gg;
-            for (j = 0; j < nsamp; j++)
-            {
-                c1 += _dc1;
-                c2 += _dc2;
-                gg += _dgg;
-	        x = *p;
-	        y = x - c2 * z2;
-		*p++ = x - gg * (z2 + c2 * y - x);
-	        y -= c1 * z1;
-	        z2 = z1 + c1 * y;
-	        z1 = y + 1e-20f;
-	    }
-            _z1 [i] = z1;
-            _z2 [i] = z2;
-	}
-        _c1 = c1;
-        _c2 = c2;
-        _gg = gg;
+        c1 += dc1;
+        c2 += dc2;
+        gg += dgg;
+        x = p [j];
+        y = x - c2 * z2;
+        p [j] = x - gg * (z2 + c2 * y - x);
+        y -= c1 * z1;
+        z2 = z1 + c1 * y;
+        z1 = y + 1e-20f;
     }
-    else
+    _z1 [ch] = z1;
+    _z2 [ch] = z2;
+    coef [0] = c1;
+    coef [1] = c2;
+    coef [2] = gg;
+}
+
+
+void Pareq::process2 (int nsamp, int ch, float *p, float *q, float *coef)
+{
+    int   j;
+    float c1, c2, gg, dc1, dc2, dgg;
+    float xa, ya, z1a, z2a;
+    float xb, yb, z1b, z2b;
+
+    c1 = _c1;
+    c2 = _c2;
+    gg = _gg;
+    dc1 = (_state == SMOOTH) ? _dc1 : 0.0f;
+    dc2 = (_state == SMOOTH) ? _dc2 : 0.0f;
+    dgg = (_state == SMOOTH) ? _dgg : 0.0f;
+    z1a = _z1 [ch];
+    z2a = _z2 [ch];
+    z1b = _z1 [ch + 1];
+    z2b = _z2 [ch + 1];
+    for (j = 0; j < nsamp; j++)
     {
-	for (i = 0; i < nchan; i++)
-	{
-	    p = data [i];
-            z1 = _z1 [i];
-            z2 = _z2 [i];
-            for (j = 0; j < nsamp; j++)
-            {
-	        x = *p;
-	        y = x - c2 * z2;
-		*p++ = x - gg * (z2 + c2 * y - x);
-	        y -= c1 * z1;
-	        z2 = z1 + c1 * y;
-	        z1 = y + 1e-20f;
-	    }
-            _z1 [i] = z1;
-            _z2 [i] = z2;
-	}
+        c1 += dc1;
+        c2 += dc2;
+        gg += dgg;
+        xa = p [j];
+        xb = q [j];
+        ya = xa - c2 * z2a;
+        yb = xb - c2 * z2b;
+        p [j] = xa - gg * (z2a + c2 * ya - xa);
+        q [j] = xb - gg * (z2b + c2 * yb - xb);
+        ya -= c1 * z1a;
+        yb -= c1 * z1b;
+        z2a = z1a + c1 * ya;
+        z2b = z1b + c1 * yb;
+        z1a = ya + 1e-20f;
+        z1b = yb + 1e-20f;
     }
+    _z1 [ch] = z1a;
+    _z2 [ch] = z2a;
+    _z1 [ch + 1] = z1b;
+    _z2 [ch + 1] = z2b;
+    coef [0] = c1;
+    coef [1] = c2;
+    coef [2] = gg;
 }
-
@@ -41,12 +41,16 @@ public:
     if (_state != BYPASS)
       process1(nsamp, nchan, data);
   }
+  // True when the filter is a no-op and no parameter change is pending
+  bool bypassed(void) const { return _state == BYPASS && _touch1 == _touch0; }
 
 private:
   enum { BYPASS, STATIC, SMOOTH, MAXCH = 4 };
 
   void calcpar1(int nsamp, float g, float f);
   void process1(int nsamp, int nchan, float *data[]);
+  void process1ch(int nsamp, int ch, float *p, float *coef);
+  void process2(int nsamp, int ch, float *p, float *q, float *coef);
 
   volatile int16_t _touch0;
   volatile int16_t _touch1;
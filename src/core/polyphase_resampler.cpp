@@ -0,0 +1,176 @@
+/*
+ * polyphase_resampler.cpp
+ *
+ * Integer-factor interpolator and decimator (see polyphase_resampler.h).
+ */
+
+#include "polyphase_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Modified Bessel function of the first kind, order 0 (series expansion)
+static double besselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 50; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+// Kaiser-windowed sinc low-pass of the given length at the high rate, whose
+// transition band (Kaiser estimate) ends at the low rate's Nyquist frequency.
+// Normalized to a DC gain of 1.
+static std::vector<double> designPrototype(int factor, int length,
+                                           double stopbandDb) {
+  const double beta = (stopbandDb > 50.0)
+                          ? 0.1102 * (stopbandDb - 8.7)
+                          : 0.5842 * pow(stopbandDb - 21.0, 0.4) +
+                                0.07886 * (stopbandDb - 21.0);
+  const double transition =
+      (stopbandDb - 8.0) / (2.285 * 2.0 * M_PI * (length - 1));
+  const double cutoff = 0.5 / factor - transition / 2.0; // Cycles per sample
+  const double center = (length - 1) / 2.0;
+  const double norm = besselI0(beta);
+
+  std::vector<double> proto(length);
+  double sum = 0.0;
+  for (int i = 0; i < length; i++) {
+    double t = i - center;
+    double sinc = (t == 0.0) ? 2.0 * cutoff
+                             : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+    double r = t / center;
+    double window = besselI0(beta * sqrt(1.0 - r * r)) / norm;
+    proto[i] = sinc * window;
+    sum += proto[i];
+  }
+  for (double &h : proto)
+    h /= sum;
+  return proto;
+}
+
+PolyphaseUpsampler::PolyphaseUpsampler()
+    : factor(1), taps(TAPS_PER_PHASE), maxInputFrames(0) {}
+
+bool PolyphaseUpsampler::init(int factor, unsigned int maxInputFrames,
+                              int tapsPerPhase, float stopbandDb) {
+  if ((factor != 1 && factor != 2 && factor != 4) || tapsPerPhase < 2)
+    return false;
+
+  this->factor = factor;
+  this->taps = tapsPerPhase;
+  this->maxInputFrames = maxInputFrames;
+  history.assign(taps - 1 + maxInputFrames, 0.0f);
+  coeffs.assign((size_t)factor * taps, 0.0f);
+  if (factor == 1)
+    return true;
+
+  std::vector<double> proto =
+      designPrototype(factor, factor * taps, stopbandDb);
+
+  // Phase p uses taps p, p + factor, ...; gain factor for unity passband
+  for (int p = 0; p < factor; p++) {
+    for (int k = 0; k < taps; k++) {
+      coeffs[(size_t)p * taps + (taps - 1 - k)] =
+          (float)(proto[p + k * factor] * factor);
+    }
+  }
+  return true;
+}
+
+void PolyphaseUpsampler::reset() {
+  std::fill(history.begin(), history.end(), 0.0f);
+}
+
+unsigned int PolyphaseUpsampler::getLatencyFrames() const {
+  return factor > 1 ? (unsigned int)(factor * taps - 1) / 2 : 0;
+}
+
+void PolyphaseUpsampler::process(const float *in, unsigned int inFrames,
+                                 float *out) {
+  if (factor == 1) {
+    std::memcpy(out, in, inFrames * sizeof(float));
+    return;
+  }
+
+  float *hist = history.data();
+  std::memcpy(hist + taps - 1, in, inFrames * sizeof(float));
+
+  const int L = factor;
+  const int T = taps;
+  for (unsigned int n = 0; n < inFrames; n++) {
+    const float *__restrict window = hist + n;
+    for (int p = 0; p < L; p++) {
+      const float *__restrict c = &coeffs[(size_t)p * T];
+      float acc = 0.0f;
+      for (int j = 0; j < T; j++) {
+        acc += c[j] * window[j];
+      }
+      out[n * L + p] = acc;
+    }
+  }
+
+  // Keep the last taps - 1 inputs for the next block
+  std::memmove(hist, hist + inFrames, (T - 1) * sizeof(float));
+}
+
+PolyphaseDecimator::PolyphaseDecimator()
+    : factor(1), length(1), maxInputFrames(0) {}
+
+bool PolyphaseDecimator::init(int factor, unsigned int maxInputFrames,
+                              int tapsPerPhase, float stopbandDb) {
+  if ((factor != 1 && factor != 2 && factor != 4) || tapsPerPhase < 2)
+    return false;
+
+  this->factor = factor;
+  this->length = factor * tapsPerPhase;
+  this->maxInputFrames = maxInputFrames;
+  history.assign(length - 1 + maxInputFrames, 0.0f);
+  coeffs.assign(length, 0.0f);
+  if (factor == 1)
+    return true;
+
+  std::vector<double> proto = designPrototype(factor, length, stopbandDb);
+  for (int i = 0; i < length; i++) {
+    coeffs[length - 1 - i] = (float)proto[i];
+  }
+  return true;
+}
+
+void PolyphaseDecimator::reset() {
+  std::fill(history.begin(), history.end(), 0.0f);
+}
+
+unsigned int PolyphaseDecimator::getLatencyFrames() const {
+  return factor > 1 ? (unsigned int)(length - 1) / 2 : 0;
+}
+
+void PolyphaseDecimator::process(const float *in, unsigned int inFrames,
+                                 float *out) {
+  if (factor == 1) {
+    std::memcpy(out, in, inFrames * sizeof(float));
+    return;
+  }
+
+  float *hist = history.data();
+  std::memcpy(hist + length - 1, in, inFrames * sizeof(float));
+
+  // Only the kept outputs are computed: out[m] = sum_i h[i] in[m*M - i]
+  const int N = length;
+  const float *__restrict c = coeffs.data();
+  const unsigned int outFrames = inFrames / factor;
+  for (unsigned int m = 0; m < outFrames; m++) {
+    const float *__restrict window = hist + (size_t)m * factor + factor - 1;
+    float acc = 0.0f;
+    for (int j = 0; j < N; j++) {
+      acc += c[j] * window[j];
+    }
+    out[m] = acc;
+  }
+
+  std::memmove(hist, hist + inFrames, (N - 1) * sizeof(float));
+}
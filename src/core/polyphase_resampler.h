@@ -0,0 +1,79 @@
+/*
+ * polyphase_resampler.h
+ *
+ * Integer-factor FIR resamplers. The Kaiser-windowed sinc prototype is split
+ * into one short filter per phase, so each output sample is a single
+ * contiguous dot product (no zero stuffing, no discarded outputs), laid out
+ * for the compiler to vectorize.
+ *
+ * PolyphaseUpsampler: output stage, engines at g_sampling_frequency and the
+ * device at factor times that rate.
+ * PolyphaseDecimator: reduced-rate reverb send.
+ */
+
+#ifndef POLYPHASE_RESAMPLER_H
+#define POLYPHASE_RESAMPLER_H
+
+#include <vector>
+
+class PolyphaseUpsampler {
+public:
+  // Defaults: ~100 dB image rejection with a transition band of ~5% of the
+  // output rate below the input Nyquist frequency
+  static const int TAPS_PER_PHASE = 64;
+  static constexpr float STOPBAND_DB = 100.0f;
+
+  PolyphaseUpsampler();
+
+  // factor 1 (pass-through), 2 or 4. maxInputFrames bounds process() calls.
+  // Fewer taps per phase trade a wider transition band for CPU.
+  bool init(int factor, unsigned int maxInputFrames,
+            int tapsPerPhase = TAPS_PER_PHASE,
+            float stopbandDb = STOPBAND_DB);
+  void reset();
+
+  int getFactor() const { return factor; }
+  // Group delay in output frames
+  unsigned int getLatencyFrames() const;
+
+  // Writes inFrames * factor samples to out (no allocation)
+  void process(const float *in, unsigned int inFrames, float *out);
+
+private:
+  int factor;
+  int taps; // Per phase
+  unsigned int maxInputFrames;
+  // coeffs[phase * taps + j], reversed so that output sample
+  // (n, phase) = sum_j coeffs[phase][j] * history[n + j]
+  std::vector<float> coeffs;
+  // taps - 1 previous input samples followed by the current block
+  std::vector<float> history;
+};
+
+class PolyphaseDecimator {
+public:
+  PolyphaseDecimator();
+
+  // factor 1 (pass-through), 2 or 4. maxInputFrames bounds process() calls.
+  bool init(int factor, unsigned int maxInputFrames,
+            int tapsPerPhase = PolyphaseUpsampler::TAPS_PER_PHASE,
+            float stopbandDb = PolyphaseUpsampler::STOPBAND_DB);
+  void reset();
+
+  int getFactor() const { return factor; }
+  // Group delay in input frames
+  unsigned int getLatencyFrames() const;
+
+  // inFrames must be a multiple of the factor, writes inFrames / factor
+  // samples to out (no allocation)
+  void process(const float *in, unsigned int inFrames, float *out);
+
+private:
+  int factor;
+  int length; // factor * taps per phase
+  unsigned int maxInputFrames;
+  std::vector<float> coeffs;  // Reversed prototype
+  std::vector<float> history; // length - 1 previous inputs + current block
+};
+
+#endif // POLYPHASE_RESAMPLER_H
@@ -238,6 +238,12 @@ void Reverb::init (float fsamp, bool ambis)
 	k2 = (int)(floorf (_tdelay [i] * _fsamp + 0.5f));
         _diff1 [i].init (k1, (i & 1) ? -0.6f : 0.6f);
         _delay [i].init (k2 - k1);
+        _fdn_c [i >> 2][i & 3] = _diff1 [i]._c;
+    }
+    for (i = 0; i < 2; i++)
+    {
+        _fdn_slo [i] = (v4sf) { 0, 0, 0, 0 };
+        _fdn_shi [i] = (v4sf) { 0, 0, 0, 0 };
     }
 
     _pareq1.setfsamp (fsamp);
@@ -247,7 +253,13 @@ void Reverb::init (float fsamp, bool ambis)
 
 void Reverb::fini (void)
 {
-    for (int i = 0; i < 8; i++) _delay [i].fini ();
+    _vdelay0.fini ();
+    _vdelay1.fini ();
+    for (int i = 0; i < 8; i++)
+    {
+        _diff1 [i].fini ();
+        _delay [i].fini ();
+    }
 }
 
 
@@ -277,6 +289,10 @@ void Reverb::prepare (int nfram)
          for (i = 0; i < 8; i++)
 	 {
              _filt1 [i].set_params (_tdelay [i], _rtmid, _rtlow, wlo, 0.5f * _rtmid, chi);
+             _fdn_gmf [i >> 2][i & 3] = _filt1 [i]._gmf;
+             _fdn_glo [i >> 2][i & 3] = _filt1 [i]._glo;
+             _fdn_wlo [i >> 2][i & 3] = _filt1 [i]._wlo;
+             _fdn_whi [i >> 2][i & 3] = _filt1 [i]._whi;
 	 }
          _cntB2 = b;
     }
@@ -303,12 +319,21 @@ void Reverb::prepare (int nfram)
 }
 
 
+// The eight lines are independent within a sample: their delay and Diff1
+// taps are gathered into two 4-wide vectors, Diff1, the 8-point Hadamard mix
+// and Filt1 run on the vectors, and the results are scattered back to the
+// lines. Same operations, in the same order, as the scalar per-line code.
 void Reverb::process (int nfram, float *inp [], float *out [])
 {	
-    int   i, n;
+    int   i, k, n;
     float *p0, *p1;
     float *q0, *q1, *q2, *q3;
-    float t, g, x0, x1, x2, x3, x4, x5, x6, x7;
+    float t, g, x0, x1, x2, x4;
+    v4sf  x [2], y [2], z [2], w [2], s;
+
+    const v4sf sgn_inj = { 1.0f, 1.0f, -1.0f, -1.0f };
+    const v4sf sgn_h1 = { 1.0f, -1.0f, 1.0f, -1.0f };
+    const v4sf sgn_h2 = { 1.0f, 1.0f, -1.0f, -1.0f };
 
     g = sqrtf (0.125f);
 
@@ -324,30 +349,46 @@ void Reverb::process (int nfram, float *inp [], float *out [])
 	_vdelay0.write (p0 [i]);
 	_vdelay1.write (p1 [i]);
 
+	// Gather the delay outputs and Diff1 taps
+	for (k = 0; k < 8; k++)
+	{
+	    x [k >> 2][k & 3] = _delay [k]._line [_delay [k]._i];
+	    z [k >> 2][k & 3] = _diff1 [k]._line [_diff1 [k]._i];
+	}
+
+	// Input injection (+t, +t, -t, -t per group of four) and Diff1
  	t = 0.3f * _vdelay0.read ();
-	x0 = _diff1 [0].process (_delay [0].read () + t);
-	x1 = _diff1 [1].process (_delay [1].read () + t);
-	x2 = _diff1 [2].process (_delay [2].read () - t);
-	x3 = _diff1 [3].process (_delay [3].read () - t);
+	x [0] += t * sgn_inj;
  	t = 0.3f * _vdelay1.read ();
-	x4 = _diff1 [4].process (_delay [4].read () + t);
-	x5 = _diff1 [5].process (_delay [5].read () + t);
-	x6 = _diff1 [6].process (_delay [6].read () - t);
-	x7 = _diff1 [7].process (_delay [7].read () - t);
-
-        t = x0 - x1; x0 += x1;  x1 = t;
-        t = x2 - x3; x2 += x3;  x3 = t;
-        t = x4 - x5; x4 += x5;  x5 = t;
-        t = x6 - x7; x6 += x7;  x7 = t;
-        t = x0 - x2; x0 += x2;  x2 = t;
-        t = x1 - x3; x1 += x3;  x3 = t;
-        t = x4 - x6; x4 += x6;  x6 = t;
-        t = x5 - x7; x5 += x7;  x7 = t;
-        t = x0 - x4; x0 += x4;  x4 = t;
-        t = x1 - x5; x1 += x5;  x5 = t;
-        t = x2 - x6; x2 += x6;  x6 = t;
-        t = x3 - x7; x3 += x7;  x7 = t;
+	x [1] += t * sgn_inj;
+	for (k = 0; k < 2; k++)
+	{
+	    w [k] = x [k] - _fdn_c [k] * z [k];
+	    y [k] = z [k] + _fdn_c [k] * w [k];
+	}
+	for (k = 0; k < 8; k++)
+	{
+	    Diff1 *d = _diff1 + k;
+	    d->_line [d->_i] = w [k >> 2][k & 3];
+	    if (++d->_i == d->_size) d->_i = 0;
+	}
 
+	// Hadamard mix: butterflies on (0,1) (2,3).., (0,2) (1,3).., (0,4)..
+	for (k = 0; k < 2; k++)
+	{
+	    s = (v4sf) { y [k][1], y [k][0], y [k][3], y [k][2] };
+	    y [k] = s + y [k] * sgn_h1;
+	    s = (v4sf) { y [k][2], y [k][3], y [k][0], y [k][1] };
+	    y [k] = s + y [k] * sgn_h2;
+	}
+	s = y [0] - y [1];
+	y [0] += y [1];
+	y [1] = s;
+
+	x0 = y [0][0];
+	x1 = y [0][1];
+	x2 = y [0][2];
+	x4 = y [1][0];
 	if (_ambis)
 	{
             _g0 += _d0;
@@ -364,14 +405,19 @@ void Reverb::process (int nfram, float *inp [], float *out [])
 	    q1 [i] = _g1 * (x1 - x2);
 	}
 
-	_delay [0].write (_filt1 [0].process (g * x0));
-	_delay [1].write (_filt1 [1].process (g * x1));
-	_delay [2].write (_filt1 [2].process (g * x2));
-        _delay [3].write (_filt1 [3].process (g * x3));
-        _delay [4].write (_filt1 [4].process (g * x4));
-        _delay [5].write (_filt1 [5].process (g * x5));
-        _delay [6].write (_filt1 [6].process (g * x6));
-        _delay [7].write (_filt1 [7].process (g * x7));
+	// Filt1 on the feedback, then scatter to the delay lines
+	for (k = 0; k < 2; k++)
+	{
+	    x [k] = g * y [k];
+	    _fdn_slo [k] += _fdn_wlo [k] * (x [k] - _fdn_slo [k]) + 1e-10f;
+	    x [k] += _fdn_glo [k] * _fdn_slo [k];
+	    _fdn_shi [k] += _fdn_whi [k] * (x [k] - _fdn_shi [k]);
+	    x [k] = _fdn_gmf [k] * _fdn_shi [k];
+	}
+	for (k = 0; k < 8; k++)
+	{
+	    _delay [k].write (x [k >> 2][k & 3]);
+	}
     }
 
     n = _ambis ? 4 : 2;
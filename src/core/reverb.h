@@ -39,15 +39,7 @@ private:
     void  init (int size, float c);
     void  fini (void);
 
-    float process (float x)
-    {
-	float z = _line [_i];
-	x -= _c * z;
-        _line [_i] = x;
-        if (++_i == _size) _i = 0;
-	return z + _c * x;
-    } 
-
+    // Line only: the allpass runs 4-wide in Reverb::process ()
     int     _i;
     float   _c;
     int     _size;
@@ -64,24 +56,16 @@ private:
 
     friend class Reverb;
     
-    Filt1 (void) : _slo (0), _shi (0) {}
+    Filt1 (void) {}
     ~Filt1 (void) {}
 
+    // Coefficients only: the filter state lives in Reverb::_fdn_slo/_fdn_shi
     void  set_params (float del, float tmf, float tlo, float wlo, float thi, float chi);
 
-    float process (float x)
-    {
-        _slo += _wlo * (x - _slo) + 1e-10f;
-        x += _glo * _slo;
-        _shi += _whi * (x - _shi);
-	return _gmf * _shi;
-    }
     float   _gmf;
     float   _glo;
     float   _wlo;
     float   _whi;
-    float   _slo;
-    float   _shi;    
 };
 
 
@@ -212,6 +196,20 @@ private:
     Pareq   _pareq1;
     Pareq   _pareq2;
 
+    // Struct-of-arrays copy of the eight lines' Diff1 coefficient and Filt1
+    // parameters and state, processed as two 4-wide vectors (lines 0-3 and
+    // 4-7) by process (). Diff1 and Delay keep their delay lines, Filt1 only
+    // computes the parameters.
+    typedef float v4sf __attribute__ ((vector_size (16)));
+
+    v4sf    _fdn_c [2];
+    v4sf    _fdn_gmf [2];
+    v4sf    _fdn_glo [2];
+    v4sf    _fdn_wlo [2];
+    v4sf    _fdn_whi [2];
+    v4sf    _fdn_slo [2];
+    v4sf    _fdn_shi [2];
+
     static float _tdiff1 [8];
     static float _tdelay [8];
 };
@@ -0,0 +1,196 @@
+/*
+ * scanner_map.c
+ *
+ * Mapping of several scanners onto the synthesis engines (see
+ * scanner_map.h).
+ */
+
+#include "scanner_map.h"
+#include "config.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ScannerMap {
+  ScannerMapMode mode;
+  int count;
+  DoubleBuffer sources[UDP_MAX_SOURCES];
+
+  // Bank mode: composed lines. The compose thread is the single writer of
+  // the bank ring; UDP threads only wake it, so they never wait for a
+  // compose and keep scaling across cores.
+  DoubleBuffer bank;
+  ImageLineRef refs[UDP_MAX_SOURCES]; // Last line of each scanner, pinned
+  pthread_t compose_thread;
+  pthread_mutex_t wake_mutex;
+  pthread_cond_t wake_cond;
+  int pending; // Lines published since the last compose
+  int running;
+};
+
+static void *scanner_map_compose_thread(void *arg);
+
+int scanner_map_parse_mode(const char *name, ScannerMapMode *mode) {
+  if (strcmp(name, "bank") == 0) {
+    *mode = SCANNER_MAP_BANK;
+  } else if (strcmp(name, "engines") == 0) {
+    *mode = SCANNER_MAP_ENGINES;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+ScannerMap *scanner_map_create(int sources, ScannerMapMode mode) {
+  if (sources < 2 || sources > UDP_MAX_SOURCES) {
+    printf("Scanner map: %d scanners (must be 2-%d)\n", sources,
+           UDP_MAX_SOURCES);
+    return NULL;
+  }
+  if (mode == SCANNER_MAP_ENGINES && sources != 2) {
+    printf("Scanner map 'engines' takes 2 scanners (IFFT and FFT synths), "
+           "%d given\n",
+           sources);
+    return NULL;
+  }
+
+  ScannerMap *map = (ScannerMap *)calloc(1, sizeof(ScannerMap));
+  if (map == NULL) {
+    perror("Error allocating scanner map");
+    return NULL;
+  }
+  map->mode = mode;
+  map->count = sources;
+  for (int k = 0; k < sources; k++) {
+    initDoubleBuffer(&map->sources[k]);
+    initImageLineRef(&map->refs[k]);
+  }
+  if (mode == SCANNER_MAP_BANK) {
+    initDoubleBuffer(&map->bank);
+    pthread_mutex_init(&map->wake_mutex, NULL);
+    pthread_cond_init(&map->wake_cond, NULL);
+    map->running = 1;
+    if (pthread_create(&map->compose_thread, NULL, scanner_map_compose_thread,
+                       map) != 0) {
+      perror("Error creating scanner map compose thread");
+      map->running = 0;
+      scanner_map_destroy(map);
+      return NULL;
+    }
+    printf("Scanners: %d side by side on the note bank (%d pixels, %d notes "
+           "each)\n",
+           sources, CIS_MAX_PIXELS_NB / sources,
+           CIS_MAX_PIXELS_NB / sources / PIXELS_PER_NOTE);
+  } else {
+    printf("Scanners: 1 -> IFFT synth, DMX and display, 2 -> FFT synth\n");
+  }
+  return map;
+}
+
+void scanner_map_destroy(ScannerMap *map) {
+  if (map == NULL) {
+    return;
+  }
+  if (map->mode == SCANNER_MAP_BANK && map->running) {
+    pthread_mutex_lock(&map->wake_mutex);
+    map->running = 0;
+    pthread_cond_signal(&map->wake_cond);
+    pthread_mutex_unlock(&map->wake_mutex);
+    pthread_join(map->compose_thread, NULL);
+  }
+  for (int k = 0; k < map->count; k++) {
+    releaseImageLine(&map->sources[k], &map->refs[k]);
+    cleanupDoubleBuffer(&map->sources[k]);
+  }
+  if (map->mode == SCANNER_MAP_BANK) {
+    cleanupDoubleBuffer(&map->bank);
+    pthread_mutex_destroy(&map->wake_mutex);
+    pthread_cond_destroy(&map->wake_cond);
+  }
+  free(map);
+}
+
+DoubleBuffer *scanner_map_source(ScannerMap *map, int source) {
+  return &map->sources[source];
+}
+
+DoubleBuffer *scanner_map_ifft(ScannerMap *map) {
+  return map->mode == SCANNER_MAP_BANK ? &map->bank : &map->sources[0];
+}
+
+DoubleBuffer *scanner_map_fft(ScannerMap *map) {
+  return map->mode == SCANNER_MAP_BANK ? &map->bank : &map->sources[1];
+}
+
+// New bank line from the newest line of every scanner (black until its
+// first line), compose thread only
+static void scanner_map_compose(ScannerMap *map) {
+  const int n = map->count;
+  const int width = CIS_MAX_PIXELS_NB / n;
+  int slot = reserveImageSlot(&map->bank);
+  if (slot < 0) {
+    return; // Every line pinned: cannot happen with enough slots
+  }
+  ImageSlot *dst = &map->bank.slots[slot];
+
+  for (int k = 0; k < n; k++) {
+    ImageLineRef *ref = &map->refs[k];
+    acquireImageLine(&map->sources[k], ref);
+    const uint8_t *in[3] = {ref->R, ref->G, ref->B};
+    uint8_t *out[3] = {dst->R + k * width, dst->G + k * width,
+                       dst->B + k * width};
+
+    // n adjacent pixels per note
+    for (int c = 0; c < 3; c++) {
+      const uint8_t *src = in[c];
+      for (int x = 0; x < width; x++, src += n) {
+        unsigned int sum = 0;
+        for (int i = 0; i < n; i++) {
+          sum += src[i];
+        }
+        out[c][x] = (uint8_t)((sum + n / 2) / n);
+      }
+    }
+  }
+  // Notes left over when the width does not split evenly
+  const int rest = CIS_MAX_PIXELS_NB - n * width;
+  if (rest > 0) {
+    memset(dst->R + n * width, 0, rest);
+    memset(dst->G + n * width, 0, rest);
+    memset(dst->B + n * width, 0, rest);
+  }
+
+  publishImageSlot(&map->bank, slot);
+}
+
+// Composes once per wakeup: lines published meanwhile by several scanners
+// are taken together, each scanner contributing its newest line
+static void *scanner_map_compose_thread(void *arg) {
+  ScannerMap *map = (ScannerMap *)arg;
+
+  pthread_mutex_lock(&map->wake_mutex);
+  while (map->running) {
+    if (!map->pending) {
+      pthread_cond_wait(&map->wake_cond, &map->wake_mutex);
+      continue;
+    }
+    map->pending = 0;
+    pthread_mutex_unlock(&map->wake_mutex);
+    scanner_map_compose(map);
+    pthread_mutex_lock(&map->wake_mutex);
+  }
+  pthread_mutex_unlock(&map->wake_mutex);
+  return NULL;
+}
+
+void scanner_map_line_published(ScannerMap *map, int source) {
+  (void)source; // The whole bank line is composed again
+  if (map->mode != SCANNER_MAP_BANK) {
+    return;
+  }
+  pthread_mutex_lock(&map->wake_mutex);
+  map->pending = 1;
+  pthread_cond_signal(&map->wake_cond);
+  pthread_mutex_unlock(&map->wake_mutex);
+}
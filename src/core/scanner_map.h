@@ -0,0 +1,55 @@
+/*
+ * scanner_map.h
+ *
+ * Several CIS scanners (--scanner) each have their own line ring, written by
+ * the UDP thread of the scanner. The map decides what the engines read:
+ *
+ *  - bank: the lines of every scanner side by side across the note bank
+ *    (scanner 1 on the lowest notes), each one averaged down to
+ *    CIS_MAX_PIXELS_NB / scanners pixels. A compose thread, woken each time
+ *    a scanner publishes, writes the lines to a ring read by every engine.
+ *  - engines: scanner 1 drives the IFFT synth, DMX and display, scanner 2
+ *    the FFT synth. The engines read the scanner rings directly.
+ *
+ * A single scanner needs no map: its ring is Context.doubleBuffer.
+ */
+
+#ifndef SCANNER_MAP_H
+#define SCANNER_MAP_H
+
+#include "doublebuffer.h"
+
+typedef enum {
+  SCANNER_MAP_BANK = 0, // Side by side across the note bank
+  SCANNER_MAP_ENGINES   // One scanner per synthesis engine
+} ScannerMapMode;
+
+typedef struct ScannerMap ScannerMap;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// "bank" or "engines", returns -1 for anything else
+int scanner_map_parse_mode(const char *name, ScannerMapMode *mode);
+
+// Allocates the rings of 'sources' scanners, NULL (with a message) if the
+// mode cannot map that many scanners
+ScannerMap *scanner_map_create(int sources, ScannerMapMode mode);
+void scanner_map_destroy(ScannerMap *map);
+
+// Ring written by the UDP thread of a scanner
+DoubleBuffer *scanner_map_source(ScannerMap *map, int source);
+// Rings read by the IFFT synth (with DMX and display) and the FFT synth
+DoubleBuffer *scanner_map_ifft(ScannerMap *map);
+DoubleBuffer *scanner_map_fft(ScannerMap *map);
+
+// UDP thread of 'source', after each line it published: wakes the compose
+// thread in bank mode, never composes itself
+void scanner_map_line_published(ScannerMap *map, int source);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCANNER_MAP_H
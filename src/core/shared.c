@@ -23,7 +23,7 @@ struct shared_var shared_var;
 
 //volatile int32_t imageData[CIS_MAX_PIXELS_NB];
 
-volatile int32_t audioBuff[AUDIO_BUFFER_SIZE * 4];
+volatile int32_t audioBuff[AUDIO_BUFFER_SIZE_MAX * 4];
 
 volatile struct wave waves[NUMBER_OF_NOTES];
 
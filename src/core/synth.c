@@ -25,6 +25,10 @@
 #include <stdint.h>
 
 #include "audio_c_api.h"
+#include "audio_format.h"
+#include "audio_params.h"
+#include "audio_telemetry.h"
+#include "denormals.h"
 #include "error.h"
 #include "shared.h"
 #include "synth.h"
@@ -39,13 +43,9 @@
 /* Private macro -------------------------------------------------------------*/
 
 /* Synth Data Freeze Feature - Definitions */
-volatile int g_is_synth_data_frozen = 0;
 int32_t g_frozen_grayscale_buffer[CIS_MAX_PIXELS_NB];
-volatile int g_is_synth_data_fading_out = 0;
-double g_synth_data_fade_start_time = 0.0;
 const double G_SYNTH_DATA_FADE_DURATION_SECONDS =
     5.0; // Corresponds to visual fade
-pthread_mutex_t g_synth_data_freeze_mutex;
 
 // Helper function to get current time in seconds
 static double synth_getCurrentTimeInSeconds() {
@@ -57,16 +57,10 @@ static double synth_getCurrentTimeInSeconds() {
 }
 
 void synth_data_freeze_init(void) {
-  if (pthread_mutex_init(&g_synth_data_freeze_mutex, NULL) != 0) {
-    perror("Failed to initialize synth data freeze mutex");
-    // Handle error appropriately, e.g., exit or log
-  }
   memset(g_frozen_grayscale_buffer, 0, sizeof(g_frozen_grayscale_buffer));
 }
 
-void synth_data_freeze_cleanup(void) {
-  pthread_mutex_destroy(&g_synth_data_freeze_mutex);
-}
+void synth_data_freeze_cleanup(void) {}
 
 /* Buffers for display to reflect synth data (grayscale converted to RGB) -
  * Definitions */
@@ -92,10 +86,9 @@ void displayable_synth_buffers_cleanup(void) {
 
 /* Private variables ---------------------------------------------------------*/
 
-// Variables pour la limitation des logs (affichage périodique)
+// Variables pour la limitation des logs (affichage périodique, environ 1
+// seconde, voir LOG_FREQUENCY dans config.h)
 static uint32_t log_counter = 0;
-#define LOG_FREQUENCY                                                          \
-  (SAMPLING_FREQUENCY / AUDIO_BUFFER_SIZE) // Environ 1 seconde
 
 // static volatile int32_t *half_audio_ptr; // Unused variable
 // static volatile int32_t *full_audio_ptr; // Unused variable
@@ -105,8 +98,9 @@ static int32_t imageRef[NUMBER_OF_NOTES] = {0};
 // ToChange__IO uint16_t uhADCxConvertedValue = 0;
 
 /* Private function prototypes -----------------------------------------------*/
-static uint32_t greyScale(uint8_t *buffer_R, uint8_t *buffer_G,
-                          uint8_t *buffer_B, int32_t *gray, uint32_t size);
+static uint32_t greyScale(const uint8_t *buffer_R, const uint8_t *buffer_G,
+                          const uint8_t *buffer_B, int32_t *gray,
+                          uint32_t size);
 void synth_IfftMode(int32_t *imageData, float *audioData);
 
 static float calculate_contrast(int32_t *imageData, size_t size);
@@ -285,11 +279,20 @@ int32_t synth_IfftInit(void) {
 
   fill_int32(65535, (int32_t *)imageRef, NUMBER_OF_NOTES);
 
+  // Allouer les tables des workers maintenant (taille de buffer connue) plutôt
+  // qu'au premier buffer audio
+  if (synth_init_thread_pool() != 0) {
+    printf("Pool de threads indisponible, mode séquentiel activé\n");
+  }
+  printf("Audio format: %u Hz, %u frames (%s)\n", g_sampling_frequency,
+         g_audio_buffer_size,
+         audio_format_is_specialized() ? "specialised path" : "generic path");
+
   return 0;
 }
 
-uint32_t greyScale(uint8_t *buffer_R, uint8_t *buffer_G, uint8_t *buffer_B,
-                   int32_t *gray, uint32_t size) {
+uint32_t greyScale(const uint8_t *buffer_R, const uint8_t *buffer_G,
+                   const uint8_t *buffer_B, int32_t *gray, uint32_t size) {
   uint32_t i = 0;
 
   for (i = 0; i < size; i++) {
@@ -420,19 +423,20 @@ typedef struct synth_thread_worker_s {
   int32_t *imageData; // Données d'image d'entrée (partagé)
 
   // Buffers de sortie locaux au thread
-  float thread_ifftBuffer[AUDIO_BUFFER_SIZE];
-  float thread_sumVolumeBuffer[AUDIO_BUFFER_SIZE];
-  float thread_maxVolumeBuffer[AUDIO_BUFFER_SIZE];
+  float thread_ifftBuffer[AUDIO_BUFFER_SIZE_MAX];
+  float thread_sumVolumeBuffer[AUDIO_BUFFER_SIZE_MAX];
+  float thread_maxVolumeBuffer[AUDIO_BUFFER_SIZE_MAX];
 
   // Buffers de travail locaux (évite VLA sur pile)
   int32_t imageBuffer_q31[NUMBER_OF_NOTES / 3 + 100]; // +100 pour sécurité
   float imageBuffer_f32[NUMBER_OF_NOTES / 3 + 100];
-  float waveBuffer[AUDIO_BUFFER_SIZE];
-  float volumeBuffer[AUDIO_BUFFER_SIZE];
+  float waveBuffer[AUDIO_BUFFER_SIZE_MAX];
+  float volumeBuffer[AUDIO_BUFFER_SIZE_MAX];
 
-  // Données waves[] pré-calculées (lecture seule)
-  int32_t precomputed_new_idx[NUMBER_OF_NOTES / 3 + 100][AUDIO_BUFFER_SIZE];
-  float precomputed_wave_data[NUMBER_OF_NOTES / 3 + 100][AUDIO_BUFFER_SIZE];
+  // Données waves[] pré-calculées (lecture seule), allouées au démarrage :
+  // [note locale * g_audio_buffer_size + échantillon]
+  int32_t *precomputed_new_idx;
+  float *precomputed_wave_data;
   float precomputed_volume[NUMBER_OF_NOTES / 3 + 100];
   float precomputed_volume_increment[NUMBER_OF_NOTES / 3 + 100];
   float precomputed_volume_decrement[NUMBER_OF_NOTES / 3 + 100];
@@ -474,6 +478,18 @@ static int synth_init_thread_pool(void) {
     worker->work_ready = 0;
     worker->work_done = 0;
 
+    // Tables pré-calculées dimensionnées pour la taille de buffer choisie
+    size_t table_len =
+        (size_t)(worker->end_note - worker->start_note) * g_audio_buffer_size;
+    if (!worker->precomputed_new_idx)
+      worker->precomputed_new_idx = malloc(table_len * sizeof(int32_t));
+    if (!worker->precomputed_wave_data)
+      worker->precomputed_wave_data = malloc(table_len * sizeof(float));
+    if (!worker->precomputed_new_idx || !worker->precomputed_wave_data) {
+      printf("Erreur d'allocation des tables pré-calculées du thread %d\n", i);
+      return -1;
+    }
+
     // Initialisation de la synchronisation
     if (pthread_mutex_init(&worker->work_mutex, NULL) != 0) {
       printf("Erreur lors de l'initialisation du mutex pour le thread %d\n", i);
@@ -499,6 +515,8 @@ static int synth_init_thread_pool(void) {
 void *synth_persistent_worker_thread(void *arg) {
   synth_thread_worker_t *worker = (synth_thread_worker_t *)arg;
 
+  enable_flush_to_zero();
+
   while (!synth_pool_shutdown) {
     // Attendre du travail
     pthread_mutex_lock(&worker->work_mutex);
@@ -526,15 +544,19 @@ void *synth_persistent_worker_thread(void *arg) {
 /**
  * @brief  Traite une plage de notes pour un worker donné
  * @param  worker Pointeur vers la structure du worker
+ * @param  buffer_size Taille du buffer, constante dans les versions
+ *         spécialisées ci-dessous
  * @retval None
  */
-static void synth_process_worker_range(synth_thread_worker_t *worker) {
+static inline __attribute__((always_inline)) void
+synth_process_worker_range_n(synth_thread_worker_t *worker,
+                             const int32_t buffer_size) {
   int32_t idx, acc, new_idx, buff_idx, note, local_note_idx;
 
   // Initialiser les buffers de sortie à zéro
-  fill_float(0, worker->thread_ifftBuffer, AUDIO_BUFFER_SIZE);
-  fill_float(0, worker->thread_sumVolumeBuffer, AUDIO_BUFFER_SIZE);
-  fill_float(0, worker->thread_maxVolumeBuffer, AUDIO_BUFFER_SIZE);
+  fill_float(0, worker->thread_ifftBuffer, buffer_size);
+  fill_float(0, worker->thread_sumVolumeBuffer, buffer_size);
+  fill_float(0, worker->thread_maxVolumeBuffer, buffer_size);
 
   // Prétraitement: calcul des moyennes et transformation en imageBuffer_q31
   for (idx = worker->start_note; idx < worker->end_note; idx++) {
@@ -602,9 +624,10 @@ static void synth_process_worker_range(synth_thread_worker_t *worker) {
 
     // Utiliser les données pré-calculées pour éviter les accès concurrents à
     // waves[]
-    for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE; buff_idx++) {
-      worker->waveBuffer[buff_idx] =
-          worker->precomputed_wave_data[local_note_idx][buff_idx];
+    const float *precomputed_wave =
+        &worker->precomputed_wave_data[local_note_idx * buffer_size];
+    for (buff_idx = 0; buff_idx < buffer_size; buff_idx++) {
+      worker->waveBuffer[buff_idx] = precomputed_wave[buff_idx];
     }
 
 #ifdef GAP_LIMITER
@@ -614,7 +637,7 @@ static void synth_process_worker_range(synth_thread_worker_t *worker) {
 
     // Calculer dynamiquement le volume avec gap limiter (accès direct à
     // waves[])
-    for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE - 1; buff_idx++) {
+    for (buff_idx = 0; buff_idx < buffer_size - 1; buff_idx++) {
       if (waves[note].current_volume < target_volume) {
         waves[note].current_volume += waves[note].volume_increment;
         if (waves[note].current_volume > target_volume) {
@@ -632,20 +655,20 @@ static void synth_process_worker_range(synth_thread_worker_t *worker) {
     }
 
     // Fill remaining buffer with final volume value
-    if (buff_idx < AUDIO_BUFFER_SIZE) {
+    if (buff_idx < buffer_size) {
       fill_float(waves[note].current_volume, &worker->volumeBuffer[buff_idx],
-                 AUDIO_BUFFER_SIZE - buff_idx);
+                 buffer_size - buff_idx);
     }
 #else
     fill_float(worker->imageBuffer_f32[local_note_idx], worker->volumeBuffer,
-               AUDIO_BUFFER_SIZE);
+               buffer_size);
 #endif
 
     // Apply volume scaling to the current note waveform
     mult_float(worker->waveBuffer, worker->volumeBuffer, worker->waveBuffer,
-               AUDIO_BUFFER_SIZE);
+               buffer_size);
 
-    for (buff_idx = AUDIO_BUFFER_SIZE; --buff_idx >= 0;) {
+    for (buff_idx = buffer_size; --buff_idx >= 0;) {
       if (worker->volumeBuffer[buff_idx] >
           worker->thread_maxVolumeBuffer[buff_idx]) {
         worker->thread_maxVolumeBuffer[buff_idx] =
@@ -655,10 +678,39 @@ static void synth_process_worker_range(synth_thread_worker_t *worker) {
 
     // IFFT summation (local au thread)
     add_float(worker->waveBuffer, worker->thread_ifftBuffer,
-              worker->thread_ifftBuffer, AUDIO_BUFFER_SIZE);
+              worker->thread_ifftBuffer, buffer_size);
     // Volume summation (local au thread)
     add_float(worker->volumeBuffer, worker->thread_sumVolumeBuffer,
-              worker->thread_sumVolumeBuffer, AUDIO_BUFFER_SIZE);
+              worker->thread_sumVolumeBuffer, buffer_size);
+  }
+}
+
+// Versions spécialisées à la compilation pour les combinaisons courantes
+// (48kHz/150 et 96kHz/600) : avec une longueur constante, le compilateur
+// déroule et vectorise les boucles sans boucle de reste.
+static void synth_process_worker_range_48k(synth_thread_worker_t *worker) {
+  synth_process_worker_range_n(worker, AUDIO_FAST_PATH_SIZE_48K);
+}
+
+static void synth_process_worker_range_96k(synth_thread_worker_t *worker) {
+  synth_process_worker_range_n(worker, AUDIO_FAST_PATH_SIZE_96K);
+}
+
+static void synth_process_worker_range_any(synth_thread_worker_t *worker) {
+  synth_process_worker_range_n(worker, (int32_t)g_audio_buffer_size);
+}
+
+static void synth_process_worker_range(synth_thread_worker_t *worker) {
+  switch (g_audio_buffer_size) {
+  case AUDIO_FAST_PATH_SIZE_48K:
+    synth_process_worker_range_48k(worker);
+    break;
+  case AUDIO_FAST_PATH_SIZE_96K:
+    synth_process_worker_range_96k(worker);
+    break;
+  default:
+    synth_process_worker_range_any(worker);
+    break;
   }
 }
 
@@ -669,6 +721,8 @@ static void synth_process_worker_range(synth_thread_worker_t *worker) {
  * @retval None
  */
 static void synth_precompute_wave_data(int32_t *imageData) {
+  const int buffer_size = (int)g_audio_buffer_size;
+
   // ✅ OPTIMISATION: Pré-calcul parallélisé pour équilibrer la charge CPU
 
   // Phase 1: Assignation des données d'image (thread-safe, lecture seule)
@@ -685,17 +739,20 @@ static void synth_precompute_wave_data(int32_t *imageData) {
 
     for (int note = worker->start_note; note < worker->end_note; note++) {
       int local_note_idx = note - worker->start_note;
+      int32_t *precomputed_idx =
+          &worker->precomputed_new_idx[local_note_idx * buffer_size];
+      float *precomputed_wave =
+          &worker->precomputed_wave_data[local_note_idx * buffer_size];
 
       // Pré-calculer les données de forme d'onde
-      for (int buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE; buff_idx++) {
+      for (int buff_idx = 0; buff_idx < buffer_size; buff_idx++) {
         int32_t new_idx = (waves[note].current_idx + waves[note].octave_coeff);
         if ((uint32_t)new_idx >= waves[note].area_size) {
           new_idx -= waves[note].area_size;
         }
 
-        worker->precomputed_new_idx[local_note_idx][buff_idx] = new_idx;
-        worker->precomputed_wave_data[local_note_idx][buff_idx] =
-            (*(waves[note].start_ptr + new_idx));
+        precomputed_idx[buff_idx] = new_idx;
+        precomputed_wave[buff_idx] = (*(waves[note].start_ptr + new_idx));
         waves[note].current_idx = new_idx;
       }
 
@@ -769,6 +826,10 @@ void synth_shutdown_thread_pool(void) {
     pthread_join(worker_threads[i], NULL);
     pthread_mutex_destroy(&thread_pool[i].work_mutex);
     pthread_cond_destroy(&thread_pool[i].work_cond);
+    free(thread_pool[i].precomputed_new_idx);
+    free(thread_pool[i].precomputed_wave_data);
+    thread_pool[i].precomputed_new_idx = NULL;
+    thread_pool[i].precomputed_wave_data = NULL;
   }
 
   synth_pool_initialized = 0;
@@ -793,6 +854,7 @@ void synth_IfftMode(
   static int32_t signal_R;
   static int buff_idx;
   static int first_call = 1;
+  const int buffer_size = (int)g_audio_buffer_size;
 
   // Initialiser le pool de threads si première fois
   if (first_call) {
@@ -813,16 +875,16 @@ void synth_IfftMode(
   }
 
   // Buffers finaux pour les résultats combinés
-  static float ifftBuffer[AUDIO_BUFFER_SIZE];
-  static float sumVolumeBuffer[AUDIO_BUFFER_SIZE];
-  static float maxVolumeBuffer[AUDIO_BUFFER_SIZE];
+  static float ifftBuffer[AUDIO_BUFFER_SIZE_MAX];
+  static float sumVolumeBuffer[AUDIO_BUFFER_SIZE_MAX];
+  static float maxVolumeBuffer[AUDIO_BUFFER_SIZE_MAX];
 
   // Réinitialiser les buffers finaux
-  fill_float(0, ifftBuffer, AUDIO_BUFFER_SIZE);
-  fill_float(0, sumVolumeBuffer, AUDIO_BUFFER_SIZE);
-  fill_float(0, maxVolumeBuffer, AUDIO_BUFFER_SIZE);
+  fill_float(0, ifftBuffer, buffer_size);
+  fill_float(0, sumVolumeBuffer, buffer_size);
+  fill_float(0, maxVolumeBuffer, buffer_size);
 
-  float tmp_audioData[AUDIO_BUFFER_SIZE];
+  float tmp_audioData[AUDIO_BUFFER_SIZE_MAX];
 
   if (synth_pool_initialized && !synth_pool_shutdown) {
     // === VERSION OPTIMISÉE AVEC POOL DE THREADS ===
@@ -859,7 +921,7 @@ void synth_IfftMode(
         float thread_max = thread_pool[i].thread_ifftBuffer[0];
         float thread_sum = 0.0f;
 
-        for (int j = 0; j < AUDIO_BUFFER_SIZE; j++) {
+        for (int j = 0; j < buffer_size; j++) {
           float val = thread_pool[i].thread_ifftBuffer[j];
           if (val < thread_min)
             thread_min = val;
@@ -868,7 +930,7 @@ void synth_IfftMode(
           thread_sum += val * val; // Pour RMS
         }
 
-        float thread_rms = sqrtf(thread_sum / AUDIO_BUFFER_SIZE);
+        float thread_rms = sqrtf(thread_sum / buffer_size);
         printf("🔍 THREAD %d: min=%.6f, max=%.6f, rms=%.6f\n", i, thread_min,
                thread_max, thread_rms);
       }
@@ -877,12 +939,12 @@ void synth_IfftMode(
     // Phase 4: Combiner les résultats des threads avec normalisation
     for (int i = 0; i < 3; i++) {
       add_float(thread_pool[i].thread_ifftBuffer, ifftBuffer, ifftBuffer,
-                AUDIO_BUFFER_SIZE);
+                buffer_size);
       add_float(thread_pool[i].thread_sumVolumeBuffer, sumVolumeBuffer,
-                sumVolumeBuffer, AUDIO_BUFFER_SIZE);
+                sumVolumeBuffer, buffer_size);
 
       // Pour maxVolumeBuffer, prendre le maximum
-      for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE; buff_idx++) {
+      for (buff_idx = 0; buff_idx < buffer_size; buff_idx++) {
         if (thread_pool[i].thread_maxVolumeBuffer[buff_idx] >
             maxVolumeBuffer[buff_idx]) {
           maxVolumeBuffer[buff_idx] =
@@ -898,7 +960,7 @@ void synth_IfftMode(
       float raw_max = ifftBuffer[0];
       float raw_sum = 0.0f;
 
-      for (int j = 0; j < AUDIO_BUFFER_SIZE; j++) {
+      for (int j = 0; j < buffer_size; j++) {
         float val = ifftBuffer[j];
         if (val < raw_min)
           raw_min = val;
@@ -907,7 +969,7 @@ void synth_IfftMode(
         raw_sum += val * val;
       }
 
-      float raw_rms = sqrtf(raw_sum / AUDIO_BUFFER_SIZE);
+      float raw_rms = sqrtf(raw_sum / buffer_size);
       printf("🔍 AVANT NORMALISATION: min=%.6f, max=%.6f, rms=%.6f\n", raw_min,
              raw_max, raw_rms);
     }
@@ -915,9 +977,9 @@ void synth_IfftMode(
     // 🔧 CORRECTION: Normalisation conditionnelle par plateforme
 #ifdef __linux__
     // Pi/Linux : Diviser par 3 (BossDAC/ALSA amplifie naturellement)
-    scale_float(ifftBuffer, 1.0f / 3.0f, AUDIO_BUFFER_SIZE);
-    scale_float(sumVolumeBuffer, 1.0f / 3.0f, AUDIO_BUFFER_SIZE);
-    scale_float(maxVolumeBuffer, 1.0f / 3.0f, AUDIO_BUFFER_SIZE);
+    scale_float(ifftBuffer, 1.0f / 3.0f, buffer_size);
+    scale_float(sumVolumeBuffer, 1.0f / 3.0f, buffer_size);
+    scale_float(maxVolumeBuffer, 1.0f / 3.0f, buffer_size);
 #else
     // Mac : Pas de division (CoreAudio ne compense pas automatiquement)
     // Signal gardé à pleine amplitude pour volume normal
@@ -930,7 +992,7 @@ void synth_IfftMode(
       float norm_max = ifftBuffer[0];
       float norm_sum = 0.0f;
 
-      for (int j = 0; j < AUDIO_BUFFER_SIZE; j++) {
+      for (int j = 0; j < buffer_size; j++) {
         float val = ifftBuffer[j];
         if (val < norm_min)
           norm_min = val;
@@ -939,7 +1001,7 @@ void synth_IfftMode(
         norm_sum += val * val;
       }
 
-      float norm_rms = sqrtf(norm_sum / AUDIO_BUFFER_SIZE);
+      float norm_rms = sqrtf(norm_sum / buffer_size);
       printf("🔍 APRÈS NORMALISATION: min=%.6f, max=%.6f, rms=%.6f\n", norm_min,
              norm_max, norm_rms);
     }
@@ -950,7 +1012,7 @@ void synth_IfftMode(
       float accum_max = ifftBuffer[0];
       float accum_sum = 0.0f;
 
-      for (int j = 0; j < AUDIO_BUFFER_SIZE; j++) {
+      for (int j = 0; j < buffer_size; j++) {
         float val = ifftBuffer[j];
         if (val < accum_min)
           accum_min = val;
@@ -959,7 +1021,7 @@ void synth_IfftMode(
         accum_sum += val * val;
       }
 
-      float accum_rms = sqrtf(accum_sum / AUDIO_BUFFER_SIZE);
+      float accum_rms = sqrtf(accum_sum / buffer_size);
       printf("🎯 ACCUMULATION: min=%.6f, max=%.6f, rms=%.6f\n", accum_min,
              accum_max, accum_rms);
     }
@@ -971,8 +1033,8 @@ void synth_IfftMode(
     // === FALLBACK MODE SÉQUENTIEL (pour compatibilité/debug) ===
     static int32_t imageBuffer_q31[NUMBER_OF_NOTES];
     static float imageBuffer_f32[NUMBER_OF_NOTES];
-    static float waveBuffer[AUDIO_BUFFER_SIZE];
-    static float volumeBuffer[AUDIO_BUFFER_SIZE];
+    static float waveBuffer[AUDIO_BUFFER_SIZE_MAX];
+    static float volumeBuffer[AUDIO_BUFFER_SIZE_MAX];
 
     // Version séquentielle simplifiée de l'algorithme original
     int32_t idx, acc, new_idx, note;
@@ -1019,7 +1081,7 @@ void synth_IfftMode(
 #endif
 
       // Génération des formes d'onde
-      for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE; buff_idx++) {
+      for (buff_idx = 0; buff_idx < buffer_size; buff_idx++) {
         new_idx = (waves[note].current_idx + waves[note].octave_coeff);
         if ((uint32_t)new_idx >= waves[note].area_size) {
           new_idx -= waves[note].area_size;
@@ -1030,7 +1092,7 @@ void synth_IfftMode(
 
 #ifdef GAP_LIMITER
       // Gap limiter
-      for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE - 1; buff_idx++) {
+      for (buff_idx = 0; buff_idx < buffer_size - 1; buff_idx++) {
         if (waves[note].current_volume < imageBuffer_f32[note]) {
           waves[note].current_volume += waves[note].volume_increment;
           if (waves[note].current_volume > imageBuffer_f32[note]) {
@@ -1046,35 +1108,35 @@ void synth_IfftMode(
         }
         volumeBuffer[buff_idx] = waves[note].current_volume;
       }
-      if (buff_idx < AUDIO_BUFFER_SIZE) {
+      if (buff_idx < buffer_size) {
         fill_float(waves[note].current_volume, &volumeBuffer[buff_idx],
-                   AUDIO_BUFFER_SIZE - buff_idx);
+                   buffer_size - buff_idx);
       }
 #else
-      fill_float(imageBuffer_f32[note], volumeBuffer, AUDIO_BUFFER_SIZE);
+      fill_float(imageBuffer_f32[note], volumeBuffer, buffer_size);
 #endif
 
       // Apply volume scaling
-      mult_float(waveBuffer, volumeBuffer, waveBuffer, AUDIO_BUFFER_SIZE);
+      mult_float(waveBuffer, volumeBuffer, waveBuffer, buffer_size);
 
-      for (buff_idx = AUDIO_BUFFER_SIZE; --buff_idx >= 0;) {
+      for (buff_idx = buffer_size; --buff_idx >= 0;) {
         if (volumeBuffer[buff_idx] > maxVolumeBuffer[buff_idx]) {
           maxVolumeBuffer[buff_idx] = volumeBuffer[buff_idx];
         }
       }
 
       // Accumulation
-      add_float(waveBuffer, ifftBuffer, ifftBuffer, AUDIO_BUFFER_SIZE);
+      add_float(waveBuffer, ifftBuffer, ifftBuffer, buffer_size);
       add_float(volumeBuffer, sumVolumeBuffer, sumVolumeBuffer,
-                AUDIO_BUFFER_SIZE);
+                buffer_size);
     }
   }
 
   // === PHASE FINALE (commune aux deux modes) ===
-  mult_float(ifftBuffer, maxVolumeBuffer, ifftBuffer, AUDIO_BUFFER_SIZE);
-  scale_float(sumVolumeBuffer, VOLUME_AMP_RESOLUTION / 2, AUDIO_BUFFER_SIZE);
+  mult_float(ifftBuffer, maxVolumeBuffer, ifftBuffer, buffer_size);
+  scale_float(sumVolumeBuffer, VOLUME_AMP_RESOLUTION / 2, buffer_size);
 
-  for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE; buff_idx++) {
+  for (buff_idx = 0; buff_idx < buffer_size; buff_idx++) {
     if (sumVolumeBuffer[buff_idx] != 0) {
       signal_R = (int32_t)(ifftBuffer[buff_idx] / (sumVolumeBuffer[buff_idx]));
     } else {
@@ -1086,60 +1148,23 @@ void synth_IfftMode(
   // Calculer le facteur de contraste basé sur l'image
   float contrast_factor = calculate_contrast(imageData, CIS_MAX_PIXELS_NB);
 
-  // Apply contrast modulation
-  float min_level = 0.0f, max_level = 0.0f;
-  for (buff_idx = 0; buff_idx < AUDIO_BUFFER_SIZE; buff_idx++) {
+  // Apply contrast modulation. Clipping is handled (and counted) on the
+  // master bus: lookahead limiter, then OP_OUTPUT telemetry.
+  for (buff_idx = 0; buff_idx < buffer_size; buff_idx++) {
     audioData[buff_idx] = tmp_audioData[buff_idx] * contrast_factor;
-
-    // Track min/max for debug
-    if (buff_idx == 0 || audioData[buff_idx] < min_level)
-      min_level = audioData[buff_idx];
-    if (buff_idx == 0 || audioData[buff_idx] > max_level)
-      max_level = audioData[buff_idx];
-  }
-
-  // 🔍 DIAGNOSTIC: Analyser la sortie finale et détecter la saturation
-  if (log_counter % LOG_FREQUENCY == 0) {
-    float final_rms = 0.0f;
-    int clipped_samples = 0;
-
-    for (int j = 0; j < AUDIO_BUFFER_SIZE; j++) {
-      final_rms += audioData[j] * audioData[j];
-      if (audioData[j] >= 0.95f || audioData[j] <= -0.95f) {
-        clipped_samples++;
-      }
-    }
-    final_rms = sqrtf(final_rms / AUDIO_BUFFER_SIZE);
-
-    printf("🎯 FINAL OUTPUT: min=%.6f, max=%.6f, rms=%.6f, contrast=%.2f\n",
-           min_level, max_level, final_rms, contrast_factor);
-    printf("📊 MODE: %s, CLIPPED: %d/%d samples\n",
-           synth_pool_initialized ? "PARALLEL" : "SEQUENTIAL", clipped_samples,
-           AUDIO_BUFFER_SIZE);
-
-#ifdef __linux__
-    printf("🐧 LINUX/Pi: Signal brut vers BossDAC (pas de protection)\n");
-#else
-    printf("🍎 MAC: CoreAudio avec normalisation automatique\n");
-#endif
-
-    if (clipped_samples > 0) {
-      printf("⚠️  SATURATION DÉTECTÉE: %d échantillons clippés!\n",
-             clipped_samples);
-    }
   }
 
   // Incrémenter le compteur global pour la limitation des logs
   log_counter++;
 
-  shared_var.synth_process_cnt += AUDIO_BUFFER_SIZE;
+  shared_var.synth_process_cnt += buffer_size;
 }
 // #pragma GCC pop_options
 
 // Fonction de traitement audio
 // Synth process function
-void synth_AudioProcess(uint8_t *buffer_R, uint8_t *buffer_G,
-                        uint8_t *buffer_B) {
+void synth_AudioProcess(const uint8_t *buffer_R, const uint8_t *buffer_G,
+                        const uint8_t *buffer_B) {
   // Traitement audio (logs limités)
   if (log_counter % LOG_FREQUENCY == 0) {
     // printf("===== Audio Process appelé =====\n"); // Supprimé ou commenté
@@ -1163,39 +1188,39 @@ void synth_AudioProcess(uint8_t *buffer_R, uint8_t *buffer_G,
   }
   pthread_mutex_unlock(&buffers_R[index].mutex);
 
+  double render_start = audio_telemetry_now();
+
 #if 1
   // On lance la conversion en niveaux de gris
   greyScale(buffer_R, buffer_G, buffer_B, g_grayScale_live, CIS_MAX_PIXELS_NB);
 
   // --- Synth Data Freeze/Fade Logic ---
-  pthread_mutex_lock(&g_synth_data_freeze_mutex);
-  int local_is_frozen = g_is_synth_data_frozen;
-  int local_is_fading = g_is_synth_data_fading_out;
-
-  static int prev_frozen_state_synth = 0;
-  if (local_is_frozen && !prev_frozen_state_synth && !local_is_fading) {
+  // Freeze requested by the MIDI thread through the parameter store (one
+  // atomic load per buffer); the freeze and fade state is this thread's own
+  static int local_is_frozen = 0;
+  static int local_is_fading = 0;
+  static double fade_start_time = 0.0;
+  const int freeze_requested =
+      audio_params_get(AUDIO_PARAM_SYNTH_FREEZE) > 0.5f;
+
+  if (freeze_requested && !local_is_frozen) {
     memcpy(g_frozen_grayscale_buffer, g_grayScale_live,
            sizeof(g_grayScale_live));
+    local_is_frozen = 1;
+  } else if (freeze_requested && local_is_fading) {
+    local_is_fading = 0; // Frozen again: back to the held image
+  } else if (!freeze_requested && local_is_frozen && !local_is_fading) {
+    local_is_fading = 1;
+    fade_start_time = synth_getCurrentTimeInSeconds();
   }
-  prev_frozen_state_synth = local_is_frozen;
-
-  static int prev_fading_state_synth = 0;
-  if (local_is_fading && !prev_fading_state_synth) {
-    g_synth_data_fade_start_time = synth_getCurrentTimeInSeconds();
-  }
-  prev_fading_state_synth = local_is_fading;
-  pthread_mutex_unlock(&g_synth_data_freeze_mutex);
 
   float alpha_blend = 1.0f; // For cross-fade
 
   if (local_is_fading) {
-    double elapsed_time =
-        synth_getCurrentTimeInSeconds() - g_synth_data_fade_start_time;
+    double elapsed_time = synth_getCurrentTimeInSeconds() - fade_start_time;
     if (elapsed_time >= G_SYNTH_DATA_FADE_DURATION_SECONDS) {
-      pthread_mutex_lock(&g_synth_data_freeze_mutex);
-      g_is_synth_data_fading_out = 0;
-      g_is_synth_data_frozen = 0;
-      pthread_mutex_unlock(&g_synth_data_freeze_mutex);
+      local_is_fading = 0;
+      local_is_frozen = 0;
       memcpy(processed_grayScale, g_grayScale_live,
              sizeof(g_grayScale_live)); // Use live data
     } else {
@@ -1252,9 +1277,9 @@ void synth_AudioProcess(uint8_t *buffer_R, uint8_t *buffer_G,
   printf("Test audio: génération d'une onde sinusoïdale de 440Hz dans "
          "buffer[%d]\n",
          index);
-  for (int i = 0; i < AUDIO_BUFFER_SIZE; i++) {
+  for (int i = 0; i < (int)g_audio_buffer_size; i++) {
     buffers_R[index].data[i] = 0.5f * sinf(phase); // Amplitude de 0.5 (50%)
-    phase += (TWO_PI * 440) / SAMPLING_FREQUENCY;
+    phase += (TWO_PI * 440) / g_sampling_frequency;
 
     // Éviter que phase devienne trop grand
     if (phase >= TWO_PI) {
@@ -1267,6 +1292,11 @@ void synth_AudioProcess(uint8_t *buffer_R, uint8_t *buffer_G,
          buffers_R[index].data[1], buffers_R[index].data[2]);
 #endif
 
+  // Telemetry: render time of this buffer against its playback period
+  audio_telemetry_render(AUDIO_ENGINE_IFFT,
+                         audio_telemetry_now() - render_start,
+                         (double)g_audio_buffer_size / g_sampling_frequency);
+
   // Marquer le buffer comme prêt
   pthread_mutex_lock(&buffers_R[index].mutex);
   buffers_R[index].ready = 1;
@@ -17,13 +17,10 @@
 
 /* Private includes ----------------------------------------------------------*/
 
-/* Synth Data Freeze Feature */
-extern volatile int g_is_synth_data_frozen;
+/* Synth Data Freeze Feature: requested through AUDIO_PARAM_SYNTH_FREEZE,
+ * freeze and fade state owned by the synth thread */
 extern int32_t g_frozen_grayscale_buffer[CIS_MAX_PIXELS_NB];
-extern volatile int g_is_synth_data_fading_out;
-extern double g_synth_data_fade_start_time;
 extern const double G_SYNTH_DATA_FADE_DURATION_SECONDS;
-extern pthread_mutex_t g_synth_data_freeze_mutex;
 
 void synth_data_freeze_init(void);
 void synth_data_freeze_cleanup(void);
@@ -47,8 +44,8 @@ void displayable_synth_buffers_cleanup(void);
 
 /* Exported functions prototypes ---------------------------------------------*/
 int32_t synth_IfftInit(void);
-void synth_AudioProcess(uint8_t *buffer_R, uint8_t *buffer_G,
-                        uint8_t *buffer_B);
+void synth_AudioProcess(const uint8_t *buffer_R, const uint8_t *buffer_G,
+                        const uint8_t *buffer_B);
 /* Private defines -----------------------------------------------------------*/
 
 #endif /* __SYNTH_H */
@@ -3,11 +3,16 @@
  */
 
 #include "synth_fft.h"
+#include "audio_format.h"
+#include "audio_telemetry.h"
 #include "config.h"
 #include "context.h"
+#include "denormals.h"
 #include "doublebuffer.h"
 #include "error.h"
+#include "midi_event_queue.h"
 #include <errno.h>
+#include <limits.h>
 #include <math.h>
 #include <pthread.h>
 #include <stdio.h>
@@ -30,17 +35,30 @@ static void adsr_update_settings_and_recalculate_rates(
     float sample_rate); // New forward declaration
 static void adsr_trigger_attack(AdsrEnvelope *env);
 static void adsr_trigger_release(AdsrEnvelope *env);
-static float adsr_get_output(AdsrEnvelope *env);
+static unsigned int adsr_render_block(AdsrEnvelope *env, float *out,
+                                      unsigned int n);
 static void filter_init_spectral_params(SpectralFilterParams *fp,
                                         float base_cutoff_hz,
                                         float filter_env_depth);
 static void lfo_init(LfoState *lfo, float rate_hz, float depth_semitones,
                      float sample_rate);
-static float lfo_process(LfoState *lfo);
+static void lfo_render_block(LfoState *lfo, float *out, unsigned int n);
 static void process_image_data_for_fft(DoubleBuffer *image_db);
+static void push_line_and_compute_fft(const float *line);
+static int find_oldest_active_voice(int num_voices);
+static int find_quietest_release_voice(int num_voices);
+static void voice_force_idle(SynthVoice *voice);
+static void update_render_load(const struct timespec *start,
+                               const struct timespec *end);
+static void render_voices(float *audio_buffer, unsigned int start,
+                          unsigned int end);
+static void apply_midi_event(const MidiEvent *event);
+static void apply_note_on(int noteNumber, int velocity);
+static void apply_note_off(int noteNumber);
 static void generate_test_data_for_fft(void);
 
 // --- Synth Parameters & Globals ---
+#define MAX_MIDI_EVENTS_PER_BLOCK 256 // Extra events wait for the next block
 #define NORM_FACTOR_BIN0 881280.0f * 1.1f
 #define NORM_FACTOR_HARMONICS 220320.0f * 2.0f
 #define MASTER_VOLUME 0.10f
@@ -56,7 +74,10 @@ static void generate_test_data_for_fft(void);
 // Polyphony related globals
 unsigned long long g_current_trigger_order =
     0; // Global trigger order counter, starts at 0
-SynthVoice poly_voices[NUM_POLY_VOICES];
+SynthVoice poly_voices[MAX_POLY_VOICES]; // Preallocated, see g_num_poly_voices
+volatile int g_num_poly_voices = DEFAULT_NUM_POLY_VOICES;
+volatile float g_fft_render_load = 0.0f;
+volatile unsigned long g_fft_voices_shed = 0;
 float global_smoothed_magnitudes[MAX_MAPPED_OSCILLATORS];
 SpectralFilterParams global_spectral_filter_params;
 LfoState global_vibrato_lfo; // Definition for the global LFO
@@ -81,9 +102,12 @@ FftAudioDataBuffer fft_audio_buffers[2];
 volatile int fft_current_buffer_index = 0;
 pthread_mutex_t fft_buffer_index_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-GrayscaleLine image_line_history[MOVING_AVERAGE_WINDOW_SIZE];
+GrayscaleLine image_line_history[MAX_MOVING_AVERAGE_WINDOW_SIZE];
 int history_write_index = 0;
 int history_fill_count = 0;
+double image_line_running_sum[CIS_MAX_PIXELS_NB];
+volatile int g_moving_average_window = DEFAULT_MOVING_AVERAGE_WINDOW_SIZE;
+static int g_active_average_window = DEFAULT_MOVING_AVERAGE_WINDOW_SIZE;
 pthread_mutex_t image_history_mutex = PTHREAD_MUTEX_INITIALIZER;
 FftContext fft_context;
 
@@ -101,7 +125,7 @@ void synth_fftMode_init(void) {
       die("Failed to initialize FFT audio buffer condition variable");
     }
     fft_audio_buffers[i].ready = 0;
-    memset(fft_audio_buffers[i].data, 0, AUDIO_BUFFER_SIZE * sizeof(float));
+    memset(fft_audio_buffers[i].data, 0, sizeof(fft_audio_buffers[i].data));
   }
   if (pthread_mutex_init(&fft_buffer_index_mutex, NULL) != 0) {
     die("Failed to initialize FFT buffer index mutex");
@@ -117,12 +141,17 @@ void synth_fftMode_init(void) {
   for (int i = 0; i < CIS_MAX_PIXELS_NB; ++i) {
     default_white_line[i] = 255.0f; // Max brightness for a white line
   }
-  for (int i = 0; i < MOVING_AVERAGE_WINDOW_SIZE; ++i) {
+  for (int i = 0; i < MAX_MOVING_AVERAGE_WINDOW_SIZE; ++i) {
     memcpy(image_line_history[i].line_data, default_white_line,
            CIS_MAX_PIXELS_NB * sizeof(float));
   }
   history_fill_count =
-      MOVING_AVERAGE_WINDOW_SIZE; // History is now full with default data
+      MAX_MOVING_AVERAGE_WINDOW_SIZE; // History is now full with default data
+  g_active_average_window = g_moving_average_window;
+  for (int i = 0; i < CIS_MAX_PIXELS_NB; ++i) {
+    image_line_running_sum[i] =
+        (double)default_white_line[i] * g_active_average_window;
+  }
   printf("synth_fftMode: Image history pre-filled with default white lines. "
          "Fill count: %d\n",
          history_fill_count);
@@ -142,11 +171,11 @@ void synth_fftMode_init(void) {
          global_spectral_filter_params.filter_env_depth);
 
   lfo_init(&global_vibrato_lfo, G_LFO_RATE_HZ, G_LFO_DEPTH_SEMITONES,
-           (float)SAMPLING_FREQUENCY);
+           (float)g_sampling_frequency);
   printf("Global Vibrato LFO initialized: Rate=%.2f Hz, Depth=%.2f semitones\n",
          global_vibrato_lfo.rate_hz, global_vibrato_lfo.depth_semitones);
 
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+  for (int i = 0; i < MAX_POLY_VOICES; ++i) {
     poly_voices[i].fundamental_frequency = 0.0f;
     poly_voices[i].voice_state = ADSR_STATE_IDLE;
     poly_voices[i].midi_note_number = -1;
@@ -157,22 +186,23 @@ void synth_fftMode_init(void) {
     }
     adsr_init_envelope(&poly_voices[i].volume_adsr, G_VOLUME_ADSR_ATTACK_S,
                        G_VOLUME_ADSR_DECAY_S, G_VOLUME_ADSR_SUSTAIN_LEVEL,
-                       G_VOLUME_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+                       G_VOLUME_ADSR_RELEASE_S, (float)g_sampling_frequency);
     adsr_init_envelope(&poly_voices[i].filter_adsr, G_FILTER_ADSR_ATTACK_S,
                        G_FILTER_ADSR_DECAY_S, G_FILTER_ADSR_SUSTAIN_LEVEL,
-                       G_FILTER_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+                       G_FILTER_ADSR_RELEASE_S, (float)g_sampling_frequency);
   }
-  printf("%d polyphonic voices initialized.\n", NUM_POLY_VOICES);
+  printf("%d polyphonic voices initialized (%d preallocated).\n",
+         g_num_poly_voices, MAX_POLY_VOICES);
   printf("synth_fftMode initialized with moving average window of %d frames.\n",
-         MOVING_AVERAGE_WINDOW_SIZE);
+         g_active_average_window);
 }
 
 // --- Audio Processing ---
 
 // Counter for rate-limiting FFT debug prints
 static int g_fft_print_counter = 0;
-// Print roughly once per second (assuming SAMPLING_FREQUENCY=44100,
-// AUDIO_BUFFER_SIZE=512 -> ~86 calls/sec)
+// Print roughly once per second (assuming 44100 Hz and 512-frame buffers
+// -> ~86 calls/sec)
 #define FFT_PRINT_INTERVAL 86
 
 void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
@@ -182,6 +212,18 @@ void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
   }
   memset(audio_buffer, 0, buffer_size * sizeof(float));
 
+  // Drain pending MIDI events. The block is assumed to cover the buffer
+  // period that just ended, so an event lands at the same offset it had
+  // within that period (fixed latency of one buffer, jitter below it).
+  MidiEvent events[MAX_MIDI_EVENTS_PER_BLOCK];
+  int num_events = 0;
+  while (num_events < MAX_MIDI_EVENTS_PER_BLOCK &&
+         midi_event_queue_pop(&events[num_events])) {
+    num_events++;
+  }
+  const double block_start_s =
+      midi_event_queue_now() - (double)buffer_size / g_sampling_frequency;
+
   // Calculate smoothed magnitudes (original logic)
   global_smoothed_magnitudes[0] =
       fft_context.fft_output[0].r / NORM_FACTOR_BIN0;
@@ -205,40 +247,86 @@ void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
   // FFT Debug logging disabled for performance
   // (was causing audio dropouts due to printf() blocking)
 
-  for (unsigned int sample_idx = 0; sample_idx < buffer_size; ++sample_idx) {
-    float master_sample_sum = 0.0f;
-    float lfo_modulation_value =
-        lfo_process(&global_vibrato_lfo); // Process LFO per sample
+  // Render up to each event's sample offset, then apply it
+  unsigned int pos = 0;
+  for (int e = 0; e < num_events; ++e) {
+    double offset_s = events[e].time_s - block_start_s;
+    unsigned int offset = 0;
+    if (offset_s > 0.0) {
+      offset = (unsigned int)(offset_s * g_sampling_frequency);
+    }
+    if (offset >= buffer_size)
+      offset = buffer_size - 1;
+    if (offset < pos) // Keep queue order if timestamps step backwards
+      offset = pos;
+    render_voices(audio_buffer, pos, offset);
+    pos = offset;
+    apply_midi_event(&events[e]);
+  }
+  render_voices(audio_buffer, pos, buffer_size);
+}
+
+// Renders samples [start, end) of the block
+static void render_voices(float *audio_buffer, unsigned int start,
+                          unsigned int end) {
+  if (end <= start) {
+    return;
+  }
+  const unsigned int n = end - start;
+
+  // Snapshot the active voice count once per segment
+  const int num_voices = g_num_poly_voices;
+
+  // Block-rate modulation: LFO, its frequency factor and the envelopes are
+  // rendered once per segment into flat buffers, the sample loops below only
+  // read them.
+  float lfo_block[AUDIO_BUFFER_SIZE_MAX];
+  float freq_mod_block[AUDIO_BUFFER_SIZE_MAX];
+  float volume_env_block[AUDIO_BUFFER_SIZE_MAX];
+  float filter_env_block[AUDIO_BUFFER_SIZE_MAX];
+  float mix_block[AUDIO_BUFFER_SIZE_MAX];
+
+  lfo_render_block(&global_vibrato_lfo, lfo_block, n);
+  const float depth_octaves = global_vibrato_lfo.depth_semitones / 12.0f;
+  for (unsigned int i = 0; i < n; ++i) {
+    freq_mod_block[i] = exp2f(lfo_block[i] * depth_octaves);
+    mix_block[i] = 0.0f;
+  }
 
-    for (int v_idx = 0; v_idx < NUM_POLY_VOICES; ++v_idx) {
-      SynthVoice *current_voice = &poly_voices[v_idx];
-      float volume_adsr_val = adsr_get_output(&current_voice->volume_adsr);
-      float filter_adsr_val = adsr_get_output(&current_voice->filter_adsr);
+  for (int v_idx = 0; v_idx < num_voices; ++v_idx) {
+    SynthVoice *current_voice = &poly_voices[v_idx];
 
-      if (current_voice->volume_adsr.state == ADSR_STATE_IDLE &&
-          current_voice->voice_state != ADSR_STATE_IDLE) {
-        current_voice->voice_state = ADSR_STATE_IDLE;
-        current_voice->midi_note_number = -1;
-      }
+    if (current_voice->voice_state == ADSR_STATE_IDLE &&
+        current_voice->volume_adsr.state == ADSR_STATE_IDLE) {
+      continue;
+    }
 
-      if (volume_adsr_val < 0.00001f &&
-          current_voice->voice_state == ADSR_STATE_IDLE) {
-        continue;
-      }
+    // Samples before the volume envelope reaches IDLE (n if it does not)
+    unsigned int active_len =
+        adsr_render_block(&current_voice->volume_adsr, volume_env_block, n);
+    adsr_render_block(&current_voice->filter_adsr, filter_env_block, n);
+
+    if (current_voice->volume_adsr.state == ADSR_STATE_IDLE) {
+      current_voice->voice_state = ADSR_STATE_IDLE;
+      current_voice->midi_note_number = -1;
+    }
+
+    const float base_freq = current_voice->fundamental_frequency;
+    const float velocity = current_voice->last_velocity;
+
+    for (unsigned int i = 0; i < active_len; ++i) {
+      float volume_adsr_val = volume_env_block[i];
+      float filter_adsr_val = filter_env_block[i];
 
       float modulated_cutoff_hz =
           global_spectral_filter_params.base_cutoff_hz +
           filter_adsr_val * global_spectral_filter_params.filter_env_depth;
       modulated_cutoff_hz =
           fmaxf(20.0f, fminf(modulated_cutoff_hz,
-                             (float)SAMPLING_FREQUENCY / 2.0f - 1.0f));
+                             (float)g_sampling_frequency / 2.0f - 1.0f));
 
       // Apply LFO to fundamental frequency
-      float base_freq = current_voice->fundamental_frequency;
-      float freq_mod_factor = powf(
-          2.0f,
-          (lfo_modulation_value * global_vibrato_lfo.depth_semitones) / 12.0f);
-      float actual_fundamental_freq = base_freq * freq_mod_factor;
+      float actual_fundamental_freq = base_freq * freq_mod_block[i];
 
       float voice_sample_sum = 0.0f;
       // CPU Optimized harmonic processing loop
@@ -264,7 +352,7 @@ void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
 
         // Nyquist check: if harmonic frequency is too high, stop adding
         // harmonics
-        if (osc_freq >= (float)SAMPLING_FREQUENCY / 2.0f) {
+        if (osc_freq >= (float)g_sampling_frequency / 2.0f) {
           break;
         }
 
@@ -273,7 +361,8 @@ void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
         // CPU optimization: Skip harmonics with very low amplitude
         if (smoothed_amplitude < MIN_AUDIBLE_AMPLITUDE) {
           // Still update phase to maintain continuity
-          float phase_increment = TWO_PI * osc_freq / (float)SAMPLING_FREQUENCY;
+          float phase_increment =
+              TWO_PI * osc_freq / (float)g_sampling_frequency;
           current_voice->oscillators[osc_idx].phase += phase_increment;
           if (current_voice->oscillators[osc_idx].phase >= TWO_PI) {
             current_voice->oscillators[osc_idx].phase -= TWO_PI;
@@ -281,7 +370,8 @@ void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
           continue;
         }
 
-        float phase_increment = TWO_PI * osc_freq / (float)SAMPLING_FREQUENCY;
+        float phase_increment =
+            TWO_PI * osc_freq / (float)g_sampling_frequency;
 
         float amplitude_after_gamma = powf(smoothed_amplitude, AMPLITUDE_GAMMA);
         if (smoothed_amplitude < 0.0f &&
@@ -314,19 +404,14 @@ void synth_fftMode_process(float *audio_buffer, unsigned int buffer_size) {
         }
       }
 
-      voice_sample_sum *= volume_adsr_val;
-      voice_sample_sum *= current_voice->last_velocity;
-      master_sample_sum += voice_sample_sum;
+      mix_block[i] += voice_sample_sum * volume_adsr_val * velocity;
     }
+  }
 
-    master_sample_sum *= MASTER_VOLUME;
-
-    if (master_sample_sum > 1.0f)
-      master_sample_sum = 1.0f;
-    else if (master_sample_sum < -1.0f)
-      master_sample_sum = -1.0f;
-
-    audio_buffer[sample_idx] = master_sample_sum;
+  // Pas d'écrêtage ici: les crêtes sont gérées par le limiteur master
+  float *out = audio_buffer + start;
+  for (unsigned int i = 0; i < n; ++i) {
+    out[i] = mix_block[i] * MASTER_VOLUME;
   }
 }
 
@@ -336,61 +421,89 @@ static void process_image_data_for_fft(DoubleBuffer *image_db) {
     fprintf(stderr, "process_image_data_for_fft: image_db is NULL\n");
     return;
   }
-  pthread_mutex_lock(&image_db->mutex);
-  while (!image_db->dataReady && keepRunning) {
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    ts.tv_sec += 1;
-    int wait_ret =
-        pthread_cond_timedwait(&image_db->cond, &image_db->mutex, &ts);
-    if (wait_ret == ETIMEDOUT && !keepRunning) {
-      pthread_mutex_unlock(&image_db->mutex);
-      return;
-    }
+  // Wait for a line newer than the last one consumed (1s slices so that
+  // shutdown is noticed)
+  static uint32_t last_version = 0;
+  uint32_t version = last_version;
+  while (version == last_version && keepRunning) {
+    version = waitForNewImage(image_db, last_version, 1000);
   }
   if (!keepRunning) {
-    pthread_mutex_unlock(&image_db->mutex);
     return;
   }
 
+  // Newest line, read in place while converting it
+  ImageLineRef line;
+  initImageLineRef(&line);
+  last_version = acquireImageLine(image_db, &line);
+
   float current_grayscale_line[CIS_MAX_PIXELS_NB];
   for (int i = 0; i < CIS_MAX_PIXELS_NB; ++i) {
-    current_grayscale_line[i] = 0.299f * image_db->activeBuffer_R[i] +
-                                0.587f * image_db->activeBuffer_G[i] +
-                                0.114f * image_db->activeBuffer_B[i];
+    current_grayscale_line[i] =
+        0.299f * line.R[i] + 0.587f * line.G[i] + 0.114f * line.B[i];
   }
-  pthread_mutex_unlock(&image_db->mutex);
+  releaseImageLine(image_db, &line);
 
+  push_line_and_compute_fft(current_grayscale_line);
+}
+
+// Adds a line to the history and runs the FFT on the windowed average. The
+// per-pixel sum is kept up to date (add newest, subtract the line leaving
+// the window), so the cost does not depend on the window length.
+static void push_line_and_compute_fft(const float *line) {
   pthread_mutex_lock(&image_history_mutex);
-  memcpy(image_line_history[history_write_index].line_data,
-         current_grayscale_line, CIS_MAX_PIXELS_NB * sizeof(float));
-  history_write_index = (history_write_index + 1) % MOVING_AVERAGE_WINDOW_SIZE;
-  if (history_fill_count < MOVING_AVERAGE_WINDOW_SIZE) {
-    history_fill_count++;
-  }
 
-  if (history_fill_count > 0) {
-    memset(fft_context.fft_input, 0,
-           CIS_MAX_PIXELS_NB * sizeof(kiss_fft_scalar));
-    for (int j = 0; j < CIS_MAX_PIXELS_NB; ++j) {
-      float sum = 0.0f;
-      for (int k = 0; k < history_fill_count; ++k) {
-        int idx = (history_write_index - 1 - k + MOVING_AVERAGE_WINDOW_SIZE) %
-                  MOVING_AVERAGE_WINDOW_SIZE;
-        sum += image_line_history[idx].line_data[j];
+  // Window change requested: rebuild the sum from the lines already stored
+  int requested_window = g_moving_average_window;
+  if (requested_window != g_active_average_window) {
+    g_active_average_window = requested_window;
+    int lines = (history_fill_count < requested_window) ? history_fill_count
+                                                        : requested_window;
+    memset(image_line_running_sum, 0, sizeof(image_line_running_sum));
+    for (int k = 0; k < lines; ++k) {
+      int idx = (history_write_index - 1 - k + MAX_MOVING_AVERAGE_WINDOW_SIZE) %
+                MAX_MOVING_AVERAGE_WINDOW_SIZE;
+      for (int j = 0; j < CIS_MAX_PIXELS_NB; ++j) {
+        image_line_running_sum[j] += image_line_history[idx].line_data[j];
       }
-      fft_context.fft_input[j] = sum / history_fill_count;
     }
-    kiss_fftr(fft_context.fft_cfg, fft_context.fft_input,
-              fft_context.fft_output);
   }
+  const int window = g_active_average_window;
+
+  // Remove the line leaving the window before its slot can be overwritten
+  if (history_fill_count >= window) {
+    int oldest_idx =
+        (history_write_index - window + MAX_MOVING_AVERAGE_WINDOW_SIZE) %
+        MAX_MOVING_AVERAGE_WINDOW_SIZE;
+    const float *oldest = image_line_history[oldest_idx].line_data;
+    for (int j = 0; j < CIS_MAX_PIXELS_NB; ++j) {
+      image_line_running_sum[j] -= oldest[j];
+    }
+  }
+
+  memcpy(image_line_history[history_write_index].line_data, line,
+         CIS_MAX_PIXELS_NB * sizeof(float));
+  history_write_index =
+      (history_write_index + 1) % MAX_MOVING_AVERAGE_WINDOW_SIZE;
+  if (history_fill_count < MAX_MOVING_AVERAGE_WINDOW_SIZE) {
+    history_fill_count++;
+  }
+
+  int count = (history_fill_count < window) ? history_fill_count : window;
+  const double inv_count = 1.0 / (double)count;
+  for (int j = 0; j < CIS_MAX_PIXELS_NB; ++j) {
+    image_line_running_sum[j] += line[j];
+    fft_context.fft_input[j] =
+        (kiss_fft_scalar)(image_line_running_sum[j] * inv_count);
+  }
+  kiss_fftr(fft_context.fft_cfg, fft_context.fft_input, fft_context.fft_output);
+
   pthread_mutex_unlock(&image_history_mutex);
 }
 
 static void generate_test_data_for_fft(void) {
   static int call_count = 0;
   printf("Génération de données de test pour la FFT (%d)...\n", call_count++);
-  pthread_mutex_lock(&image_history_mutex);
   float test_line[CIS_MAX_PIXELS_NB];
   for (int i = 0; i < CIS_MAX_PIXELS_NB; i++) {
     float phase = 10.0f * 2.0f * M_PI * (float)i / (float)CIS_MAX_PIXELS_NB;
@@ -398,28 +511,7 @@ static void generate_test_data_for_fft(void) {
     test_line[i] += sinf(5.0f * phase) * 50.0f;
     test_line[i] += (rand() % 100) / 100.0f * 20.0f;
   }
-  memcpy(image_line_history[history_write_index].line_data, test_line,
-         CIS_MAX_PIXELS_NB * sizeof(float));
-  history_write_index = (history_write_index + 1) % MOVING_AVERAGE_WINDOW_SIZE;
-  if (history_fill_count < MOVING_AVERAGE_WINDOW_SIZE) {
-    history_fill_count++;
-  }
-  if (history_fill_count > 0) {
-    memset(fft_context.fft_input, 0,
-           CIS_MAX_PIXELS_NB * sizeof(kiss_fft_scalar));
-    for (int j = 0; j < CIS_MAX_PIXELS_NB; ++j) {
-      float sum = 0.0f;
-      for (int k = 0; k < history_fill_count; ++k) {
-        int idx = (history_write_index - 1 - k + MOVING_AVERAGE_WINDOW_SIZE) %
-                  MOVING_AVERAGE_WINDOW_SIZE;
-        sum += image_line_history[idx].line_data[j];
-      }
-      fft_context.fft_input[j] = sum / history_fill_count;
-    }
-    kiss_fftr(fft_context.fft_cfg, fft_context.fft_input,
-              fft_context.fft_output);
-  }
-  pthread_mutex_unlock(&image_history_mutex);
+  push_line_and_compute_fft(test_line);
 }
 
 // --- Main Thread Function ---
@@ -427,7 +519,8 @@ void *synth_fftMode_thread_func(void *arg) {
   DoubleBuffer *image_db = NULL;
   if (arg != NULL) {
     Context *ctx = (Context *)arg;
-    image_db = ctx->doubleBuffer;
+    // Scanner dédié au synth FFT (--scanner-map=engines), sinon le même
+    image_db = ctx->fftDoubleBuffer ? ctx->fftDoubleBuffer : ctx->doubleBuffer;
     printf(
         "synth_fftMode_thread_func: DoubleBuffer obtenu depuis le contexte.\n");
   } else {
@@ -435,6 +528,7 @@ void *synth_fftMode_thread_func(void *arg) {
            "DoubleBuffer disponible.\n");
   }
   printf("synth_fftMode_thread_func started.\n");
+  enable_flush_to_zero();
   fflush(stdout);
   srand(time(NULL));
 
@@ -466,8 +560,12 @@ void *synth_fftMode_thread_func(void *arg) {
         goto cleanup_thread;
       }
     }
+    struct timespec render_start, render_end;
+    clock_gettime(CLOCK_MONOTONIC, &render_start);
     synth_fftMode_process(fft_audio_buffers[local_producer_idx].data,
-                          AUDIO_BUFFER_SIZE);
+                          g_audio_buffer_size);
+    clock_gettime(CLOCK_MONOTONIC, &render_end);
+    update_render_load(&render_start, &render_end);
     fft_audio_buffers[local_producer_idx].ready = 1;
     pthread_cond_signal(&fft_audio_buffers[local_producer_idx].cond);
     pthread_mutex_unlock(&fft_audio_buffers[local_producer_idx].mutex);
@@ -533,8 +631,8 @@ adsr_update_settings_and_recalculate_rates(AdsrEnvelope *env, float attack_s,
   // Recalculate increments/decrements
   // For attack_increment, it's generally set when attack is triggered or
   // re-triggered. If an attack is in progress and its time changes,
-  // adsr_get_output would need more complex logic to adjust smoothly. For now,
-  // we primarily focus on decay and release adjustments.
+  // adsr_render_block would need more complex logic to adjust smoothly. For
+  // now, we primarily focus on decay and release adjustments.
   env->attack_increment =
       (env->attack_time_samples > 0.0f)
           ? (1.0f / env->attack_time_samples)
@@ -635,16 +733,91 @@ static void adsr_trigger_release(AdsrEnvelope *env) {
   }
 }
 
-static float adsr_get_output(AdsrEnvelope *env) {
-  switch (env->state) {
-  case ADSR_STATE_IDLE:
-    break;
-  case ADSR_STATE_ATTACK:
-    env->current_output += env->attack_increment;
-    env->current_samples++;
-    if (env->current_output >= 1.0f ||
-        (env->attack_time_samples > 0.0f &&
-         env->current_samples >= env->attack_time_samples)) {
+// Number of samples a linear stage can still run before it ends, following
+// the per-sample rule "level crossed OR stage duration elapsed". The stage
+// ends ON the returned sample.
+static long long adsr_stage_remaining(float distance_to_target, float step,
+                                      float stage_time_samples,
+                                      long long current_samples) {
+  long long remaining = LLONG_MAX;
+  if (step > 0.0f) {
+    remaining = (long long)ceilf(distance_to_target / step);
+  } else if (distance_to_target <= 0.0f) {
+    remaining = 1;
+  }
+  if (stage_time_samples > 0.0f) {
+    long long by_time =
+        (long long)ceilf(stage_time_samples - (float)current_samples);
+    if (by_time < remaining)
+      remaining = by_time;
+  }
+  return (remaining < 1) ? 1 : remaining;
+}
+
+// Renders n envelope samples into out. Each stage is filled as a linear
+// segment (branch-free, vectorizable loop) and transitions happen at the
+// exact sample where the per-sample state machine would switch. Returns the
+// number of samples rendered before the envelope became IDLE (n if it did
+// not).
+static unsigned int adsr_render_block(AdsrEnvelope *env, float *out,
+                                      unsigned int n) {
+  unsigned int pos = 0;
+  unsigned int active_len = n;
+
+  while (pos < n) {
+    unsigned int avail = n - pos;
+    float start_level = env->current_output;
+    float slope = 0.0f;
+    long long remaining = LLONG_MAX;
+
+    switch (env->state) {
+    case ADSR_STATE_IDLE:
+    case ADSR_STATE_SUSTAIN:
+      break;
+    case ADSR_STATE_ATTACK:
+      slope = env->attack_increment;
+      remaining = adsr_stage_remaining(1.0f - start_level, slope,
+                                       env->attack_time_samples,
+                                       env->current_samples);
+      break;
+    case ADSR_STATE_DECAY:
+      slope = -env->decay_decrement;
+      remaining = adsr_stage_remaining(start_level - env->sustain_level,
+                                       env->decay_decrement,
+                                       env->decay_time_samples,
+                                       env->current_samples);
+      break;
+    case ADSR_STATE_RELEASE:
+      slope = -env->release_decrement;
+      remaining = adsr_stage_remaining(start_level, env->release_decrement,
+                                       env->release_time_samples,
+                                       env->current_samples);
+      break;
+    }
+
+    unsigned int len =
+        (remaining < (long long)avail) ? (unsigned int)remaining : avail;
+    float *seg = out + pos;
+    for (unsigned int i = 0; i < len; ++i) {
+      float level = start_level + slope * (float)(i + 1);
+      seg[i] = fmaxf(0.0f, fminf(1.0f, level));
+    }
+    pos += len;
+
+    if (env->state == ADSR_STATE_IDLE || env->state == ADSR_STATE_SUSTAIN) {
+      env->current_output = fmaxf(0.0f, fminf(1.0f, start_level));
+      break;
+    }
+
+    env->current_samples += len;
+    env->current_output = seg[len - 1];
+    if ((long long)len < remaining) {
+      break; // Block ends inside the stage
+    }
+
+    // Stage transition on the last sample of the segment
+    switch (env->state) {
+    case ADSR_STATE_ATTACK:
       env->current_output = 1.0f;
       env->state = ADSR_STATE_DECAY;
       env->current_samples = 0;
@@ -655,36 +828,27 @@ static float adsr_get_output(AdsrEnvelope *env) {
         env->current_output = env->sustain_level;
         env->state = ADSR_STATE_SUSTAIN;
       }
-    }
-    break;
-  case ADSR_STATE_DECAY:
-    env->current_output -= env->decay_decrement;
-    env->current_samples++;
-    if (env->current_output <= env->sustain_level ||
-        (env->decay_time_samples > 0.0f &&
-         env->current_samples >= env->decay_time_samples)) {
+      break;
+    case ADSR_STATE_DECAY:
       env->current_output = env->sustain_level;
       env->state = ADSR_STATE_SUSTAIN;
-    }
-    break;
-  case ADSR_STATE_SUSTAIN:
-    break;
-  case ADSR_STATE_RELEASE:
-    env->current_output -= env->release_decrement;
-    env->current_samples++;
-    if (env->current_output <= 0.0f ||
-        (env->release_time_samples > 0.0f &&
-         env->current_samples >= env->release_time_samples)) {
+      break;
+    case ADSR_STATE_RELEASE:
       env->current_output = 0.0f;
       env->state = ADSR_STATE_IDLE;
+      active_len = pos;
+      break;
+    default:
+      break;
     }
-    break;
+    seg[len - 1] = env->current_output;
   }
-  if (env->current_output > 1.0f)
-    env->current_output = 1.0f;
-  if (env->current_output < 0.0f)
-    env->current_output = 0.0f;
-  return env->current_output;
+
+  // IDLE and SUSTAIN hold their level until the end of the block
+  for (unsigned int i = pos; i < n; ++i) {
+    out[i] = env->current_output;
+  }
+  return active_len;
 }
 
 // --- MIDI Note Handling ---
@@ -696,84 +860,71 @@ static float midi_note_to_frequency(int noteNumber) {
   return 440.0f * powf(2.0f, (float)(noteNumber - 69) / 12.0f);
 }
 
-void synth_fft_note_on(int noteNumber, int velocity) {
+// Notes arrive through the MIDI event queue (midi_event_queue.h), filled by
+// the MIDI input thread; voices are touched by the synth thread only
+static void apply_midi_event(const MidiEvent *event) {
+  switch (event->type) {
+  case MIDI_EVENT_NOTE_ON:
+    apply_note_on(event->note, event->velocity);
+    break;
+  case MIDI_EVENT_NOTE_OFF:
+    apply_note_off(event->note);
+    break;
+  case MIDI_EVENT_VIBRATO_RATE:
+    synth_fft_set_vibrato_rate(event->value);
+    break;
+  case MIDI_EVENT_ENV_ATTACK:
+    synth_fft_set_volume_adsr_attack(event->value);
+    break;
+  case MIDI_EVENT_ENV_DECAY:
+    synth_fft_set_volume_adsr_decay(event->value);
+    break;
+  case MIDI_EVENT_ENV_RELEASE:
+    synth_fft_set_volume_adsr_release(event->value);
+    break;
+  }
+}
+
+static void apply_note_on(int noteNumber, int velocity) {
   if (velocity <= 0) {
-    synth_fft_note_off(noteNumber);
+    apply_note_off(noteNumber);
     return;
   }
 
   g_current_trigger_order++; // Increment global trigger order
 
+  const int num_voices = g_num_poly_voices;
   int voice_idx = -1;
 
   // Priority 1: Find an IDLE voice
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+  for (int i = 0; i < num_voices; ++i) {
     if (poly_voices[i].voice_state == ADSR_STATE_IDLE) {
       voice_idx = i;
       break;
     }
   }
 
-  // Priority 2: Find the oldest voice not in RELEASE or RECENT ATTACK
-  // "Recent attack" could be defined by comparing its trigger order to
-  // g_current_trigger_order For simplicity here, we'll consider any ATTACK,
-  // DECAY, SUSTAIN voice. We'll pick the one with the smallest
-  // last_triggered_order.
   if (voice_idx == -1) {
-    unsigned long long oldest_order =
-        g_current_trigger_order +
-        1; // Initialize with a value guaranteed to be newer
-    int candidate_idx = -1;
-    for (int i = 0; i < NUM_POLY_VOICES; ++i) {
-      if (poly_voices[i].voice_state != ADSR_STATE_RELEASE &&
-          poly_voices[i].voice_state !=
-              ADSR_STATE_IDLE) { // i.e., ATTACK, DECAY, SUSTAIN
-        if (poly_voices[i].last_triggered_order < oldest_order) {
-          oldest_order = poly_voices[i].last_triggered_order;
-          candidate_idx = i;
-        }
+    if (g_fft_render_load > FFT_CPU_BUDGET_SHED_RATIO) {
+      // Near the render deadline: a release tail is the cheapest voice to
+      // give up, so take the quietest one before cutting a held note.
+      voice_idx = find_quietest_release_voice(num_voices);
+      if (voice_idx == -1) {
+        voice_idx = find_oldest_active_voice(num_voices);
       }
-    }
-    if (candidate_idx != -1) {
-      voice_idx = candidate_idx;
-      // printf("SYNTH_FFT: No idle voice. Stealing oldest active (non-release)
-      // "
-      //        "voice %d for note %d (Order: %llu)\n",
-      //        voice_idx, noteNumber, oldest_order);
-    }
-  }
-
-  // Priority 3: If still no voice, steal the voice in RELEASE with the lowest
-  // envelope output
-  if (voice_idx == -1) {
-    float lowest_env_output = 2.0f; // Greater than max envelope output (1.0)
-    int candidate_idx = -1;
-    for (int i = 0; i < NUM_POLY_VOICES; ++i) {
-      if (poly_voices[i].voice_state == ADSR_STATE_RELEASE) {
-        if (poly_voices[i].volume_adsr.current_output < lowest_env_output) {
-          lowest_env_output = poly_voices[i].volume_adsr.current_output;
-          candidate_idx = i;
-        }
+    } else {
+      // Priority 2: the oldest voice not in RELEASE (ATTACK, DECAY, SUSTAIN)
+      voice_idx = find_oldest_active_voice(num_voices);
+      // Priority 3: the voice in RELEASE with the lowest envelope output
+      if (voice_idx == -1) {
+        voice_idx = find_quietest_release_voice(num_voices);
       }
     }
-    if (candidate_idx != -1) {
-      voice_idx = candidate_idx;
-      // printf("SYNTH_FFT: No idle or active non-release voice. Stealing "
-      //        "quietest release voice %d for note %d (Env: %.2f)\n",
-      //        voice_idx, noteNumber, lowest_env_output);
-    }
   }
 
-  // Fallback: If absolutely no voice found (e.g., all voices are in very recent
-  // ATTACK and NUM_POLY_VOICES is small) or if all voices are in RELEASE but
-  // none were selected by prio 3 (should not happen if there's at least one
-  // release voice) For now, we'll just steal voice 0 as a last resort if
-  // voice_idx is still -1. A more robust system might refuse the note or have a
-  // more complex fallback.
+  // Fallback: should not happen with at least one active voice, steal voice 0
   if (voice_idx == -1) {
-    voice_idx = 0; // Default to stealing voice 0 if no other candidate found
-    // printf("SYNTH_FFT: Critical fallback. Stealing voice 0 for note %d\n",
-    //        noteNumber);
+    voice_idx = 0;
   }
 
   SynthVoice *voice = &poly_voices[voice_idx];
@@ -782,10 +933,10 @@ void synth_fft_note_on(int noteNumber, int velocity) {
   // This ensures it starts fresh, respecting the latest global parameters.
   adsr_init_envelope(&voice->volume_adsr, G_VOLUME_ADSR_ATTACK_S,
                      G_VOLUME_ADSR_DECAY_S, G_VOLUME_ADSR_SUSTAIN_LEVEL,
-                     G_VOLUME_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+                     G_VOLUME_ADSR_RELEASE_S, (float)g_sampling_frequency);
   adsr_init_envelope(&voice->filter_adsr, G_FILTER_ADSR_ATTACK_S,
                      G_FILTER_ADSR_DECAY_S, G_FILTER_ADSR_SUSTAIN_LEVEL,
-                     G_FILTER_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+                     G_FILTER_ADSR_RELEASE_S, (float)g_sampling_frequency);
 
   voice->fundamental_frequency = midi_note_to_frequency(noteNumber);
   voice->midi_note_number = noteNumber;
@@ -809,14 +960,53 @@ void synth_fft_note_on(int noteNumber, int velocity) {
   //        voice->fundamental_frequency, voice->last_triggered_order);
 }
 
-void synth_fft_note_off(int noteNumber) {
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+// Oldest voice (smallest trigger order) in ATTACK, DECAY or SUSTAIN
+static int find_oldest_active_voice(int num_voices) {
+  unsigned long long oldest_order = g_current_trigger_order + 1;
+  int candidate_idx = -1;
+  for (int i = 0; i < num_voices; ++i) {
+    if (poly_voices[i].voice_state != ADSR_STATE_RELEASE &&
+        poly_voices[i].voice_state != ADSR_STATE_IDLE) {
+      if (poly_voices[i].last_triggered_order < oldest_order) {
+        oldest_order = poly_voices[i].last_triggered_order;
+        candidate_idx = i;
+      }
+    }
+  }
+  return candidate_idx;
+}
+
+// Voice in RELEASE with the lowest volume envelope output
+static int find_quietest_release_voice(int num_voices) {
+  float lowest_env_output = 2.0f; // Greater than max envelope output (1.0)
+  int candidate_idx = -1;
+  for (int i = 0; i < num_voices; ++i) {
+    if (poly_voices[i].voice_state == ADSR_STATE_RELEASE &&
+        poly_voices[i].volume_adsr.current_output < lowest_env_output) {
+      lowest_env_output = poly_voices[i].volume_adsr.current_output;
+      candidate_idx = i;
+    }
+  }
+  return candidate_idx;
+}
+
+static void voice_force_idle(SynthVoice *voice) {
+  voice->volume_adsr.state = ADSR_STATE_IDLE;
+  voice->volume_adsr.current_output = 0.0f;
+  voice->filter_adsr.state = ADSR_STATE_IDLE;
+  voice->filter_adsr.current_output = 0.0f;
+  voice->voice_state = ADSR_STATE_IDLE;
+  voice->midi_note_number = -1;
+}
+
+static void apply_note_off(int noteNumber) {
+  for (int i = 0; i < MAX_POLY_VOICES; ++i) {
     if (poly_voices[i].midi_note_number == noteNumber &&
         poly_voices[i].voice_state != ADSR_STATE_IDLE &&
         poly_voices[i].voice_state != ADSR_STATE_RELEASE) {
       adsr_trigger_release(&poly_voices[i].volume_adsr);
       adsr_trigger_release(&poly_voices[i].filter_adsr);
-      // voice_state will be set to IDLE by adsr_get_output when release
+      // voice_state will be set to IDLE by adsr_render_block when release
       // finishes midi_note_number will be set to -1 when voice_state becomes
       // IDLE in synth_fftMode_process
       // printf("SYNTH_FFT: Voice %d Note Off: %d -> ADSR Release\n", i,
@@ -825,6 +1015,68 @@ void synth_fft_note_off(int noteNumber) {
   }
 }
 
+// --- Polyphony & CPU Budget ---
+int synth_fft_set_polyphony(int num_voices) {
+  if (num_voices < 1)
+    num_voices = 1;
+  if (num_voices > MAX_POLY_VOICES)
+    num_voices = MAX_POLY_VOICES;
+  // Voices leaving the active range are silenced so they restart cleanly if
+  // the pool grows again
+  for (int i = num_voices; i < MAX_POLY_VOICES; ++i) {
+    voice_force_idle(&poly_voices[i]);
+  }
+  g_num_poly_voices = num_voices;
+  return num_voices;
+}
+
+int synth_fft_get_polyphony(void) { return g_num_poly_voices; }
+
+int synth_fft_set_moving_average_window(int num_lines) {
+  if (num_lines < 1)
+    num_lines = 1;
+  if (num_lines > MAX_MOVING_AVERAGE_WINDOW_SIZE)
+    num_lines = MAX_MOVING_AVERAGE_WINDOW_SIZE;
+  g_moving_average_window = num_lines;
+  return num_lines;
+}
+
+float synth_fft_get_render_load(void) { return g_fft_render_load; }
+
+// Tracks render time against the buffer period over the last
+// FFT_CPU_BUDGET_HISTORY buffers and drops the quietest release tail while
+// the peak stays above FFT_CPU_BUDGET_SHED_RATIO. Runs on the synth thread
+// between two renders, so the voice pool is not being iterated.
+static void update_render_load(const struct timespec *start,
+                               const struct timespec *end) {
+  static float load_history[FFT_CPU_BUDGET_HISTORY] = {0};
+  static int load_history_index = 0;
+  const double budget_ns =
+      (double)g_audio_buffer_size * 1e9 / (double)g_sampling_frequency;
+
+  double elapsed_ns = (double)(end->tv_sec - start->tv_sec) * 1e9 +
+                      (double)(end->tv_nsec - start->tv_nsec);
+  audio_telemetry_render(AUDIO_ENGINE_FFT, elapsed_ns * 1e-9,
+                         budget_ns * 1e-9);
+  load_history[load_history_index] = (float)(elapsed_ns / budget_ns);
+  load_history_index = (load_history_index + 1) % FFT_CPU_BUDGET_HISTORY;
+
+  float peak_load = 0.0f;
+  for (int i = 0; i < FFT_CPU_BUDGET_HISTORY; ++i) {
+    if (load_history[i] > peak_load)
+      peak_load = load_history[i];
+  }
+  g_fft_render_load = peak_load;
+
+  if (peak_load > FFT_CPU_BUDGET_SHED_RATIO) {
+    int idx = find_quietest_release_voice(g_num_poly_voices);
+    if (idx != -1) {
+      voice_force_idle(&poly_voices[idx]);
+      g_fft_voices_shed++;
+    }
+  }
+}
+
 // --- Filter Implementation (Simplified for Spectral Params) ---
 static void filter_init_spectral_params(SpectralFilterParams *fp,
                                         float base_cutoff_hz,
@@ -843,13 +1095,19 @@ static void lfo_init(LfoState *lfo, float rate_hz, float depth_semitones,
   lfo->current_output = 0.0f;
 }
 
-static float lfo_process(LfoState *lfo) {
-  lfo->current_output = sinf(lfo->phase);
-  lfo->phase += lfo->phase_increment;
-  if (lfo->phase >= TWO_PI) {
-    lfo->phase -= TWO_PI;
+// Renders n LFO samples. The phase ramp is computed from the block start so
+// the loop has no carried dependency and can be vectorized.
+static void lfo_render_block(LfoState *lfo, float *out, unsigned int n) {
+  const float phase = lfo->phase;
+  const float increment = lfo->phase_increment;
+  for (unsigned int i = 0; i < n; ++i) {
+    out[i] = sinf(phase + increment * (float)i);
+  }
+  if (n > 0) {
+    lfo->current_output = out[n - 1];
   }
-  return lfo->current_output;
+  float next_phase = phase + increment * (float)n;
+  lfo->phase = next_phase - TWO_PI * floorf(next_phase / TWO_PI);
 }
 
 // --- ADSR Parameter Setters ---
@@ -858,11 +1116,11 @@ void synth_fft_set_volume_adsr_attack(float attack_s) {
     attack_s = 0.0f;
   G_VOLUME_ADSR_ATTACK_S = attack_s;
   // printf("SYNTH_FFT: Global Volume ADSR Attack set to: %.3f s\n", attack_s);
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+  for (int i = 0; i < MAX_POLY_VOICES; ++i) {
     adsr_update_settings_and_recalculate_rates(
         &poly_voices[i].volume_adsr, G_VOLUME_ADSR_ATTACK_S,
         G_VOLUME_ADSR_DECAY_S, G_VOLUME_ADSR_SUSTAIN_LEVEL,
-        G_VOLUME_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+        G_VOLUME_ADSR_RELEASE_S, (float)g_sampling_frequency);
     // Update filter ADSR similarly if desired
     // adsr_update_settings_and_recalculate_rates(&poly_voices[i].filter_adsr,
     // G_FILTER_ADSR_ATTACK_S, ...);
@@ -874,11 +1132,11 @@ void synth_fft_set_volume_adsr_decay(float decay_s) {
     decay_s = 0.0f;
   G_VOLUME_ADSR_DECAY_S = decay_s;
   // printf("SYNTH_FFT: Global Volume ADSR Decay set to: %.3f s\n", decay_s);
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+  for (int i = 0; i < MAX_POLY_VOICES; ++i) {
     adsr_update_settings_and_recalculate_rates(
         &poly_voices[i].volume_adsr, G_VOLUME_ADSR_ATTACK_S,
         G_VOLUME_ADSR_DECAY_S, G_VOLUME_ADSR_SUSTAIN_LEVEL,
-        G_VOLUME_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+        G_VOLUME_ADSR_RELEASE_S, (float)g_sampling_frequency);
   }
 }
 
@@ -890,11 +1148,11 @@ void synth_fft_set_volume_adsr_sustain(float sustain_level) {
   G_VOLUME_ADSR_SUSTAIN_LEVEL = sustain_level;
   // printf("SYNTH_FFT: Global Volume ADSR Sustain set to: %.2f\n",
   // sustain_level);
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+  for (int i = 0; i < MAX_POLY_VOICES; ++i) {
     adsr_update_settings_and_recalculate_rates(
         &poly_voices[i].volume_adsr, G_VOLUME_ADSR_ATTACK_S,
         G_VOLUME_ADSR_DECAY_S, G_VOLUME_ADSR_SUSTAIN_LEVEL,
-        G_VOLUME_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+        G_VOLUME_ADSR_RELEASE_S, (float)g_sampling_frequency);
   }
 }
 
@@ -904,11 +1162,11 @@ void synth_fft_set_volume_adsr_release(float release_s) {
   G_VOLUME_ADSR_RELEASE_S = release_s;
   // printf("SYNTH_FFT: Global Volume ADSR Release set to: %.3f s\n",
   // release_s);
-  for (int i = 0; i < NUM_POLY_VOICES; ++i) {
+  for (int i = 0; i < MAX_POLY_VOICES; ++i) {
     adsr_update_settings_and_recalculate_rates(
         &poly_voices[i].volume_adsr, G_VOLUME_ADSR_ATTACK_S,
         G_VOLUME_ADSR_DECAY_S, G_VOLUME_ADSR_SUSTAIN_LEVEL,
-        G_VOLUME_ADSR_RELEASE_S, (float)SAMPLING_FREQUENCY);
+        G_VOLUME_ADSR_RELEASE_S, (float)g_sampling_frequency);
   }
 }
 
@@ -919,7 +1177,7 @@ void synth_fft_set_vibrato_rate(float rate_hz) {
   // Potentially add a max rate limit, e.g., 20Hz or 30Hz
   global_vibrato_lfo.rate_hz = rate_hz;
   global_vibrato_lfo.phase_increment =
-      TWO_PI * rate_hz / (float)SAMPLING_FREQUENCY;
+      TWO_PI * rate_hz / (float)g_sampling_frequency;
   // printf("SYNTH_FFT: Global Vibrato LFO Rate set to: %.2f Hz\n", rate_hz);
 }
 
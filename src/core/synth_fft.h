@@ -8,7 +8,7 @@
 #ifndef SYNTH_FFT_H
 #define SYNTH_FFT_H
 
-#include "config.h" // For AUDIO_BUFFER_SIZE, SAMPLING_FREQUENCY, CIS_MAX_PIXELS_NB
+#include "config.h" // For AUDIO_BUFFER_SIZE_MAX, CIS_MAX_PIXELS_NB
 #include "kissfft/kiss_fftr.h" // Pour la FFT réelle
 #include <pthread.h>           // For mutex and cond
 #include <stdint.h>            // For uint32_t, etc.
@@ -16,9 +16,15 @@
 /* Synth Definitions */
 #define MAX_MAPPED_OSCILLATORS                                                 \
   128                     // Max FFT bins/harmonics to map to oscillators
-#define NUM_POLY_VOICES 8 // Increased to 32 polyphonic voices
+#define MAX_POLY_VOICES 32 // Preallocated voice pool (upper bound)
+#define DEFAULT_NUM_POLY_VOICES 8 // Active voices at startup
 #define DEFAULT_FUNDAMENTAL_FREQUENCY 440.0f // A4 for testing
 
+/* CPU budget for voice stealing */
+#define FFT_CPU_BUDGET_SHED_RATIO                                              \
+  0.75f // Render time / buffer period above which release tails are dropped
+#define FFT_CPU_BUDGET_HISTORY 4 // Number of past buffers considered
+
 /* ADSR Envelope Definitions */
 typedef enum {
   ADSR_STATE_IDLE,
@@ -88,7 +94,8 @@ typedef struct {
 } SynthVoice;
 
 /* Définitions pour la moyenne glissante */
-#define MOVING_AVERAGE_WINDOW_SIZE                                             \
+#define MAX_MOVING_AVERAGE_WINDOW_SIZE 64 // Preallocated history lines
+#define DEFAULT_MOVING_AVERAGE_WINDOW_SIZE                                     \
   1 // Set to 1 to process each line individually
 
 /* Structure pour stocker une ligne d'image en niveaux de gris */
@@ -106,7 +113,7 @@ typedef struct {
 
 /* Exported types ------------------------------------------------------------*/
 typedef struct {
-  float data[AUDIO_BUFFER_SIZE];
+  float data[AUDIO_BUFFER_SIZE_MAX]; // g_audio_buffer_size frames used
   volatile int ready; // 0 = not ready, 1 = ready for consumption
   pthread_mutex_t mutex;
   pthread_cond_t cond;
@@ -122,14 +129,21 @@ extern pthread_mutex_t
     fft_buffer_index_mutex; // Mutex for fft_current_buffer_index
 
 /* Variables pour la moyenne glissante et la FFT */
-extern GrayscaleLine image_line_history[MOVING_AVERAGE_WINDOW_SIZE];
+extern GrayscaleLine image_line_history[MAX_MOVING_AVERAGE_WINDOW_SIZE];
 extern int history_write_index;
 extern int history_fill_count;
+extern double image_line_running_sum[CIS_MAX_PIXELS_NB]; // Sum of the window
+extern volatile int g_moving_average_window; // Requested window, in lines
 extern pthread_mutex_t image_history_mutex;
 extern FftContext fft_context;
 
 // Polyphony related globals
-extern SynthVoice poly_voices[NUM_POLY_VOICES];
+extern SynthVoice poly_voices[MAX_POLY_VOICES];
+extern volatile int g_num_poly_voices; // Active voices (<= MAX_POLY_VOICES)
+extern volatile float
+    g_fft_render_load; // Peak render time / buffer period, last buffers
+extern volatile unsigned long
+    g_fft_voices_shed; // Release tails dropped because of CPU budget
 extern float global_smoothed_magnitudes[MAX_MAPPED_OSCILLATORS];
 extern SpectralFilterParams global_spectral_filter_params;
 
@@ -156,11 +170,23 @@ void *
 synth_fftMode_thread_func(void *arg); // Renamed to avoid conflict if
                                       // synth_fftMode_thread is used elsewhere
 
-// MIDI Note handling functions for synth_fft
-void synth_fft_note_on(int noteNumber, int velocity);
-void synth_fft_note_off(int noteNumber);
+// MIDI notes reach synth_fft through the MIDI event queue
+// (midi_event_queue.h): the MIDI input thread is its only producer, the synth
+// thread applies the events at the start of its next block.
+
+// Polyphony control (voice pool is preallocated, only the active count
+// changes). Returns the number of voices actually enabled.
+int synth_fft_set_polyphony(int num_voices);
+int synth_fft_get_polyphony(void);
+float synth_fft_get_render_load(void);
+
+// Moving average window over image lines (1 to MAX_MOVING_AVERAGE_WINDOW_SIZE).
+// Applied by the synth thread on the next line, returns the clamped value.
+int synth_fft_set_moving_average_window(int num_lines);
 
-// Functions to set ADSR parameters for synth_fft volume envelope
+// Functions to set ADSR parameters for synth_fft volume envelope. These act
+// on the voices directly: call them from the synth thread (queued MIDI
+// events) or before it starts.
 void synth_fft_set_volume_adsr_attack(float attack_s);
 void synth_fft_set_volume_adsr_decay(float decay_s);
 void synth_fft_set_volume_adsr_sustain(float sustain_level); // 0.0 to 1.0
@@ -6,6 +6,7 @@
  */
 
 #include "three_band_eq.h"
+#include "audio_format.h"
 #include "config.h"
 #include <cstdio>
 #include <cstring>
@@ -17,7 +18,7 @@ ThreeBandEQ *gEqualizer = nullptr;
 ThreeBandEQ::ThreeBandEQ()
     : lowGain(0.0f), midGain(0.0f), highGain(0.0f), midFreq(DEFAULT_MID_FREQ),
       tempBuffer(nullptr), tempBufferSize(0), enabled(false),
-      sampleRate(SAMPLING_FREQUENCY) {}
+      sampleRate(g_sampling_frequency) {}
 
 ThreeBandEQ::~ThreeBandEQ() { freeTempBuffer(); }
 
@@ -104,7 +105,8 @@ void ThreeBandEQ::setMidFrequency(float freq) {
 }
 
 void ThreeBandEQ::process(int numSamples, int numChannels, float *data[]) {
-  if (!enabled || numSamples <= 0 || numChannels <= 0) {
+  // Disabled, or all bands flat (0 dB) and settled: nothing to do
+  if (!isActive() || numSamples <= 0 || numChannels <= 0) {
     return;
   }
 
@@ -24,6 +24,11 @@ public:
   // Enable/disable the equalizer
   void setEnabled(bool enabled);
   bool isEnabled() const { return enabled; }
+  // Enabled and at least one band not flat (or still settling)
+  bool isActive() const {
+    return enabled &&
+           !(lowEQ.bypassed() && midEQ.bypassed() && highEQ.bypassed());
+  }
 
   // Control parameters
   void setLowGain(float gain);      // gain in dB
@@ -4,6 +4,9 @@
 //
 //  Created by Zhonx on 16/12/2023.
 //
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // recvmmsg
+#endif
 #include "config.h"
 
 #include <stdio.h>
@@ -13,10 +16,18 @@
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/time.h>
+#ifdef __linux__
+#include <linux/filter.h> // SO_ATTACH_REUSEPORT_CBPF steering
+#endif
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <termios.h>
+#include <time.h>
 
 #include "error.h"
 #include "udp.h"
@@ -29,8 +40,107 @@
 // sudo ip addr add 192.168.0.50/24 dev enx00e04c781b25
 // memo on linux terminal : sudo nc -u -l 55151
 
-int udp_Init(struct sockaddr_in *si_other, struct sockaddr_in *si_me) {
-  (void)si_other; // Mark si_other as unused
+/**************************************************************************************
+ * Scanners
+ **************************************************************************************/
+// packet_id further than this from the expected one: sender restarted, the
+// sequence is resynchronised instead of counting a gap
+#define UDP_SEQ_WINDOW (1u << 16)
+// Recent packet_ids remembered to tell a late datagram from a duplicate
+#define UDP_SEQ_HISTORY 256
+
+typedef struct {
+  struct in_addr address;
+  uint16_t port; // Network order, 0: any port
+  int receiver;  // Receive thread (socket) of the scanner
+
+  // packet_id sequence, UDP thread of the scanner only
+  uint32_t next_packet_id;
+  int has_sequence;
+  uint64_t missing[UDP_SEQ_HISTORY / 64]; // Bit set: skipped, not arrived
+} UdpSource;
+
+// Filled before the UDP threads start, read-only afterwards (except the
+// sequence of each source). No scanner: source 0 takes every sender.
+static UdpSource g_udp_sources[UDP_MAX_SOURCES];
+static int g_udp_source_count = 0;
+
+int udp_source_add(const char *spec) {
+  char host[INET_ADDRSTRLEN];
+  const char *colon = strchr(spec, ':');
+  size_t len = colon ? (size_t)(colon - spec) : strlen(spec);
+  UdpSource source = {0};
+
+  if (g_udp_source_count >= UDP_MAX_SOURCES || len >= sizeof(host)) {
+    return -1;
+  }
+  memcpy(host, spec, len);
+  host[len] = '\0';
+  if (inet_pton(AF_INET, host, &source.address) != 1) {
+    return -1;
+  }
+  if (colon) {
+    char *end;
+    long port = strtol(colon + 1, &end, 10);
+    if (*end != '\0' || port < 1 || port > 65535) {
+      return -1;
+    }
+    source.port = htons((uint16_t)port);
+  }
+  for (int k = 0; k < g_udp_source_count; k++) {
+    if (g_udp_sources[k].address.s_addr == source.address.s_addr &&
+        g_udp_sources[k].port == source.port) {
+      return -1; // Already listed
+    }
+  }
+
+  g_udp_sources[g_udp_source_count] = source;
+  return g_udp_source_count++;
+}
+
+int udp_source_count(void) {
+  return g_udp_source_count > 0 ? g_udp_source_count : 1;
+}
+
+int udp_source_receiver(int source) {
+  return g_udp_source_count > 0 ? g_udp_sources[source].receiver : 0;
+}
+
+void udp_source_name(int source, char *buf, size_t size) {
+  if (g_udp_source_count == 0) {
+    snprintf(buf, size, "any sender");
+    return;
+  }
+  const UdpSource *src = &g_udp_sources[source];
+  char host[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &src->address, host, sizeof(host));
+  if (src->port) {
+    snprintf(buf, size, "%s:%u", host, (unsigned int)ntohs(src->port));
+  } else {
+    snprintf(buf, size, "%s", host);
+  }
+}
+
+// First listed scanner matching the sender, -1 if none
+static int udp_source_lookup(const struct sockaddr_in *sender) {
+  if (g_udp_source_count == 0) {
+    return 0;
+  }
+  for (int k = 0; k < g_udp_source_count; k++) {
+    const UdpSource *src = &g_udp_sources[k];
+    if (src->address.s_addr == sender->sin_addr.s_addr &&
+        (src->port == 0 || src->port == sender->sin_port)) {
+      return k;
+    }
+  }
+  return -1;
+}
+
+/**************************************************************************************
+ * Sockets
+ **************************************************************************************/
+static int udp_open_socket(struct sockaddr_in *si_me, int reuse_port,
+                           int verbose) {
   int s;
 
   // Création d'une socket UDP
@@ -38,7 +148,21 @@ int udp_Init(struct sockaddr_in *si_other, struct sockaddr_in *si_me) {
     die("socket");
   }
 
-  printf("CREATE UDP SOCKET\n");
+  if (verbose) {
+    printf("CREATE UDP SOCKET\n");
+  }
+
+#ifdef SO_REUSEPORT
+  // Groupe de sockets sur le même port, une par thread de réception
+  if (reuse_port) {
+    int one = 1;
+    if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1) {
+      die("setsockopt SO_REUSEPORT");
+    }
+  }
+#else
+  (void)reuse_port;
+#endif
 
   // Initialisation de la structure
   memset(si_me, 0, sizeof(*si_me));
@@ -51,8 +175,526 @@ int udp_Init(struct sockaddr_in *si_other, struct sockaddr_in *si_me) {
     die("bind");
   }
 
-  printf("BIND SOCKET\n");
+  if (verbose) {
+    printf("BIND SOCKET\n");
+  }
+
+  // Buffer noyau pour absorber les rafales pendant que le thread publie une
+  // ligne ou n'est pas ordonnancé. Linux le plafonne à net.core.rmem_max et
+  // rapporte le double de la taille effective.
+  int rcvbuf = UDP_SOCKET_RCVBUF;
+  socklen_t optlen = sizeof(rcvbuf);
+  if (setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) == -1) {
+    perror("setsockopt SO_RCVBUF");
+  }
+  if (verbose &&
+      getsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &optlen) == 0) {
+#ifdef __linux__
+    rcvbuf /= 2;
+#endif
+    printf("UDP RECEIVE BUFFER %d KB\n", rcvbuf / 1024);
+    if (rcvbuf < UDP_SOCKET_RCVBUF) {
+      printf("  (%d KB requested, raise the limit with: sudo sysctl -w "
+             "net.core.rmem_max=%d)\n",
+             UDP_SOCKET_RCVBUF / 1024, UDP_SOCKET_RCVBUF);
+    }
+  }
+
+  // Timeout: the UDP thread sees the end of the run without incoming traffic
+  struct timeval timeout = {0, UDP_RECV_TIMEOUT_MS * 1000};
+  if (setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) ==
+      -1) {
+    perror("setsockopt SO_RCVTIMEO");
+  }
+
+#ifdef SO_RXQ_OVFL
+  // Socket drop counter attached to each datagram
+  int one = 1;
+  if (setsockopt(s, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) == -1) {
+    perror("setsockopt SO_RXQ_OVFL");
+  }
+#endif
 
   // Retourne le descripteur de la socket
   return s;
 }
+
+int udp_Init(struct sockaddr_in *si_other, struct sockaddr_in *si_me) {
+  (void)si_other; // Mark si_other as unused
+  return udp_open_socket(si_me, 0, 1);
+}
+
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+// Steering program of the group: source address of the IPv4 header ->
+// socket index (bind order). Other senders are spread by the kernel hash.
+static int udp_attach_steering(int s, int receivers) {
+  struct sock_filter code[2 * UDP_MAX_SOURCES + 2];
+  int n = 0;
+
+  code[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS,
+                                           SKF_NET_OFF + 12);
+  for (int r = 0; r < receivers; r++) {
+    int k = 0;
+    while (g_udp_sources[k].receiver != r) {
+      k++;
+    }
+    code[n++] = (struct sock_filter)BPF_JUMP(
+        BPF_JMP | BPF_JEQ | BPF_K, ntohl(g_udp_sources[k].address.s_addr), 0,
+        1);
+    code[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, (uint32_t)r);
+  }
+  code[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffffffffu);
+
+  struct sock_fprog prog = {(unsigned short)n, code};
+  if (setsockopt(s, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog,
+                 sizeof(prog)) == -1) {
+    perror("setsockopt SO_ATTACH_REUSEPORT_CBPF");
+    return -1;
+  }
+  return 0;
+}
+#endif
+
+int udp_InitReceivers(int sockets[UDP_MAX_SOURCES], struct sockaddr_in *si_me) {
+  // One receive thread per scanner address (the steering program only sees
+  // addresses: scanners told apart by their port share a thread)
+  int receivers = 0;
+  for (int k = 0; k < g_udp_source_count; k++) {
+    int j = 0;
+    while (g_udp_sources[j].address.s_addr !=
+           g_udp_sources[k].address.s_addr) {
+      j++;
+    }
+    g_udp_sources[k].receiver = j < k ? g_udp_sources[j].receiver : receivers++;
+  }
+
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  if (receivers > 1) {
+    for (int r = 0; r < receivers; r++) {
+      sockets[r] = udp_open_socket(si_me, 1, r == 0);
+    }
+    if (udp_attach_steering(sockets[0], receivers) == 0) {
+      printf("UDP: %d receive threads, one per scanner address\n", receivers);
+      return receivers;
+    }
+    for (int r = 0; r < receivers; r++) {
+      close(sockets[r]);
+    }
+  }
+#endif
+
+  // Single socket: one thread serves every scanner
+  if (receivers > 1) {
+    printf("UDP: no per-scanner steering on this system, one receive thread "
+           "for %d scanners\n",
+           g_udp_source_count);
+  }
+  for (int k = 0; k < g_udp_source_count; k++) {
+    g_udp_sources[k].receiver = 0;
+  }
+  sockets[0] = udp_open_socket(si_me, 0, 1);
+  return 1;
+}
+
+/**************************************************************************************
+ * Batched reception
+ **************************************************************************************/
+// Datagrams shorter than this carry no usable image fragment
+#define UDP_PACKET_HEADER_SIZE (offsetof(struct packet_Image, imageData_R))
+
+// Header, then for each color: target part and remainder in the packet
+#define UDP_RECV_IOV 7
+
+typedef struct {
+  uint8_t *planes[3]; // R, G, B targets, NULL: whole datagram in the packet
+  uint16_t size;
+} UdpRecvTarget;
+
+struct UdpRecvBatch {
+  struct packet_Image packets[UDP_RECV_BATCH];
+  UdpRecvTarget targets[UDP_RECV_BATCH];
+  int sources[UDP_RECV_BATCH]; // -1: skipped
+  int count;
+  int receiver;
+  struct iovec iov[UDP_RECV_BATCH][UDP_RECV_IOV];
+  struct sockaddr_in senders[UDP_RECV_BATCH];
+#ifdef __linux__
+  struct mmsghdr msgs[UDP_RECV_BATCH];
+#else
+  struct msghdr msgs[1];
+#endif
+#ifdef SO_RXQ_OVFL
+  union {
+    char buf[CMSG_SPACE(sizeof(uint32_t))];
+    struct cmsghdr align;
+  } control[UDP_RECV_BATCH];
+#endif
+};
+
+// Each counter has a single writer: the receive thread of the socket, or the
+// UDP thread of the source
+static struct {
+  struct {
+    atomic_ulong syscalls;
+    atomic_ulong datagrams;
+    atomic_ulong full_batches;
+    atomic_ulong unknown;
+    atomic_ulong misrouted;
+    atomic_ulong kernel_drops;
+  } receivers[UDP_MAX_SOURCES];
+  struct {
+    atomic_ulong datagrams;
+    atomic_ulong lines[3];
+    atomic_ulong missing_fragments;
+    atomic_ulong fragments[UDP_FRAGMENT_EVENT_COUNT];
+    atomic_ulong seq_gaps;
+    atomic_ulong seq_late;
+  } sources[UDP_MAX_SOURCES];
+} g_udp_stats;
+
+// Single writer: relaxed load + store, as in audio_telemetry.c
+static inline void stats_add(atomic_ulong *counter, unsigned long n) {
+  atomic_store_explicit(
+      counter, atomic_load_explicit(counter, memory_order_relaxed) + n,
+      memory_order_relaxed);
+}
+
+UdpRecvBatch *udp_recv_batch_create(int receiver) {
+  UdpRecvBatch *batch = (UdpRecvBatch *)calloc(1, sizeof(UdpRecvBatch));
+  if (batch == NULL) {
+    return NULL;
+  }
+  batch->receiver = receiver;
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    struct iovec *iov = batch->iov[i];
+    iov[0].iov_base = &batch->packets[i];
+    iov[0].iov_len = UDP_PACKET_HEADER_SIZE;
+    udp_recv_batch_target(batch, i, NULL, NULL, NULL, 0);
+  }
+  return batch;
+}
+
+void udp_recv_batch_target(UdpRecvBatch *batch, int i, uint8_t *r, uint8_t *g,
+                           uint8_t *b, uint16_t fragment_size) {
+  struct packet_Image *packet = &batch->packets[i];
+  uint8_t *blocks[3] = {packet->imageData_R, packet->imageData_G,
+                        packet->imageData_B};
+  UdpRecvTarget *target = &batch->targets[i];
+
+  if (r == NULL || fragment_size > UDP_LINE_FRAGMENT_SIZE) {
+    r = NULL;
+    fragment_size = 0;
+  }
+  target->planes[0] = r;
+  target->planes[1] = g;
+  target->planes[2] = b;
+  target->size = fragment_size;
+
+  // Color blocks are UDP_LINE_FRAGMENT_SIZE bytes apart in the datagram
+  for (int c = 0; c < 3; c++) {
+    struct iovec *iov = &batch->iov[i][1 + 2 * c];
+    iov[0].iov_base = target->planes[c];
+    iov[0].iov_len = fragment_size;
+    iov[1].iov_base = blocks[c] + fragment_size;
+    iov[1].iov_len = UDP_LINE_FRAGMENT_SIZE - fragment_size;
+  }
+}
+
+void udp_recv_batch_gather(UdpRecvBatch *batch, int i) {
+  struct packet_Image *packet = &batch->packets[i];
+  UdpRecvTarget *target = &batch->targets[i];
+  if (target->planes[0] != NULL) {
+    memcpy(packet->imageData_R, target->planes[0], target->size);
+    memcpy(packet->imageData_G, target->planes[1], target->size);
+    memcpy(packet->imageData_B, target->planes[2], target->size);
+  }
+  udp_recv_batch_target(batch, i, NULL, NULL, NULL, 0);
+}
+
+void udp_recv_batch_destroy(UdpRecvBatch *batch) { free(batch); }
+
+static void seq_mark_missing(UdpSource *src, uint32_t id, int missing) {
+  uint64_t *word = &src->missing[(id / 64) % (UDP_SEQ_HISTORY / 64)];
+  uint64_t bit = 1ull << (id % 64);
+  *word = missing ? (*word | bit) : (*word & ~bit);
+}
+
+static void track_sequence(int source, const struct packet_Image *packet) {
+  UdpSource *src = &g_udp_sources[source]; // Source 0 without scanners
+  const uint32_t delta = packet->packet_id - src->next_packet_id;
+  if (!src->has_sequence ||
+      (delta >= UDP_SEQ_WINDOW && -delta >= UDP_SEQ_WINDOW)) {
+    src->has_sequence = 1;
+    memset(src->missing, 0, sizeof(src->missing));
+  } else if (delta < UDP_SEQ_WINDOW) {
+    stats_add(&g_udp_stats.sources[source].seq_gaps, delta);
+    if (delta >= UDP_SEQ_HISTORY) {
+      memset(src->missing, 0, sizeof(src->missing));
+    }
+    for (uint32_t i = 0; i < delta && i < UDP_SEQ_HISTORY; i++) {
+      seq_mark_missing(src, packet->packet_id - 1 - i, 1);
+    }
+  } else {
+    // Behind: arrival of a skipped datagram, or a duplicate
+    if (-delta <= UDP_SEQ_HISTORY &&
+        (src->missing[(packet->packet_id / 64) % (UDP_SEQ_HISTORY / 64)] &
+         (1ull << (packet->packet_id % 64)))) {
+      seq_mark_missing(src, packet->packet_id, 0);
+      stats_add(&g_udp_stats.sources[source].seq_late, 1);
+    }
+    return;
+  }
+  seq_mark_missing(src, packet->packet_id, 0);
+  src->next_packet_id = packet->packet_id + 1;
+}
+
+int udp_recv_batch(int s, UdpRecvBatch *batch) {
+  int n;
+
+#ifdef __linux__
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    struct msghdr *hdr = &batch->msgs[i].msg_hdr;
+    hdr->msg_iov = batch->iov[i];
+    hdr->msg_iovlen = UDP_RECV_IOV;
+    hdr->msg_name = &batch->senders[i];
+    hdr->msg_namelen = sizeof(batch->senders[i]);
+#ifdef SO_RXQ_OVFL
+    hdr->msg_control = batch->control[i].buf;
+    hdr->msg_controllen = sizeof(batch->control[i].buf);
+#endif
+  }
+  // Blocks for the first datagram only, then takes what is queued
+  n = recvmmsg(s, batch->msgs, UDP_RECV_BATCH, MSG_WAITFORONE, NULL);
+#else
+  struct msghdr *hdr = &batch->msgs[0];
+  memset(hdr, 0, sizeof(*hdr));
+  hdr->msg_iov = batch->iov[0];
+  hdr->msg_iovlen = UDP_RECV_IOV;
+  hdr->msg_name = &batch->senders[0];
+  hdr->msg_namelen = sizeof(batch->senders[0]);
+  ssize_t len = recvmsg(s, hdr, 0);
+  n = len < 0 ? -1 : 1;
+#endif
+  if (n <= 0) {
+    batch->count = 0;
+    return 0; // Timeout (EAGAIN) or interrupted
+  }
+
+  const int r = batch->receiver;
+  for (int i = 0; i < n; i++) {
+    struct packet_Image *packet = &batch->packets[i];
+#ifdef __linux__
+    const size_t len = batch->msgs[i].msg_len;
+#endif
+    int source = udp_source_lookup(&batch->senders[i]);
+    if (source < 0) {
+      stats_add(&g_udp_stats.receivers[r].unknown, 1);
+    } else if (udp_source_receiver(source) != r) {
+      // Queued before the steering program was attached
+      stats_add(&g_udp_stats.receivers[r].misrouted, 1);
+      source = -1;
+    } else if ((size_t)len < UDP_PACKET_HEADER_SIZE) {
+      source = -1;
+    }
+    batch->sources[i] = source;
+    if (source < 0) {
+      packet->type = 0; // Skipped by the reassembly
+      continue;
+    }
+    stats_add(&g_udp_stats.sources[source].datagrams, 1);
+    track_sequence(source, packet);
+  }
+
+#if defined(__linux__) && defined(SO_RXQ_OVFL)
+  // Cumulative socket counter, carried by the datagrams that follow a drop
+  const struct msghdr *last = &batch->msgs[n - 1].msg_hdr;
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(last); cmsg != NULL;
+       cmsg = CMSG_NXTHDR((struct msghdr *)last, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+      uint32_t drops;
+      memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+      atomic_store_explicit(&g_udp_stats.receivers[r].kernel_drops, drops,
+                            memory_order_relaxed);
+    }
+  }
+#endif
+
+  stats_add(&g_udp_stats.receivers[r].syscalls, 1);
+  stats_add(&g_udp_stats.receivers[r].datagrams, (unsigned long)n);
+  if (n == UDP_RECV_BATCH) {
+    stats_add(&g_udp_stats.receivers[r].full_batches, 1);
+  }
+  batch->count = n;
+  return n;
+}
+
+const struct packet_Image *udp_recv_batch_packet(const UdpRecvBatch *batch,
+                                                 int i) {
+  return &batch->packets[i];
+}
+
+int udp_recv_batch_source(const UdpRecvBatch *batch, int i) {
+  return batch->sources[i];
+}
+
+int udp_packet_is_valid(const struct packet_Image *packet) {
+  return packet->total_fragments > 0 &&
+         packet->total_fragments <= UDP_MAX_NB_PACKET_PER_LINE &&
+         packet->fragment_id < packet->total_fragments &&
+         packet->fragment_size > 0 &&
+         packet->fragment_size <= UDP_LINE_FRAGMENT_SIZE &&
+         (uint32_t)packet->total_fragments * packet->fragment_size <=
+             CIS_MAX_PIXELS_NB;
+}
+
+/**************************************************************************************
+ * Ingest statistics
+ **************************************************************************************/
+void udp_stats_line(int source, UdpLineOutcome outcome,
+                    unsigned int missing_fragments) {
+  stats_add(&g_udp_stats.sources[source].lines[outcome], 1);
+  if (missing_fragments) {
+    stats_add(&g_udp_stats.sources[source].missing_fragments,
+              missing_fragments);
+  }
+}
+
+void udp_stats_fragment(int source, UdpFragmentEvent event) {
+  stats_add(&g_udp_stats.sources[source].fragments[event], 1);
+}
+
+static inline unsigned long stats_load(atomic_ulong *counter) {
+  return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+void udp_stats_read(UdpIngestStats *out) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  memset(out, 0, sizeof(*out));
+  out->time_s = (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+
+  for (int r = 0; r < UDP_MAX_SOURCES; r++) {
+    out->syscalls += stats_load(&g_udp_stats.receivers[r].syscalls);
+    out->datagrams += stats_load(&g_udp_stats.receivers[r].datagrams);
+    out->full_batches += stats_load(&g_udp_stats.receivers[r].full_batches);
+    out->unknown += stats_load(&g_udp_stats.receivers[r].unknown);
+    out->misrouted += stats_load(&g_udp_stats.receivers[r].misrouted);
+    out->kernel_drops += stats_load(&g_udp_stats.receivers[r].kernel_drops);
+  }
+
+  out->source_count = udp_source_count();
+  for (int k = 0; k < out->source_count; k++) {
+    UdpSourceStats *src = &out->sources[k];
+    src->datagrams = stats_load(&g_udp_stats.sources[k].datagrams);
+    for (int i = 0; i < 3; i++) {
+      src->lines[i] = stats_load(&g_udp_stats.sources[k].lines[i]);
+      out->total.lines[i] += src->lines[i];
+    }
+    src->missing_fragments =
+        stats_load(&g_udp_stats.sources[k].missing_fragments);
+    for (int i = 0; i < UDP_FRAGMENT_EVENT_COUNT; i++) {
+      src->fragments[i] = stats_load(&g_udp_stats.sources[k].fragments[i]);
+      out->total.fragments[i] += src->fragments[i];
+    }
+    src->seq_gaps = stats_load(&g_udp_stats.sources[k].seq_gaps);
+    src->seq_late = stats_load(&g_udp_stats.sources[k].seq_late);
+
+    out->total.datagrams += src->datagrams;
+    out->total.missing_fragments += src->missing_fragments;
+    out->total.seq_gaps += src->seq_gaps;
+    out->total.seq_late += src->seq_late;
+  }
+}
+
+// Datagrams lost according to the packet_id sequence, between two snapshots
+static unsigned long stats_lost(const UdpSourceStats *cur,
+                                const UdpSourceStats *prev) {
+  const unsigned long gaps = cur->seq_gaps - prev->seq_gaps;
+  const unsigned long late = cur->seq_late - prev->seq_late;
+  return gaps > late ? gaps - late : 0;
+}
+
+void udp_stats_print(const UdpIngestStats *cur, const UdpIngestStats *prev) {
+  const UdpIngestStats zero = {0};
+  if (prev == NULL) {
+    prev = &zero;
+  }
+  const unsigned long syscalls = cur->syscalls - prev->syscalls;
+  const unsigned long datagrams = cur->datagrams - prev->datagrams;
+  unsigned long lines[3];
+  unsigned long fragments[UDP_FRAGMENT_EVENT_COUNT];
+  for (int i = 0; i < 3; i++) {
+    lines[i] = cur->total.lines[i] - prev->total.lines[i];
+  }
+  for (int i = 0; i < UDP_FRAGMENT_EVENT_COUNT; i++) {
+    fragments[i] = cur->total.fragments[i] - prev->total.fragments[i];
+  }
+  const unsigned long published =
+      lines[UDP_LINE_COMPLETE] + lines[UDP_LINE_FILLED];
+  const unsigned long unknown = cur->unknown - prev->unknown;
+  const unsigned long misrouted = cur->misrouted - prev->misrouted;
+
+  printf("UDP ingest: %lu datagrams in %lu calls (%.1f per call, %lu full "
+         "batches)\n",
+         datagrams, syscalls, syscalls ? (double)datagrams / syscalls : 0.0,
+         cur->full_batches - prev->full_batches);
+  printf("  %lu lines (%.2f calls per line): %lu complete, %lu filled, %lu "
+         "dropped (%lu fragments missing)\n",
+         published, published ? (double)syscalls / published : 0.0,
+         lines[UDP_LINE_COMPLETE], lines[UDP_LINE_FILLED],
+         lines[UDP_LINE_DROPPED],
+         cur->total.missing_fragments - prev->total.missing_fragments);
+  printf("  fragments reordered %lu, late %lu, duplicate %lu, malformed %lu\n",
+         fragments[UDP_FRAGMENT_REORDERED], fragments[UDP_FRAGMENT_LATE],
+         fragments[UDP_FRAGMENT_DUPLICATE], fragments[UDP_FRAGMENT_MALFORMED]);
+  printf("  lost %lu datagrams (%lu arrived late), socket drops %lu\n",
+         stats_lost(&cur->total, &prev->total),
+         cur->total.seq_late - prev->total.seq_late,
+         cur->kernel_drops - prev->kernel_drops);
+  if (unknown || misrouted) {
+    printf("  ignored %lu datagrams from unknown senders, %lu on another "
+           "receive thread\n",
+           unknown, misrouted);
+  }
+
+  if (cur->source_count > 1) {
+    for (int k = 0; k < cur->source_count; k++) {
+      const UdpSourceStats *src = &cur->sources[k];
+      const UdpSourceStats *old = &prev->sources[k];
+      char name[32];
+      udp_source_name(k, name, sizeof(name));
+      printf("  scanner %d (%s): %lu datagrams, %lu lines (%lu filled, %lu "
+             "dropped), %lu lost\n",
+             k + 1, name, src->datagrams - old->datagrams,
+             (src->lines[UDP_LINE_COMPLETE] - old->lines[UDP_LINE_COMPLETE]) +
+                 (src->lines[UDP_LINE_FILLED] - old->lines[UDP_LINE_FILLED]),
+             src->lines[UDP_LINE_FILLED] - old->lines[UDP_LINE_FILLED],
+             src->lines[UDP_LINE_DROPPED] - old->lines[UDP_LINE_DROPPED],
+             stats_lost(src, old));
+    }
+  }
+}
+
+void udp_stats_report_if_due(double interval_s) {
+  // Single caller (main loop)
+  static UdpIngestStats last;
+  static int has_last = 0;
+
+  if (interval_s <= 0.0) {
+    return;
+  }
+
+  UdpIngestStats cur;
+  udp_stats_read(&cur);
+  if (!has_last) {
+    last = cur;
+    has_last = 1;
+    return;
+  }
+  if (cur.time_s - last.time_s < interval_s) {
+    return;
+  }
+
+  udp_stats_print(&cur, &last);
+  last = cur;
+}
@@ -1,4 +1,3 @@
-
 //
 //  udp.h
 //  SSS_Viewer
@@ -11,6 +10,111 @@
 
 #include <stdio.h>
 
+#include "multithreading.h"
+
+// Batched reception: the CIS sends UDP_MAX_NB_PACKET_PER_LINE datagrams per
+// line, udp_recv_batch() returns every datagram already queued on the socket
+// (up to UDP_RECV_BATCH) with a single recvmmsg() call on Linux, into packets
+// allocated once. Other systems fall back to one recvmsg() per datagram.
+//
+// The payload of each datagram can be scattered directly to a target: the
+// R, G and B planes of a line, at the position of the fragment the caller
+// expects there. Headers always land in the batch's own packets.
+typedef struct UdpRecvBatch UdpRecvBatch;
+
+// Outcome of each line of the reassembly table
+typedef enum {
+  UDP_LINE_COMPLETE = 0, // Every fragment received
+  UDP_LINE_FILLED,       // Missing fragments taken from the previous line
+  UDP_LINE_DROPPED       // Too many fragments missing (or none received)
+} UdpLineOutcome;
+
+typedef enum {
+  UDP_FRAGMENT_REORDERED = 0, // After a newer line or a later fragment
+  UDP_FRAGMENT_LATE,          // Its line was already closed
+  UDP_FRAGMENT_DUPLICATE,
+  UDP_FRAGMENT_MALFORMED, // Out of bounds, or disagrees with its line
+  UDP_FRAGMENT_EVENT_COUNT
+} UdpFragmentEvent;
+
+// Counters of one scanner, written by its UDP thread only
+typedef struct {
+  unsigned long datagrams;         // Datagrams accepted from the scanner
+  unsigned long lines[3];          // Per UdpLineOutcome
+  unsigned long missing_fragments; // Filled or dropped with their line
+  unsigned long fragments[UDP_FRAGMENT_EVENT_COUNT]; // Per UdpFragmentEvent
+  unsigned long seq_gaps; // Datagrams skipped in the packet_id sequence
+  unsigned long seq_late; // Skipped datagrams that arrived afterwards
+} UdpSourceStats;
+
+// Ingest statistics: receive calls of every UDP thread, lines and fragments
+// of every scanner (total and per scanner)
+typedef struct {
+  double time_s;              // CLOCK_MONOTONIC time of the snapshot
+  unsigned long syscalls;     // Receive calls that returned datagrams
+  unsigned long datagrams;    // Datagrams received
+  unsigned long full_batches; // Calls that filled the batch (backlog)
+  unsigned long unknown;      // From a sender that is not a --scanner
+  unsigned long misrouted;    // On another thread than their scanner's
+  unsigned long kernel_drops; // Dropped by the sockets (SO_RXQ_OVFL, Linux)
+  UdpSourceStats total;
+  int source_count;
+  UdpSourceStats sources[UDP_MAX_SOURCES];
+} UdpIngestStats;
+
+// Scanners, in the order of the command line (source 0, 1...). Without any,
+// a single source takes the datagrams of every sender. spec is
+// "IPv4[:PORT]", the port tells apart scanners behind the same address.
+// Returns the source index, -1 if spec is invalid or the table is full.
+int udp_source_add(const char *spec);
+int udp_source_count(void); // 1 when no scanner was added
+// Receive thread of a source (valid after udp_InitReceivers())
+int udp_source_receiver(int source);
+void udp_source_name(int source, char *buf, size_t size);
+
 int udp_Init(struct sockaddr_in *si_other, struct sockaddr_in *si_me);
+// One socket per receive thread, bound to PORT with SO_REUSEPORT, and a
+// steering program that sends the datagrams of each scanner address to its
+// own socket (Linux). Falls back to a single socket for every scanner.
+// Returns the number of sockets (receive threads) created in sockets[].
+int udp_InitReceivers(int sockets[UDP_MAX_SOURCES], struct sockaddr_in *si_me);
+
+// Batch of receive thread 'receiver': datagrams of the scanners it does not
+// serve are counted and skipped
+UdpRecvBatch *udp_recv_batch_create(int receiver);
+void udp_recv_batch_destroy(UdpRecvBatch *batch);
+// Where datagram i of the next call will land: fragment_size bytes at each
+// of r, g and b (the rest of each color block goes to the packet). r == NULL
+// receives the whole datagram in the packet.
+void udp_recv_batch_target(UdpRecvBatch *batch, int i, uint8_t *r, uint8_t *g,
+                           uint8_t *b, uint16_t fragment_size);
+// Blocks until at least one datagram is available (or the receive timeout
+// expires), returns the number of packets in the batch, 0 on timeout
+int udp_recv_batch(int s, UdpRecvBatch *batch);
+// Packet i of the last udp_recv_batch() call. Its image data is only valid
+// if it had no target, or after udp_recv_batch_gather().
+const struct packet_Image *udp_recv_batch_packet(const UdpRecvBatch *batch,
+                                                 int i);
+// Source of packet i, -1 if the datagram was skipped (unknown sender, other
+// receive thread, too short)
+int udp_recv_batch_source(const UdpRecvBatch *batch, int i);
+// Copies the payload of packet i from its target back into the packet (the
+// datagram was not the expected fragment), clears the target
+void udp_recv_batch_gather(UdpRecvBatch *batch, int i);
+// Fragment geometry within the line buffers (total_fragments, fragment_id,
+// fragment_size)
+int udp_packet_is_valid(const struct packet_Image *packet);
+
+// UDP thread of the source: a line left the reassembly table, a fragment was
+// not in order
+void udp_stats_line(int source, UdpLineOutcome outcome,
+                    unsigned int missing_fragments);
+void udp_stats_fragment(int source, UdpFragmentEvent event);
+// Readers (any thread)
+void udp_stats_read(UdpIngestStats *out);
+// Prints the activity between two snapshots (prev may be NULL: since start)
+void udp_stats_print(const UdpIngestStats *cur, const UdpIngestStats *prev);
+// Prints a summary every interval_s seconds (0 disables), call periodically
+void udp_stats_report_if_due(double interval_s);
 
 #endif /* udp_h */
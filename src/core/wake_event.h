@@ -0,0 +1,81 @@
+/*
+ * wake_event.h
+ *
+ * Counting wakeup between a real-time thread and a worker thread: post()
+ * never blocks and takes no lock, so the audio callback may call it; wait()
+ * sleeps until a post. Unnamed POSIX semaphores on Linux; macOS does not
+ * implement sem_init() (it fails with ENOSYS), so a dispatch semaphore is
+ * used there instead.
+ *
+ * The primitive is created by the constructor: owners check isValid() before
+ * starting the worker, which would otherwise never sleep.
+ */
+
+#ifndef WAKE_EVENT_H
+#define WAKE_EVENT_H
+
+#ifdef __APPLE__
+#include <dispatch/dispatch.h>
+#else
+#include <cerrno>
+#include <semaphore.h>
+#endif
+
+class WakeEvent {
+public:
+  WakeEvent() {
+#ifdef __APPLE__
+    sem = dispatch_semaphore_create(0);
+    valid = sem != nullptr;
+#else
+    valid = sem_init(&sem, 0, 0) == 0;
+#endif
+  }
+
+  ~WakeEvent() {
+    if (!valid)
+      return;
+#ifdef __APPLE__
+    dispatch_release(sem);
+#else
+    sem_destroy(&sem);
+#endif
+  }
+
+  WakeEvent(const WakeEvent &) = delete;
+  WakeEvent &operator=(const WakeEvent &) = delete;
+
+  bool isValid() const { return valid; }
+
+  // Real-time safe
+  void post() {
+#ifdef __APPLE__
+    dispatch_semaphore_signal(sem);
+#else
+    sem_post(&sem);
+#endif
+  }
+
+  // Blocks until a post, retrying on signals. false on any other error.
+  bool wait() {
+#ifdef __APPLE__
+    return dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER) == 0;
+#else
+    while (sem_wait(&sem) != 0) {
+      if (errno != EINTR)
+        return false;
+    }
+    return true;
+#endif
+  }
+
+private:
+#ifdef __APPLE__
+  dispatch_semaphore_t sem;
+#else
+  sem_t sem;
+#endif
+  bool valid;
+};
+
+#endif // WAKE_EVENT_H